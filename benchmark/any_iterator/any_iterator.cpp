@@ -52,6 +52,7 @@ BENCHMARK_TEMPLATE(BM_any_iterator, handrolled_remote_storage::any_iterator<int>
 
 BENCHMARK_TEMPLATE(BM_any_iterator, dyno_generic::local_storage)->Arg(N);
 BENCHMARK_TEMPLATE(BM_any_iterator, dyno_generic::local_storage_inlined_vtable)->Arg(N);
+BENCHMARK_TEMPLATE(BM_any_iterator, dyno_generic::local_storage_auto_vtable)->Arg(N);
 
 BENCHMARK_TEMPLATE(BM_any_iterator, boost_type_erasure::any_iterator<int>)->Arg(N);
 
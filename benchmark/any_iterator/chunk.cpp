@@ -0,0 +1,119 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "../../example/any_iterator.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <list>
+#include <numeric>
+#include <vector>
+
+
+// This benchmark compares reading the elements of a sequence through an
+// `any_iterator` one element at a time (which costs a few dynamic dispatches
+// per element) with reading them by chunks using `any_iterator::next_chunk`.
+// The baseline is the same algorithm on the raw iterators of the sequence.
+
+using AnyIterator = any_iterator<int, std::forward_iterator_tag>;
+static constexpr std::size_t chunk_capacity = 256;
+
+template <typename Container>
+static Container make_input(benchmark::State const& state) {
+  std::vector<int> v(state.range(0));
+  std::iota(v.begin(), v.end(), 0);
+  return Container(v.begin(), v.end());
+}
+
+template <typename Container>
+static void BM_accumulate_raw(benchmark::State& state) {
+  Container input = make_input<Container>(state);
+  while (state.KeepRunning()) {
+    int result = std::accumulate(input.begin(), input.end(), 0);
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+template <typename Container>
+static void BM_accumulate_any_iterator(benchmark::State& state) {
+  Container input = make_input<Container>(state);
+  while (state.KeepRunning()) {
+    AnyIterator first{input.begin()}, last{input.end()};
+    int result = std::accumulate(first, last, 0);
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+template <typename Container>
+static void BM_accumulate_chunked(benchmark::State& state) {
+  Container input = make_input<Container>(state);
+  int buffer[chunk_capacity];
+  while (state.KeepRunning()) {
+    AnyIterator first{input.begin()}, last{input.end()};
+    int result = 0;
+    for (auto c = first.next_chunk(last, buffer, chunk_capacity); c.size != 0;
+              c = first.next_chunk(last, buffer, chunk_capacity)) {
+      result = std::accumulate(c.begin(), c.end(), result);
+    }
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+template <typename Container>
+static void BM_copy_raw(benchmark::State& state) {
+  Container input = make_input<Container>(state);
+  std::vector<int> output(input.size());
+  while (state.KeepRunning()) {
+    std::copy(input.begin(), input.end(), output.begin());
+    benchmark::DoNotOptimize(output.data());
+    benchmark::ClobberMemory();
+  }
+}
+
+template <typename Container>
+static void BM_copy_any_iterator(benchmark::State& state) {
+  Container input = make_input<Container>(state);
+  std::vector<int> output(input.size());
+  while (state.KeepRunning()) {
+    AnyIterator first{input.begin()}, last{input.end()};
+    std::copy(first, last, output.begin());
+    benchmark::DoNotOptimize(output.data());
+    benchmark::ClobberMemory();
+  }
+}
+
+template <typename Container>
+static void BM_copy_chunked(benchmark::State& state) {
+  Container input = make_input<Container>(state);
+  std::vector<int> output(input.size());
+  int buffer[chunk_capacity];
+  while (state.KeepRunning()) {
+    AnyIterator first{input.begin()}, last{input.end()};
+    auto out = output.begin();
+    for (auto c = first.next_chunk(last, buffer, chunk_capacity); c.size != 0;
+              c = first.next_chunk(last, buffer, chunk_capacity)) {
+      out = std::copy(c.begin(), c.end(), out);
+    }
+    benchmark::DoNotOptimize(output.data());
+    benchmark::ClobberMemory();
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_accumulate_raw, std::vector<int>)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_accumulate_any_iterator, std::vector<int>)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_accumulate_chunked, std::vector<int>)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_accumulate_raw, std::list<int>)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_accumulate_any_iterator, std::list<int>)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_accumulate_chunked, std::list<int>)->Arg(10000);
+
+BENCHMARK_TEMPLATE(BM_copy_raw, std::vector<int>)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_copy_any_iterator, std::vector<int>)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_copy_chunked, std::vector<int>)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_copy_raw, std::list<int>)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_copy_any_iterator, std::list<int>)->Arg(10000);
+BENCHMARK_TEMPLATE(BM_copy_chunked, std::list<int>)->Arg(10000);
+BENCHMARK_MAIN();
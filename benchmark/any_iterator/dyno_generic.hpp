@@ -14,9 +14,9 @@ namespace dyno_generic {
   template <typename Reference>
   struct Iterator : decltype(dyno::requires_(
     dyno::MoveConstructible{},
-    "increment"_s = dyno::function<void (dyno::T&)>,
-    "dereference"_s = dyno::function<Reference (dyno::T&)>,
-    "equal"_s = dyno::function<bool (dyno::T const&, dyno::T const&)>
+    "increment"_s = dyno::hot(dyno::function<void (dyno::T&)>),
+    "dereference"_s = dyno::hot(dyno::function<Reference (dyno::T&)>),
+    "equal"_s = dyno::hot(dyno::function<bool (dyno::T const&, dyno::T const&)>)
   )) { };
 
   template <typename Value, typename StoragePolicy, typename VTablePolicy, typename Reference = Value&>
@@ -72,6 +72,11 @@ namespace dyno_generic {
       dyno::remote<dyno::everything_else>
     >
   >;
+
+  // Same as above, but the vtable layout is deduced from the hot clauses.
+  using local_storage_auto_vtable = dyno_generic::any_iterator<
+    int, dyno::local_storage<16>, dyno::auto_vtable<>
+  >;
 } // end namespace dyno_generic
 
 #endif // BENCHMARK_ANY_ITERATOR_DYNO_GENERIC_HPP
@@ -0,0 +1,64 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "../example/any_range.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+
+// This benchmark measures copying the elements of a vector-backed `any_range`
+// into a vector, which is done on raw pointers since the range is contiguous.
+// It is compared with a plain `memcpy`, and with the same copy done through
+// the `any_iterator`s of the range, one element at a time.
+
+using IntRange = any_range<int, std::forward_iterator_tag>;
+
+static void BM_memcpy(benchmark::State& state) {
+  std::vector<int> input(state.range(0));
+  std::iota(input.begin(), input.end(), 0);
+  std::vector<int> output(input.size());
+  while (state.KeepRunning()) {
+    std::memcpy(output.data(), input.data(), input.size() * sizeof(int));
+    benchmark::DoNotOptimize(output.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(int));
+}
+
+static void BM_copy_any_range(benchmark::State& state) {
+  std::vector<int> input(state.range(0));
+  std::iota(input.begin(), input.end(), 0);
+  IntRange range = input;
+  std::vector<int> output(input.size());
+  while (state.KeepRunning()) {
+    copy(range, output.begin());
+    benchmark::DoNotOptimize(output.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(int));
+}
+
+static void BM_copy_any_iterator(benchmark::State& state) {
+  std::vector<int> input(state.range(0));
+  std::iota(input.begin(), input.end(), 0);
+  IntRange range = input;
+  std::vector<int> output(input.size());
+  while (state.KeepRunning()) {
+    std::copy(range.begin(), range.end(), output.begin());
+    benchmark::DoNotOptimize(output.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(int));
+}
+
+BENCHMARK(BM_memcpy)->Arg(16)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK(BM_copy_any_range)->Arg(16)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK(BM_copy_any_iterator)->Arg(16)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK_MAIN();
@@ -0,0 +1,140 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+using namespace dyno::literals;
+
+
+// This benchmark measures the throughput of threads dispatching on a shared
+// polymorphic object, while another thread keeps replacing that object. The
+// number of reader threads is the argument of the benchmark. We compare:
+//
+// 1. `dyno::atomic_poly`
+// 2. A `std::shared_ptr<dyno::poly<...>>` accessed with `std::atomic_load`
+//    and `std::atomic_store`. These are the C++11 atomic operations on
+//    `std::shared_ptr`, which predate `std::atomic<std::shared_ptr>` and
+//    are implemented with a pool of mutexes in common implementations.
+// 3. A `dyno::poly` protected by a `std::shared_mutex`.
+
+static constexpr std::size_t reads_per_reader = 100000;
+static constexpr auto write_interval = std::chrono::microseconds{20};
+
+struct Rule : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "price"_s = dyno::method<std::uint64_t (std::uint64_t) const>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<Rule, T> = dyno::make_concept_map(
+  "price"_s = [](T const& self, std::uint64_t x) -> std::uint64_t { return self.price(x); }
+);
+
+struct Flat {
+  std::uint64_t rate;
+  std::uint64_t price(std::uint64_t x) const { return x + rate; }
+};
+
+struct Scaled {
+  std::uint64_t factor;
+  std::uint64_t price(std::uint64_t x) const { return x * factor; }
+};
+
+using Poly = dyno::poly<Rule>;
+
+struct with_atomic_poly {
+  dyno::atomic_poly<Rule> rule{Flat{1}};
+
+  std::uint64_t read(std::uint64_t x) const {
+    auto r = rule.load();
+    return r->virtual_("price"_s)(x);
+  }
+  template <typename T>
+  void write(T t) { rule.store(t); }
+};
+
+struct with_shared_ptr {
+  std::shared_ptr<Poly const> rule = std::make_shared<Poly const>(Flat{1});
+
+  std::uint64_t read(std::uint64_t x) const {
+    auto r = std::atomic_load(&rule);
+    return r->virtual_("price"_s)(x);
+  }
+  template <typename T>
+  void write(T t) { std::atomic_store(&rule, std::make_shared<Poly const>(t)); }
+};
+
+struct with_shared_mutex {
+  mutable std::shared_mutex mutex;
+  Poly rule{Flat{1}};
+
+  std::uint64_t read(std::uint64_t x) const {
+    std::shared_lock<std::shared_mutex> lock{mutex};
+    return rule.virtual_("price"_s)(x);
+  }
+  template <typename T>
+  void write(T t) {
+    Poly fresh{t};
+    std::unique_lock<std::shared_mutex> lock{mutex};
+    rule = std::move(fresh);
+  }
+};
+
+template <typename Cell>
+static void BM_read_while_writing(benchmark::State& state) {
+  auto const readers = static_cast<std::size_t>(state.range(0));
+  Cell cell;
+  std::uint64_t checksum = 0;
+  std::uint64_t writes = 0;
+  while (state.KeepRunning()) {
+    std::atomic<std::size_t> running{readers};
+    std::vector<std::uint64_t> sums(readers);
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t != readers; ++t) {
+      threads.emplace_back([&cell, &running, &sum = sums[t]] {
+        std::uint64_t s = 0;
+        for (std::uint64_t i = 0; i != reads_per_reader; ++i)
+          s += cell.read(i);
+        sum = s;
+        running.fetch_sub(1, std::memory_order_release);
+      });
+    }
+
+    auto next_write = std::chrono::steady_clock::now();
+    while (running.load(std::memory_order_acquire) != 0) {
+      if (std::chrono::steady_clock::now() >= next_write) {
+        if (writes % 2 == 0)
+          cell.write(Scaled{writes % 7});
+        else
+          cell.write(Flat{writes % 7});
+        ++writes;
+        next_write += write_interval;
+      }
+      std::this_thread::yield();
+    }
+    for (auto& t : threads)
+      t.join();
+    for (auto s : sums)
+      checksum += s;
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * readers * reads_per_reader));
+  state.counters["writes"] = static_cast<double>(writes) / static_cast<double>(state.iterations());
+  benchmark::DoNotOptimize(checksum);
+}
+
+BENCHMARK_TEMPLATE(BM_read_while_writing, with_atomic_poly)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_read_while_writing, with_shared_ptr)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_read_while_writing, with_shared_mutex)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+BENCHMARK_MAIN();
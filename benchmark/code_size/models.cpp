@@ -0,0 +1,56 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno.hpp>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+using namespace dyno::literals;
+
+
+// This program stores `DYNO_CODE_SIZE_MODELS` models of a concept in a
+// `dyno::poly`, copies them around and calls a method on each of them. It is
+// not meant to be run; `benchmark.code_size` builds it for several numbers of
+// models and reports the size of each executable, which tells how much code
+// the library generates for each additional model.
+//
+// The models are trivially copyable and only have a few distinct sizes, which
+// is typical of small value types stored in a `dyno::poly`.
+
+#if !defined(DYNO_CODE_SIZE_MODELS)
+#  define DYNO_CODE_SIZE_MODELS 10
+#endif
+
+struct Shape : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "area"_s = dyno::method<int () const>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<Shape, T> = dyno::make_concept_map(
+  "area"_s = [](T const& self) { return self.area(); }
+);
+
+template <int I>
+struct model {
+  int data[I % 4 + 1];
+  int area() const { return data[0] * I; }
+};
+
+using Poly = dyno::poly<Shape>;
+
+template <std::size_t ...I>
+std::vector<Poly> make_shapes(std::index_sequence<I...>) {
+  return {Poly{model<I>{{static_cast<int>(I)}}}...};
+}
+
+int main(int argc, char**) {
+  std::vector<Poly> shapes = make_shapes(std::make_index_sequence<DYNO_CODE_SIZE_MODELS>{});
+  std::vector<Poly> copies = shapes;
+  int sum = 0;
+  for (Poly const& shape : copies)
+    sum += shape.virtual_("area"_s)();
+  return sum == argc ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+# Copyright Louis Dionne 2017
+# Distributed under the Boost Software License, Version 1.0.
+# (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+"""Measures the compile time and peak memory usage of dyno-heavy code.
+
+For each configuration, a translation unit is generated with:
+
+  - a chain of `depth` concepts, each refining the previous one, holding
+    `clauses` clauses in total (alternating methods and functions);
+  - `models` models of the most refined concept, each of which is stored in
+    a `dyno::poly`, which instantiates its concept map and vtable;
+  - one function calling every clause through `dyno::poly::virtual_`.
+
+The translation unit is compiled twice: once as described above, and once
+with only the models and the includes (the baseline). Both are reported, so
+the cost of the library is the difference. Compilers are run one at a time,
+so the numbers are only meaningful on an otherwise idle machine.
+
+The configurations are laid out as sweeps, each varying one parameter while
+the others are fixed (e.g. the clause count with a depth of 1 and a single
+model). Results are written as CSV, one line per configuration.
+"""
+
+import argparse
+import csv
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def generate(clauses, depth, models, vtable):
+    per_concept = [clauses // depth + (1 if i < clauses % depth else 0) for i in range(depth)]
+    lines = [
+        '#include <dyno.hpp>',
+        'using namespace dyno::literals;',
+        '',
+        'template <int J>',
+        'struct model {',
+        '  template <int I> int f(int x) const { return x + I + J; }',
+        '};',
+        '',
+        '#ifndef DYNO_COMPILE_TIME_BASELINE',
+    ]
+
+    clause = 0
+    for level, count in enumerate(per_concept):
+        refined = ['Concept{}{{}}'.format(level - 1)] if level > 0 else []
+        declared, mapped = [], []
+        for _ in range(count):
+            if clause % 2 == 0:
+                declared.append('"f{0}"_s = dyno::method<int (int) const>'.format(clause))
+                mapped.append('"f{0}"_s = [](T const& self, int x) {{ return self.template f<{0}>(x); }}'.format(clause))
+            else:
+                declared.append('"f{0}"_s = dyno::function<int (dyno::T const&, int)>'.format(clause))
+                mapped.append('"f{0}"_s = [](T const& self, int x) {{ return self.template f<{0}>(x); }}'.format(clause))
+            clause += 1
+        lines.append('struct Concept{} : decltype(dyno::requires_('.format(level))
+        lines.append('  ' + ',\n  '.join(refined + declared))
+        lines.append(')) { };')
+        lines.append('')
+        lines.append('template <typename T>')
+        lines.append('auto const dyno::default_concept_map<Concept{}, T> = dyno::make_concept_map('.format(level))
+        lines.append('  ' + ',\n  '.join(mapped))
+        lines.append(');')
+        lines.append('')
+
+    policy = {
+        'remote': 'dyno::vtable<dyno::remote<dyno::everything>>',
+        'local': 'dyno::vtable<dyno::local<dyno::everything>>',
+    }[vtable]
+    leaf = 'Concept{}'.format(depth - 1)
+    lines.append('using Poly = dyno::poly<{}, dyno::remote_storage, {}>;'.format(leaf, policy))
+    lines.append('')
+    lines.append('int call_all(Poly const& p) {')
+    lines.append('  int sum = 0;')
+    for i in range(clauses):
+        if i % 2 == 0:
+            lines.append('  sum += p.virtual_("f{0}"_s)(1);'.format(i))
+        else:
+            lines.append('  sum += p.virtual_("f{0}"_s)(p, 1);'.format(i))
+    lines.append('  return sum;')
+    lines.append('}')
+    lines.append('')
+    lines.append('int main() {')
+    lines.append('  int sum = 0;')
+    for j in range(models):
+        lines.append('  sum += call_all(Poly{{model<{}>{{}}}});'.format(j))
+    lines.append('  return sum;')
+    lines.append('}')
+    lines.append('')
+    lines.append('#else')
+    lines.append('')
+    lines.append('int main() {')
+    lines.append('  int sum = 0;')
+    for j in range(models):
+        lines.append('  sum += model<{}>{{}}.f<0>(1);'.format(j))
+    lines.append('  return sum;')
+    lines.append('}')
+    lines.append('')
+    lines.append('#endif')
+    return '\n'.join(lines) + '\n'
+
+
+def compile_once(command):
+    """Runs `command`, returning its wall-clock time and peak memory in KiB.
+
+    The peak memory is the one of the compiler driver and the processes it
+    spawns (e.g. `cc1plus`), as reported by `wait4`."""
+    start = time.perf_counter()
+    process = subprocess.Popen(command, stderr=subprocess.PIPE)
+    _, status, usage = os.wait4(process.pid, 0)
+    elapsed = time.perf_counter() - start
+    errors = process.stderr.read().decode(errors='replace')
+    process.stderr.close()
+    if os.WIFEXITED(status) and os.WEXITSTATUS(status) == 0:
+        # `ru_maxrss` is in KiB on Linux, and in bytes on macOS.
+        peak = usage.ru_maxrss // 1024 if sys.platform == 'darwin' else usage.ru_maxrss
+        return elapsed, peak
+    sys.stderr.write(errors)
+    raise RuntimeError('compilation failed: ' + ' '.join(command))
+
+
+def measure(args, source_dir, config):
+    source = os.path.join(source_dir, 'clauses{clauses}.depth{depth}.models{models}.{vtable}.cpp'.format(**config))
+    with open(source, 'w') as f:
+        f.write(generate(**config))
+    command = [args.compiler] + args.flags.split() + \
+              ['-I' + d for d in args.include_dirs.split(';') if d] + \
+              ['-c', source, '-o', os.devnull]
+    results = {}
+    for name, extra in (('', []), ('baseline_', ['-DDYNO_COMPILE_TIME_BASELINE'])):
+        runs = [compile_once(command + extra) for _ in range(args.repetitions)]
+        results[name + 'seconds'] = min(seconds for seconds, _ in runs)
+        results[name + 'peak_kib'] = max(peak for _, peak in runs)
+    return results
+
+
+def parse_list(text):
+    return [int(x) for x in text.split(',') if x]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--compiler', required=True, help='C++ compiler to measure')
+    parser.add_argument('--flags', default='-std=c++17', help='flags passed to the compiler')
+    parser.add_argument('--include-dirs', default='', help='semicolon-separated include directories')
+    parser.add_argument('--clauses', type=parse_list, default=[1, 10, 25, 50, 75, 100],
+                        help='clause counts of the clause sweep (depth 1, a single model)')
+    parser.add_argument('--depths', type=parse_list, default=[1, 2, 4, 6, 8, 10],
+                        help='refinement depths of the depth sweep (10 clauses, a single model)')
+    parser.add_argument('--models', type=parse_list, default=[1, 10, 25, 50],
+                        help='model counts of the model sweep (10 clauses, depth 1)')
+    parser.add_argument('--vtables', default='remote,local', help='vtable policies to measure')
+    parser.add_argument('--repetitions', type=int, default=1,
+                        help='number of compilations per configuration; the fastest one is reported')
+    parser.add_argument('--output', required=True, help='CSV file to write the results to')
+    args = parser.parse_args()
+
+    configs = []
+    for vtable in args.vtables.split(','):
+        configs += [('clauses', dict(clauses=n, depth=1, models=1, vtable=vtable)) for n in args.clauses]
+        configs += [('depth', dict(clauses=max(10, d), depth=d, models=1, vtable=vtable)) for d in args.depths]
+        configs += [('models', dict(clauses=10, depth=1, models=m, vtable=vtable)) for m in args.models]
+
+    fields = ['sweep', 'clauses', 'depth', 'models', 'vtable',
+              'seconds', 'peak_kib', 'baseline_seconds', 'baseline_peak_kib']
+    with tempfile.TemporaryDirectory() as source_dir, open(args.output, 'w', newline='') as out:
+        writer = csv.DictWriter(out, fieldnames=fields)
+        writer.writeheader()
+        print('{:<8} {:>7} {:>5} {:>6} {:<6} {:>9} {:>10}'.format(
+            'sweep', 'clauses', 'depth', 'models', 'vtable', 'seconds', 'peak (MiB)'))
+        for sweep, config in configs:
+            results = measure(args, source_dir, config)
+            writer.writerow(dict(sweep=sweep, **config, **results))
+            out.flush()
+            print('{:<8} {clauses:>7} {depth:>5} {models:>6} {vtable:<6} {:>9.2f} {:>10.1f}'.format(
+                sweep, results['seconds'], results['peak_kib'] / 1024, **config), flush=True)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+# Copyright Louis Dionne 2017
+# Distributed under the Boost Software License, Version 1.0.
+# (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+"""Measures the cost of building a project using dyno in many translation units.
+
+A synthetic project is generated, made of:
+
+  - a header defining a concept with `clauses` clauses (alternating methods
+    and functions) and `models` models of that concept;
+  - `tus` translation units, each of which stores every model in a
+    `dyno::poly` and calls one of its functions;
+  - a translation unit with `main`, calling into all the others.
+
+The project is built twice: once as is, where every translation unit
+instantiates the concept maps and vtables of all the models, and once with
+`DYNO_EXTERN_VTABLE` in the header and `DYNO_INSTANTIATE_VTABLE` in one more
+translation unit, so that vtables are only instantiated there. For each build,
+the total compile time, the largest peak memory usage of a compilation, the
+total size of the object files, the link time and the size of the executable
+are reported. Compilers are run one at a time, so the numbers are only
+meaningful on an otherwise idle machine.
+"""
+
+import argparse
+import csv
+import os
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from measure import compile_once
+
+
+def generate_header(clauses, models, extern):
+    lines = [
+        '#include <dyno/concept.hpp>',
+        '#include <dyno/concept_map.hpp>',
+        '#include <dyno/poly.hpp>',
+        'using namespace dyno::literals;',
+        '',
+        'template <int J>',
+        'struct model {',
+        '  template <int I> int f(int x) const { return x + I + J; }',
+        '};',
+        '',
+    ]
+    declared, mapped = [], []
+    for i in range(clauses):
+        if i % 2 == 0:
+            declared.append('"f{0}"_s = dyno::method<int (int) const>'.format(i))
+        else:
+            declared.append('"f{0}"_s = dyno::function<int (dyno::T const&, int)>'.format(i))
+        mapped.append('"f{0}"_s = [](T const& self, int x) {{ return self.template f<{0}>(x); }}'.format(i))
+    lines.append('struct Widget : decltype(dyno::requires_(')
+    lines.append('  ' + ',\n  '.join(declared))
+    lines.append(')) { };')
+    lines.append('')
+    lines.append('template <typename T>')
+    lines.append('auto const dyno::default_concept_map<Widget, T> = dyno::make_concept_map(')
+    lines.append('  ' + ',\n  '.join(mapped))
+    lines.append(');')
+    lines.append('')
+    if extern:
+        lines += ['DYNO_EXTERN_VTABLE(Widget, model<{}>);'.format(j) for j in range(models)]
+        lines.append('')
+    return '\n'.join(lines) + '\n'
+
+
+def generate_tu(index, clauses, models):
+    call = 'p.virtual_("f{0}"_s)(1)' if index % clauses % 2 == 0 else 'p.virtual_("f{0}"_s)(p, 1)'
+    lines = [
+        '#include "widget.hpp"',
+        '',
+        'int use{}() {{'.format(index),
+        '  int sum = 0;',
+    ]
+    for j in range(models):
+        lines.append('  {{ dyno::poly<Widget> p{{model<{}>{{}}}}; sum += {}; }}'.format(
+            j, call.format(index % clauses)))
+    lines.append('  return sum;')
+    lines.append('}')
+    return '\n'.join(lines) + '\n'
+
+
+def generate_main(tus):
+    lines = ['int use{}();'.format(i) for i in range(tus)]
+    lines.append('')
+    lines.append('int main() {')
+    lines.append('  int sum = 0;')
+    lines += ['  sum += use{}();'.format(i) for i in range(tus)]
+    lines.append('  return sum != 0 ? 0 : 1;')
+    lines.append('}')
+    return '\n'.join(lines) + '\n'
+
+
+def generate_instantiations(models):
+    lines = ['#include "widget.hpp"', '']
+    lines += ['DYNO_INSTANTIATE_VTABLE(Widget, model<{}>);'.format(j) for j in range(models)]
+    return '\n'.join(lines) + '\n'
+
+
+def build(args, directory, extern):
+    sources = {'main.cpp': generate_main(args.tus)}
+    for i in range(args.tus):
+        sources['use{}.cpp'.format(i)] = generate_tu(i, args.clauses, args.models)
+    if extern:
+        sources['instantiations.cpp'] = generate_instantiations(args.models)
+    with open(os.path.join(directory, 'widget.hpp'), 'w') as f:
+        f.write(generate_header(args.clauses, args.models, extern))
+
+    compile_command = [args.compiler] + args.flags.split() + \
+                      ['-I' + d for d in args.include_dirs.split(';') if d]
+    results = dict(seconds=0.0, peak_kib=0, object_bytes=0)
+    objects = []
+    for name, contents in sorted(sources.items()):
+        source = os.path.join(directory, name)
+        with open(source, 'w') as f:
+            f.write(contents)
+        objects.append(source + '.o')
+        seconds, peak = compile_once(compile_command + ['-c', source, '-o', objects[-1]])
+        results['seconds'] += seconds
+        results['peak_kib'] = max(results['peak_kib'], peak)
+        results['object_bytes'] += os.path.getsize(objects[-1])
+
+    executable = os.path.join(directory, 'project.exe')
+    results['link_seconds'], _ = compile_once([args.compiler] + objects + ['-o', executable])
+    results['executable_bytes'] = os.path.getsize(executable)
+    for o in objects:
+        os.remove(o)
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--compiler', required=True, help='C++ compiler to measure')
+    parser.add_argument('--flags', default='-std=c++17', help='flags passed to the compiler')
+    parser.add_argument('--include-dirs', default='', help='semicolon-separated include directories')
+    parser.add_argument('--tus', type=int, default=200, help='number of translation units using the models')
+    parser.add_argument('--clauses', type=int, default=10, help='number of clauses in the concept')
+    parser.add_argument('--models', type=int, default=10, help='number of models of the concept')
+    parser.add_argument('--output', required=True, help='CSV file to write the results to')
+    args = parser.parse_args()
+
+    fields = ['vtables', 'tus', 'clauses', 'models', 'seconds', 'peak_kib',
+              'object_bytes', 'link_seconds', 'executable_bytes']
+    with open(args.output, 'w', newline='') as out:
+        writer = csv.DictWriter(out, fieldnames=fields)
+        writer.writeheader()
+        print('{:<8} {:>9} {:>10} {:>13} {:>9} {:>12}'.format(
+            'vtables', 'seconds', 'peak (MiB)', 'objects (KiB)', 'link (s)', 'exe (KiB)'))
+        for vtables, extern in (('implicit', False), ('extern', True)):
+            with tempfile.TemporaryDirectory() as directory:
+                results = build(args, directory, extern)
+            writer.writerow(dict(vtables=vtables, tus=args.tus, clauses=args.clauses,
+                                 models=args.models, **results))
+            out.flush()
+            print('{:<8} {:>9.2f} {:>10.1f} {:>13.1f} {:>9.2f} {:>12.1f}'.format(
+                vtables, results['seconds'], results['peak_kib'] / 1024,
+                results['object_bytes'] / 1024, results['link_seconds'],
+                results['executable_bytes'] / 1024), flush=True)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,153 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+using namespace dyno::literals;
+
+
+// This benchmark measures the time it takes to get a large set of polymorphic
+// objects ready for use at startup. We compare:
+//
+// 1. Rebuilding a `std::vector<dyno::poly<...>>` from the parameters of the
+//    objects, which allocates each object separately.
+// 2. Rebuilding a `dyno::flat_poly_vector` from the same parameters.
+// 3. Mapping a `dyno::flat_poly_vector` written to a file with
+//    `dyno::mapped_poly_vector`, either without touching the objects or
+//    followed by a full scan.
+//
+// The file is in the page cache after the first iteration, so this measures
+// a warm start; a cold start also pays for reading the file from disk, but
+// only for the pages that are actually accessed.
+//
+// Scanning all the objects once is also measured for each container.
+
+static constexpr std::size_t objects = 1000000;
+
+struct Rule : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "matches"_s = dyno::method<bool (int) const>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<Rule, T> = dyno::make_concept_map(
+  "matches"_s = [](T const& self, int x) { return self.matches(x); }
+);
+
+struct Threshold {
+  int min;
+  bool matches(int x) const { return x >= min; }
+};
+
+struct Range {
+  std::int64_t low, high;
+  bool matches(int x) const { return low <= x && x < high; }
+};
+
+struct Never {
+  bool matches(int) const { return false; }
+};
+
+using Rules = dyno::model_registry<Threshold, Range, Never>;
+
+template <typename Push>
+static void generate(Push push) {
+  for (std::size_t i = 0; i != objects; ++i) {
+    int n = static_cast<int>(i % 1000);
+    switch (i % 3) {
+      case 0: push(Threshold{n}); break;
+      case 1: push(Range{n, n + 100}); break;
+      default: push(Never{}); break;
+    }
+  }
+}
+
+static std::string const& rules_file() {
+  static std::string const path = [] {
+    auto p = (std::filesystem::temp_directory_path() / "dyno.benchmark.flat_poly_vector.bin").string();
+    dyno::flat_poly_vector<Rule, Rules> rules;
+    generate([&](auto const& rule) { rules.push_back(rule); });
+    std::ofstream out{p, std::ios::binary};
+    rules.write(out);
+    return p;
+  }();
+  return path;
+}
+
+template <typename Container>
+static std::size_t scan(Container const& rules) {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i != rules.size(); ++i)
+    count += rules[i].virtual_("matches"_s)(500);
+  return count;
+}
+
+static void BM_rebuild_std_vector(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    std::vector<dyno::poly<Rule>> rules;
+    rules.reserve(objects);
+    generate([&](auto const& rule) { rules.emplace_back(rule); });
+    benchmark::DoNotOptimize(rules.data());
+  }
+}
+BENCHMARK(BM_rebuild_std_vector)->Unit(benchmark::kMillisecond);
+
+static void BM_rebuild_flat(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    dyno::flat_poly_vector<Rule, Rules> rules;
+    rules.reserve(objects, objects * sizeof(Range));
+    generate([&](auto const& rule) { rules.push_back(rule); });
+    benchmark::DoNotOptimize(rules.size());
+  }
+}
+BENCHMARK(BM_rebuild_flat)->Unit(benchmark::kMillisecond);
+
+static void BM_mmap_open(benchmark::State& state) {
+  std::string const& path = rules_file();
+  while (state.KeepRunning()) {
+    dyno::mapped_poly_vector<Rule, Rules> rules{path.c_str()};
+    benchmark::DoNotOptimize(rules[0].virtual_("matches"_s)(500));
+  }
+}
+BENCHMARK(BM_mmap_open)->Unit(benchmark::kMillisecond);
+
+static void BM_mmap_open_and_scan(benchmark::State& state) {
+  std::string const& path = rules_file();
+  while (state.KeepRunning()) {
+    dyno::mapped_poly_vector<Rule, Rules> rules{path.c_str()};
+    benchmark::DoNotOptimize(scan(rules));
+  }
+}
+BENCHMARK(BM_mmap_open_and_scan)->Unit(benchmark::kMillisecond);
+
+static void BM_scan_std_vector(benchmark::State& state) {
+  std::vector<dyno::poly<Rule>> rules;
+  rules.reserve(objects);
+  generate([&](auto const& rule) { rules.emplace_back(rule); });
+  while (state.KeepRunning()) {
+    std::size_t count = 0;
+    for (auto const& rule : rules)
+      count += rule.virtual_("matches"_s)(500);
+    benchmark::DoNotOptimize(count);
+  }
+}
+BENCHMARK(BM_scan_std_vector)->Unit(benchmark::kMillisecond);
+
+static void BM_scan_flat(benchmark::State& state) {
+  dyno::flat_poly_vector<Rule, Rules> rules;
+  generate([&](auto const& rule) { rules.push_back(rule); });
+  while (state.KeepRunning())
+    benchmark::DoNotOptimize(scan(rules));
+}
+BENCHMARK(BM_scan_flat)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
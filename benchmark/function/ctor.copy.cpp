@@ -0,0 +1,45 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "model.hpp"
+
+#include <dyno/function.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <functional>
+
+
+// This benchmark measures the overhead of copy-constructing function wrappers
+// holding lambdas with captures of different sizes.
+
+template <typename Function, typename Lambda>
+static void BM_ctor_copy(benchmark::State& state) {
+  Lambda lambda = make_lambda<sizeof(Lambda) == 1 ? 0 : sizeof(Lambda)>();
+  Function const f{lambda};
+  while (state.KeepRunning()) {
+    Function copy{f};
+    benchmark::DoNotOptimize(copy);
+  }
+}
+
+using Signature = int(int);
+
+BENCHMARK_TEMPLATE(BM_ctor_copy, std::function<Signature>,            lambda<0>);
+BENCHMARK_TEMPLATE(BM_ctor_copy, dyno::any_function<Signature>,       lambda<0>);
+BENCHMARK_TEMPLATE(BM_ctor_copy, dyno::function_ref<Signature>,       lambda<0>);
+BENCHMARK_TEMPLATE(BM_ctor_copy, handrolled_function_ref<Signature>,  lambda<0>);
+
+BENCHMARK_TEMPLATE(BM_ctor_copy, std::function<Signature>,            lambda<8>);
+BENCHMARK_TEMPLATE(BM_ctor_copy, dyno::any_function<Signature>,       lambda<8>);
+
+BENCHMARK_TEMPLATE(BM_ctor_copy, std::function<Signature>,            lambda<16>);
+BENCHMARK_TEMPLATE(BM_ctor_copy, dyno::any_function<Signature>,       lambda<16>);
+
+BENCHMARK_TEMPLATE(BM_ctor_copy, std::function<Signature>,            lambda<32>);
+BENCHMARK_TEMPLATE(BM_ctor_copy, dyno::any_function<Signature>,       lambda<32>);
+
+BENCHMARK_TEMPLATE(BM_ctor_copy, std::function<Signature>,            lambda<64>);
+BENCHMARK_TEMPLATE(BM_ctor_copy, dyno::any_function<Signature>,       lambda<64>);
+BENCHMARK_MAIN();
@@ -0,0 +1,49 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "model.hpp"
+
+#include <dyno/function.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <functional>
+
+
+// This benchmark measures the overhead of invoking function wrappers holding
+// lambdas with captures of different sizes.
+
+template <typename Function, typename Lambda>
+static void BM_invoke(benchmark::State& state) {
+  Lambda lambda = make_lambda<sizeof(Lambda) == 1 ? 0 : sizeof(Lambda)>();
+  Function f{lambda};
+  int const N = state.range(0);
+  int x = 0;
+  while (state.KeepRunning()) {
+    for (int i = 0; i != N; ++i) {
+      benchmark::DoNotOptimize(f);
+      x = f(x);
+    }
+  }
+  benchmark::DoNotOptimize(x);
+}
+
+using Signature = int(int);
+static constexpr int N = 100;
+
+BENCHMARK_TEMPLATE(BM_invoke, std::function<Signature>,             lambda<0>)->Arg(N);
+BENCHMARK_TEMPLATE(BM_invoke, dyno::any_function<Signature>,        lambda<0>)->Arg(N);
+BENCHMARK_TEMPLATE(BM_invoke, dyno::function_ref<Signature>,        lambda<0>)->Arg(N);
+BENCHMARK_TEMPLATE(BM_invoke, handrolled_function_ref<Signature>,   lambda<0>)->Arg(N);
+
+BENCHMARK_TEMPLATE(BM_invoke, std::function<Signature>,             lambda<16>)->Arg(N);
+BENCHMARK_TEMPLATE(BM_invoke, dyno::any_function<Signature>,        lambda<16>)->Arg(N);
+BENCHMARK_TEMPLATE(BM_invoke, dyno::function_ref<Signature>,        lambda<16>)->Arg(N);
+BENCHMARK_TEMPLATE(BM_invoke, handrolled_function_ref<Signature>,   lambda<16>)->Arg(N);
+
+BENCHMARK_TEMPLATE(BM_invoke, std::function<Signature>,             lambda<64>)->Arg(N);
+BENCHMARK_TEMPLATE(BM_invoke, dyno::any_function<Signature>,        lambda<64>)->Arg(N);
+BENCHMARK_TEMPLATE(BM_invoke, dyno::function_ref<Signature>,        lambda<64>)->Arg(N);
+BENCHMARK_TEMPLATE(BM_invoke, handrolled_function_ref<Signature>,   lambda<64>)->Arg(N);
+BENCHMARK_MAIN();
@@ -0,0 +1,59 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef BENCHMARK_FUNCTION_MODEL_HPP
+#define BENCHMARK_FUNCTION_MODEL_HPP
+
+#include <dyno/function.hpp>
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+
+// Returns a lambda whose captures take `Bytes` bytes (a capture-less lambda
+// is returned when `Bytes == 0`).
+template <std::size_t Bytes>
+auto make_lambda() {
+  if constexpr (Bytes == 0) {
+    return [](int i) { return i + 1; };
+  } else {
+    std::array<unsigned char, Bytes> captured{};
+    captured[0] = 1;
+    return [captured](int i) { return i + captured[0]; };
+  }
+}
+
+template <std::size_t Bytes>
+using lambda = decltype(make_lambda<Bytes>());
+
+// Hand-rolled non-owning function reference, as could be written without
+// any library support.
+template <typename Signature>
+class handrolled_function_ref;
+
+template <typename R, typename ...Args>
+class handrolled_function_ref<R(Args...)> {
+  void* object_;
+  R (*call_)(void*, Args...);
+
+public:
+  template <typename F, typename RawF = std::remove_reference_t<F>,
+    typename = std::enable_if_t<!std::is_same<std::decay_t<F>, handrolled_function_ref>{}>
+  >
+  handrolled_function_ref(F&& f)
+    : object_{const_cast<void*>(static_cast<void const*>(std::addressof(f)))}
+    , call_{[](void* object, Args ...args) -> R {
+      return (*static_cast<RawF*>(object))(std::forward<Args>(args)...);
+    }}
+  { }
+
+  R operator()(Args ...args) const {
+    return call_(object_, std::forward<Args>(args)...);
+  }
+};
+
+#endif // BENCHMARK_FUNCTION_MODEL_HPP
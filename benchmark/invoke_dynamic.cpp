@@ -0,0 +1,113 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <any>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+using namespace dyno::literals;
+
+
+// This benchmark measures the cost of calling a function of an object given
+// its name as a string, like a scripting language binding would. We compare:
+//
+// 1. `dyno::poly::invoke_dynamic`, which finds the function with a perfect
+//    hash computed at compile-time.
+// 2. A `std::unordered_map` from names to `std::function`s wrapping the
+//    same functions, which is what such bindings usually do by hand.
+//
+// Both marshal the arguments and the result through `std::any`, so the
+// difference is in the lookup.
+
+struct Widget : decltype(dyno::requires_(
+  "width"_s = dyno::method<int () const>,
+  "height"_s = dyno::method<int () const>,
+  "resize"_s = dyno::method<void (int, int)>,
+  "move_by"_s = dyno::method<void (int, int)>,
+  "set_visible"_s = dyno::method<void (bool)>,
+  "visible"_s = dyno::method<bool () const>,
+  "area"_s = dyno::method<int () const>,
+  "contains"_s = dyno::method<bool (int, int) const>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<Widget, T> = dyno::make_concept_map(
+  "width"_s = [](T const& self) { return self.w; },
+  "height"_s = [](T const& self) { return self.h; },
+  "resize"_s = [](T& self, int w, int h) { self.w = w; self.h = h; },
+  "move_by"_s = [](T& self, int dx, int dy) { self.x += dx; self.y += dy; },
+  "set_visible"_s = [](T& self, bool v) { self.shown = v; },
+  "visible"_s = [](T const& self) { return self.shown; },
+  "area"_s = [](T const& self) { return self.w * self.h; },
+  "contains"_s = [](T const& self, int x, int y) {
+    return self.x <= x && x < self.x + self.w && self.y <= y && y < self.y + self.h;
+  }
+);
+
+struct button {
+  int x = 0, y = 0, w = 10, h = 10;
+  bool shown = true;
+};
+
+using handler = std::function<std::any (std::any*, std::size_t)>;
+
+static std::unordered_map<std::string, handler> make_handlers(dyno::poly<Widget>& w) {
+  std::unordered_map<std::string, handler> handlers;
+  handlers["width"] = [&w](std::any*, std::size_t) -> std::any { return w.virtual_("width"_s)(); };
+  handlers["height"] = [&w](std::any*, std::size_t) -> std::any { return w.virtual_("height"_s)(); };
+  handlers["resize"] = [&w](std::any* a, std::size_t) -> std::any {
+    w.virtual_("resize"_s)(std::any_cast<int&>(a[0]), std::any_cast<int&>(a[1]));
+    return {};
+  };
+  handlers["move_by"] = [&w](std::any* a, std::size_t) -> std::any {
+    w.virtual_("move_by"_s)(std::any_cast<int&>(a[0]), std::any_cast<int&>(a[1]));
+    return {};
+  };
+  handlers["set_visible"] = [&w](std::any* a, std::size_t) -> std::any {
+    w.virtual_("set_visible"_s)(std::any_cast<bool&>(a[0]));
+    return {};
+  };
+  handlers["visible"] = [&w](std::any*, std::size_t) -> std::any { return w.virtual_("visible"_s)(); };
+  handlers["area"] = [&w](std::any*, std::size_t) -> std::any { return w.virtual_("area"_s)(); };
+  handlers["contains"] = [&w](std::any* a, std::size_t) -> std::any {
+    return w.virtual_("contains"_s)(std::any_cast<int&>(a[0]), std::any_cast<int&>(a[1]));
+  };
+  return handlers;
+}
+
+// The names come from the script at runtime; we cycle through them.
+static std::string_view const names[] = {"area", "contains", "width", "visible"};
+static std::size_t const arities[] = {0, 2, 0, 0};
+
+static void BM_invoke_dynamic(benchmark::State& state) {
+  dyno::poly<Widget> w{button{}};
+  std::any args[] = {3, 4};
+  std::size_t i = 0;
+  while (state.KeepRunning()) {
+    std::size_t k = i++ % 4;
+    benchmark::DoNotOptimize(w.invoke_dynamic(names[k], args, arities[k]));
+  }
+}
+BENCHMARK(BM_invoke_dynamic);
+
+static void BM_unordered_map(benchmark::State& state) {
+  dyno::poly<Widget> w{button{}};
+  auto handlers = make_handlers(w);
+  std::any args[] = {3, 4};
+  std::size_t i = 0;
+  while (state.KeepRunning()) {
+    std::size_t k = i++ % 4;
+    auto it = handlers.find(std::string{names[k]});
+    benchmark::DoNotOptimize(it->second(args, arities[k]));
+  }
+}
+BENCHMARK(BM_unordered_map);
+
+BENCHMARK_MAIN();
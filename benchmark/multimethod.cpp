@@ -0,0 +1,132 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+using namespace dyno::literals;
+
+
+// This benchmark compares double dispatch implemented with the visitor pattern
+// against a `dyno::multimethod`. Both sides collide all pairs of objects in a
+// collection of shapes with three different dynamic types.
+
+namespace { namespace visitor {
+  struct Circle; struct Square; struct Triangle;
+
+  struct Shape {
+    virtual int collide(Shape const& other) const = 0;
+    virtual int collide_with(Circle const&) const = 0;
+    virtual int collide_with(Square const&) const = 0;
+    virtual int collide_with(Triangle const&) const = 0;
+    virtual ~Shape() { }
+  };
+
+  struct Circle : Shape {
+    int collide(Shape const& other) const override { return other.collide_with(*this); }
+    int collide_with(Circle const&) const override { return 1; }
+    int collide_with(Square const&) const override { return 2; }
+    int collide_with(Triangle const&) const override { return 3; }
+  };
+
+  struct Square : Shape {
+    int collide(Shape const& other) const override { return other.collide_with(*this); }
+    int collide_with(Circle const&) const override { return 4; }
+    int collide_with(Square const&) const override { return 5; }
+    int collide_with(Triangle const&) const override { return 6; }
+  };
+
+  struct Triangle : Shape {
+    int collide(Shape const& other) const override { return other.collide_with(*this); }
+    int collide_with(Circle const&) const override { return 7; }
+    int collide_with(Square const&) const override { return 8; }
+    int collide_with(Triangle const&) const override { return 9; }
+  };
+
+  std::vector<std::unique_ptr<Shape>> make_shapes(std::size_t n) {
+    std::vector<std::unique_ptr<Shape>> shapes;
+    for (std::size_t i = 0; i != n; ++i) {
+      switch (i % 3) {
+        case 0: shapes.push_back(std::make_unique<Circle>()); break;
+        case 1: shapes.push_back(std::make_unique<Square>()); break;
+        default: shapes.push_back(std::make_unique<Triangle>()); break;
+      }
+    }
+    return shapes;
+  }
+
+  int collide(std::unique_ptr<Shape> const& a, std::unique_ptr<Shape> const& b) {
+    return a->collide(*b);
+  }
+}} // end namespace visitor
+
+namespace { namespace multimethod {
+  struct Shape : decltype(dyno::requires_(
+    dyno::CopyConstructible{},
+    "collide"_s = dyno::multimethod<int (dyno::T const&, dyno::T const&)>
+  )) { };
+
+  struct Circle { };
+  struct Square { };
+  struct Triangle { };
+
+  struct shape {
+    template <typename T>
+    shape(T t) : poly_{t} { }
+
+    friend int collide(shape const& a, shape const& b) {
+      return a.poly_.virtual_("collide"_s)(a.poly_, b.poly_);
+    }
+
+  private:
+    dyno::poly<Shape> poly_;
+  };
+
+  void define_collisions() {
+    dyno::define_multimethod<Shape>("collide"_s, [](Circle const&, Circle const&) { return 1; });
+    dyno::define_multimethod<Shape>("collide"_s, [](Square const&, Circle const&) { return 2; });
+    dyno::define_multimethod<Shape>("collide"_s, [](Triangle const&, Circle const&) { return 3; });
+    dyno::define_multimethod<Shape>("collide"_s, [](Circle const&, Square const&) { return 4; });
+    dyno::define_multimethod<Shape>("collide"_s, [](Square const&, Square const&) { return 5; });
+    dyno::define_multimethod<Shape>("collide"_s, [](Triangle const&, Square const&) { return 6; });
+    dyno::define_multimethod<Shape>("collide"_s, [](Circle const&, Triangle const&) { return 7; });
+    dyno::define_multimethod<Shape>("collide"_s, [](Square const&, Triangle const&) { return 8; });
+    dyno::define_multimethod<Shape>("collide"_s, [](Triangle const&, Triangle const&) { return 9; });
+  }
+
+  std::vector<shape> make_shapes(std::size_t n) {
+    define_collisions();
+    std::vector<shape> shapes;
+    for (std::size_t i = 0; i != n; ++i) {
+      switch (i % 3) {
+        case 0: shapes.push_back(Circle{}); break;
+        case 1: shapes.push_back(Square{}); break;
+        default: shapes.push_back(Triangle{}); break;
+      }
+    }
+    return shapes;
+  }
+}} // end namespace multimethod
+
+template <typename Shapes>
+static void BM_collide_all(benchmark::State& state, Shapes shapes) {
+  int total = 0;
+  while (state.KeepRunning()) {
+    for (auto const& a : shapes) {
+      for (auto const& b : shapes) {
+        total += collide(a, b);
+      }
+    }
+    benchmark::DoNotOptimize(total);
+  }
+}
+
+static constexpr std::size_t N = 100;
+BENCHMARK_CAPTURE(BM_collide_all, visitor, visitor::make_shapes(N));
+BENCHMARK_CAPTURE(BM_collide_all, dyno_multimethod, multimethod::make_shapes(N));
+BENCHMARK_MAIN();
@@ -0,0 +1,98 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+using namespace dyno::literals;
+
+
+// This benchmark measures the cost of calling a kernel that has an AVX2 and
+// a scalar implementation through a `dyno::poly`. We compare:
+//
+// 1. A concept map using `dyno::multiversion`, where the vtable points
+//    directly to the implementation selected when the vtable was created.
+// 2. A concept map checking the CPU features inside the model, on each call,
+//    which is what models had to do without `dyno::multiversion`.
+// 3. A concept map always using the scalar implementation, as a baseline.
+//
+// On CPUs without AVX2 (or outside of x86), all three use the scalar
+// implementation. Kernels over a single element mostly measure the cost of
+// the dispatch.
+
+#if defined(DYNO_HAS_CPU_SUPPORTS)
+#  define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#  define TARGET_AVX2
+#endif
+
+TARGET_AVX2 static std::int32_t sum_avx2(std::int32_t const* data, std::size_t n) {
+  std::int32_t sum = 0;
+  for (std::size_t i = 0; i != n; ++i)
+    sum += data[i] * data[i];
+  return sum;
+}
+
+static std::int32_t sum_scalar(std::int32_t const* data, std::size_t n) {
+  std::int32_t sum = 0;
+  for (std::size_t i = 0; i != n; ++i)
+    sum += data[i] * data[i];
+  return sum;
+}
+
+static bool has_avx2() {
+#if defined(DYNO_HAS_CPU_SUPPORTS)
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+struct Kernel : decltype(dyno::requires_(
+  "run"_s = dyno::method<std::int32_t (std::int32_t const*, std::size_t) const>
+)) { };
+
+struct multiversioned_kernel { };
+struct checking_kernel { };
+struct scalar_kernel { };
+
+template <>
+auto const dyno::concept_map<Kernel, multiversioned_kernel> = dyno::make_concept_map(
+  "run"_s = dyno::multiversion<dyno::isa::avx2>(
+    [](multiversioned_kernel const&, std::int32_t const* data, std::size_t n) { return sum_avx2(data, n); },
+    [](multiversioned_kernel const&, std::int32_t const* data, std::size_t n) { return sum_scalar(data, n); }
+  )
+);
+
+template <>
+auto const dyno::concept_map<Kernel, checking_kernel> = dyno::make_concept_map(
+  "run"_s = [](checking_kernel const&, std::int32_t const* data, std::size_t n) {
+    return has_avx2() ? sum_avx2(data, n) : sum_scalar(data, n);
+  }
+);
+
+template <>
+auto const dyno::concept_map<Kernel, scalar_kernel> = dyno::make_concept_map(
+  "run"_s = [](scalar_kernel const&, std::int32_t const* data, std::size_t n) {
+    return sum_scalar(data, n);
+  }
+);
+
+template <typename Model>
+static void BM_kernel(benchmark::State& state) {
+  std::vector<std::int32_t> data(static_cast<std::size_t>(state.range(0)), 3);
+  dyno::poly<Kernel> kernel{Model{}};
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(kernel.virtual_("run"_s)(data.data(), data.size()));
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_kernel, multiversioned_kernel)->Arg(1)->Arg(16)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_kernel, checking_kernel)->Arg(1)->Arg(16)->Arg(1024);
+BENCHMARK_TEMPLATE(BM_kernel, scalar_kernel)->Arg(1)->Arg(16)->Arg(1024);
+BENCHMARK_MAIN();
@@ -0,0 +1,74 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <numeric>
+#include <vector>
+using namespace dyno::literals;
+
+
+// This benchmark runs the same generic algorithm, written once against the
+// interface of `dyno::poly`, over iterators held in a `dyno::poly` and in a
+// `dyno::static_poly`. The baseline is the same loop over raw iterators.
+
+struct Iterator : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  dyno::EqualityComparable{},
+  "increment"_s = dyno::function<void (dyno::T&)>,
+  "dereference"_s = dyno::function<int& (dyno::T&)>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<Iterator, T> = dyno::make_concept_map(
+  "increment"_s = [](T& self) { ++self; },
+  "dereference"_s = [](T& self) -> int& { return *self; }
+);
+
+template <typename It>
+int accumulate(It first, It const& last) {
+  int result = 0;
+  while (!first.virtual_("equal"_s)(first, last)) {
+    result += first.virtual_("dereference"_s)(first);
+    first.virtual_("increment"_s)(first);
+  }
+  return result;
+}
+
+using vector_iterator = std::vector<int>::iterator;
+
+static void BM_raw(benchmark::State& state) {
+  std::vector<int> input(state.range(0));
+  std::iota(input.begin(), input.end(), 0);
+  while (state.KeepRunning()) {
+    int result = std::accumulate(input.begin(), input.end(), 0);
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+template <typename Iterator>
+static void run(benchmark::State& state) {
+  std::vector<int> input(state.range(0));
+  std::iota(input.begin(), input.end(), 0);
+  while (state.KeepRunning()) {
+    Iterator first{input.begin()}, last{input.end()};
+    int result = accumulate(first, last);
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+static void BM_poly(benchmark::State& state) {
+  run<dyno::poly<Iterator, dyno::local_storage<8>>>(state);
+}
+
+static void BM_static_poly(benchmark::State& state) {
+  run<dyno::static_poly<Iterator, vector_iterator>>(state);
+}
+
+BENCHMARK(BM_raw)->Arg(1000);
+BENCHMARK(BM_poly)->Arg(1000);
+BENCHMARK(BM_static_poly)->Arg(1000);
+BENCHMARK_MAIN();
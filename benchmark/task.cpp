@@ -0,0 +1,149 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <utility>
+using namespace dyno::literals;
+
+
+// This benchmark measures the cost of calling asynchronous handlers through
+// type erasure, in awaits per second. We compare:
+//
+// 1. Handlers with a `dyno::async_method`, whose coroutines are awaited from
+//    another coroutine. Coroutine frames are recycled by `dyno::task`.
+// 2. Handlers taking a `std::function<void(int)>` callback, which they call
+//    with the result. The caller chains the next call from the callback.
+//
+// In the `immediate` benchmarks, the handlers complete synchronously. In the
+// `deferred` benchmarks, they go through a single-threaded event loop once
+// before completing, like they would when waiting for I/O.
+
+static constexpr int calls = 1000;
+
+struct loop_type {
+  std::deque<std::coroutine_handle<>> coroutines;
+  std::deque<std::function<void()>> callbacks;
+
+  auto yield() {
+    struct awaiter {
+      loop_type* loop;
+      bool await_ready() noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> h) { loop->coroutines.push_back(h); }
+      void await_resume() noexcept { }
+    };
+    return awaiter{this};
+  }
+
+  void drain() {
+    while (!coroutines.empty() || !callbacks.empty()) {
+      if (!coroutines.empty()) {
+        auto h = coroutines.front();
+        coroutines.pop_front();
+        h.resume();
+      } else {
+        auto f = std::move(callbacks.front());
+        callbacks.pop_front();
+        f();
+      }
+    }
+  }
+};
+
+struct AsyncHandler : decltype(dyno::requires_(
+  dyno::MoveConstructible{},
+  "handle"_s = dyno::async_method<int (int)>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<AsyncHandler, T> = dyno::make_concept_map(
+  "handle"_s = [](T& self, int x) { return self.handle(x); }
+);
+
+struct CallbackHandler : decltype(dyno::requires_(
+  dyno::MoveConstructible{},
+  "handle"_s = dyno::method<void (int, std::function<void(int)>)>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<CallbackHandler, T> = dyno::make_concept_map(
+  "handle"_s = [](T& self, int x, std::function<void(int)> k) { self.handle(x, std::move(k)); }
+);
+
+template <bool Deferred>
+struct async_handler {
+  loop_type* loop;
+  dyno::task<int> handle(int x) {
+    if constexpr (Deferred)
+      co_await loop->yield();
+    co_return x + 1;
+  }
+};
+
+template <bool Deferred>
+struct callback_handler {
+  loop_type* loop;
+  void handle(int x, std::function<void(int)> k) {
+    if constexpr (Deferred)
+      loop->callbacks.push_back([x, k = std::move(k)] { k(x + 1); });
+    else
+      k(x + 1);
+  }
+};
+
+static dyno::task<std::int64_t> drive(dyno::poly<AsyncHandler>& handler) {
+  std::int64_t total = 0;
+  for (int i = 0; i != calls; ++i)
+    total += co_await handler.virtual_("handle"_s)(i);
+  co_return total;
+}
+
+template <bool Deferred>
+static void BM_dyno_task(benchmark::State& state) {
+  loop_type loop;
+  dyno::poly<AsyncHandler> handler{async_handler<Deferred>{&loop}};
+  while (state.KeepRunning()) {
+    auto t = drive(handler);
+    t.start();
+    loop.drain();
+    benchmark::DoNotOptimize(t.get());
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * calls);
+}
+
+// Calls the handler with `i`, and with `i + 1` from the callback, and so on.
+static void chain(dyno::poly<CallbackHandler>& handler, int i, std::int64_t& total) {
+  if (i == calls)
+    return;
+  handler.virtual_("handle"_s)(i, [&handler, i, &total](int result) {
+    total += result;
+    chain(handler, i + 1, total);
+  });
+}
+
+template <bool Deferred>
+static void BM_std_function(benchmark::State& state) {
+  loop_type loop;
+  dyno::poly<CallbackHandler> handler{callback_handler<Deferred>{&loop}};
+  while (state.KeepRunning()) {
+    std::int64_t total = 0;
+    chain(handler, 0, total);
+    loop.drain();
+    benchmark::DoNotOptimize(total);
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) * calls);
+}
+
+BENCHMARK_TEMPLATE(BM_dyno_task, false)->Name("immediate/dyno_task");
+BENCHMARK_TEMPLATE(BM_std_function, false)->Name("immediate/std_function");
+BENCHMARK_TEMPLATE(BM_dyno_task, true)->Name("deferred/dyno_task");
+BENCHMARK_TEMPLATE(BM_std_function, true)->Name("deferred/std_function");
+BENCHMARK_MAIN();
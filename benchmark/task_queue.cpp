@@ -0,0 +1,130 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+using namespace dyno::literals;
+
+
+// This benchmark measures the throughput and the latency of passing tasks
+// from many producer threads to a single consumer thread, through a
+// `dyno::task_queue` and through a `std::queue<std::function<void()>>`
+// protected by a mutex. The number of producers is the argument of the
+// benchmark. The latency is the average time between pushing a task and
+// running it, which includes the time spent waiting in the queue.
+//
+// The tasks carry a few words of state, like most real tasks do, which is
+// too much for the small buffer of `std::function` in common implementations.
+
+using clock_type = std::chrono::steady_clock;
+static constexpr std::size_t tasks_per_producer = 20000;
+
+struct Task : decltype(dyno::requires_(
+  "run"_s = dyno::method<void ()>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<Task, T> = dyno::make_concept_map(
+  "run"_s = [](T& self) { self(); }
+);
+
+struct stats {
+  std::int64_t total_latency_ns = 0;
+  std::uint64_t checksum = 0;
+};
+
+static auto make_task(stats* s, std::uint64_t payload) {
+  auto pushed = clock_type::now();
+  return [s, pushed, a = payload, b = payload * 3, c = payload * 7] {
+    s->total_latency_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+      clock_type::now() - pushed
+    ).count();
+    s->checksum += a + b + c;
+  };
+}
+
+static void report(benchmark::State& state, stats const& s, std::size_t tasks) {
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * tasks));
+  state.counters["latency_ns"] = static_cast<double>(s.total_latency_ns) /
+                                 static_cast<double>(state.iterations() * tasks);
+  benchmark::DoNotOptimize(s.checksum);
+}
+
+static void BM_task_queue(benchmark::State& state) {
+  auto const producers = static_cast<std::size_t>(state.range(0));
+  std::size_t const tasks = producers * tasks_per_producer;
+  dyno::task_queue<Task, 64> queue{1024};
+  stats s;
+  while (state.KeepRunning()) {
+    std::vector<std::thread> threads;
+    for (std::size_t p = 0; p != producers; ++p) {
+      threads.emplace_back([&queue, &s] {
+        for (std::size_t i = 0; i != tasks_per_producer; ++i)
+          queue.push(make_task(&s, i));
+      });
+    }
+    for (std::size_t popped = 0; popped != tasks; ) {
+      if (queue.try_pop([](auto& task) { task.virtual_("run"_s)(); }))
+        ++popped;
+      else
+        std::this_thread::yield();
+    }
+    for (auto& t : threads)
+      t.join();
+  }
+  report(state, s, tasks);
+}
+
+static void BM_locked_std_queue(benchmark::State& state) {
+  auto const producers = static_cast<std::size_t>(state.range(0));
+  std::size_t const tasks = producers * tasks_per_producer;
+  std::queue<std::function<void()>> queue;
+  std::mutex mutex;
+  stats s;
+  while (state.KeepRunning()) {
+    std::vector<std::thread> threads;
+    for (std::size_t p = 0; p != producers; ++p) {
+      threads.emplace_back([&queue, &mutex, &s] {
+        for (std::size_t i = 0; i != tasks_per_producer; ++i) {
+          std::function<void()> task{make_task(&s, i)};
+          std::lock_guard<std::mutex> lock{mutex};
+          queue.push(std::move(task));
+        }
+      });
+    }
+    for (std::size_t popped = 0; popped != tasks; ) {
+      std::function<void()> task;
+      {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (!queue.empty()) {
+          task = std::move(queue.front());
+          queue.pop();
+        }
+      }
+      if (task) {
+        task();
+        ++popped;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    for (auto& t : threads)
+      t.join();
+  }
+  report(state, s, tasks);
+}
+
+BENCHMARK(BM_task_queue)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+BENCHMARK(BM_locked_std_queue)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+BENCHMARK_MAIN();
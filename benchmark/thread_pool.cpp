@@ -0,0 +1,148 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// This benchmark compares `dyno::thread_pool` with a simple thread pool made
+// of a single `std::deque<std::function<void()>>` protected by a mutex, with
+// a condition variable to wake up idle workers. Two workloads are measured:
+//
+// 1. A burst of small tasks submitted from outside of the pool.
+// 2. A binary tree of tasks, where each task submits its two children to the
+//    pool. This is where work-stealing shines, since tasks spawned by workers
+//    go to their own deque without contending on a shared queue.
+//
+// The tasks carry a few words of state, which is too much for the small
+// buffer of `std::function` in common implementations, but fits in the
+// small buffer of `dyno::thread_pool`.
+
+class locked_pool {
+public:
+  explicit locked_pool(std::size_t threads) {
+    for (std::size_t i = 0; i != threads; ++i)
+      threads_.emplace_back([this] { this->work(); });
+  }
+
+  ~locked_pool() {
+    this->wait();
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& t : threads_)
+      t.join();
+  }
+
+  template <typename F>
+  void submit(F&& f) {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> lock{mutex_};
+      tasks_.emplace_back(std::forward<F>(f));
+    }
+    cv_.notify_one();
+  }
+
+  void wait() {
+    while (pending_.load(std::memory_order_acquire) != 0)
+      std::this_thread::yield();
+  }
+
+private:
+  void work() {
+    while (true) {
+      std::function<void()> task;
+      {
+        std::unique_lock<std::mutex> lock{mutex_};
+        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty())
+          return;
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      task();
+      pending_.fetch_sub(1, std::memory_order_release);
+    }
+  }
+
+  std::vector<std::thread> threads_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::atomic<std::size_t> pending_{0};
+  bool stop_ = false;
+};
+
+static std::size_t pool_size() {
+  return std::max(2u, std::thread::hardware_concurrency());
+}
+
+template <typename Pool>
+static void BM_external_burst(benchmark::State& state) {
+  auto const tasks = static_cast<std::size_t>(state.range(0));
+  Pool pool{pool_size()};
+  std::atomic<std::uint64_t> checksum{0};
+  while (state.KeepRunning()) {
+    for (std::size_t i = 0; i != tasks; ++i) {
+      std::uint64_t a = i, b = i * 3, c = i * 7;
+      pool.submit([&checksum, a, b, c] {
+        checksum.fetch_add(a + b + c, std::memory_order_relaxed);
+      });
+    }
+    pool.wait();
+  }
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * tasks));
+  benchmark::DoNotOptimize(checksum.load());
+}
+
+template <typename Pool>
+static void fork(Pool& pool, std::atomic<std::uint64_t>& leaves, int depth,
+                 std::uint64_t a, std::uint64_t b)
+{
+  if (depth == 0) {
+    leaves.fetch_add(a + b, std::memory_order_relaxed);
+    return;
+  }
+  for (int child = 0; child != 2; ++child) {
+    pool.submit([&pool, &leaves, depth, a, b, child] {
+      fork(pool, leaves, depth - 1, a + static_cast<std::uint64_t>(child), b * 2);
+    });
+  }
+}
+
+template <typename Pool>
+static void BM_fork_tree(benchmark::State& state) {
+  auto const depth = static_cast<int>(state.range(0));
+  Pool pool{pool_size()};
+  std::atomic<std::uint64_t> leaves{0};
+  while (state.KeepRunning()) {
+    fork(pool, leaves, depth, 0, 1);
+    pool.wait();
+  }
+  // A tree of depth `d` has `2^(d+1) - 1` nodes, but the root is not a task.
+  state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()) *
+                          ((std::int64_t{2} << depth) - 2));
+  benchmark::DoNotOptimize(leaves.load());
+}
+
+BENCHMARK_TEMPLATE(BM_external_burst, dyno::thread_pool<>)->Arg(1 << 10)->Arg(1 << 14)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_external_burst, locked_pool)->Arg(1 << 10)->Arg(1 << 14)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_fork_tree, dyno::thread_pool<>)->Arg(10)->Arg(14)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_fork_tree, locked_pool)->Arg(10)->Arg(14)->UseRealTime();
+BENCHMARK_MAIN();
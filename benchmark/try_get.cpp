@@ -0,0 +1,76 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <vector>
+using namespace dyno::literals;
+
+
+// This benchmark compares always dispatching through the vtable with using
+// `poly::try_get` to special-case the most common type in a collection, in
+// which case the call can be inlined. The benchmark is parameterized on the
+// percentage of objects that have the common type.
+
+struct Shape : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "area"_s = dyno::method<double () const>
+)) { };
+
+struct Square { double side; double area() const { return side * side; } };
+struct Rectangle { double w, h; double area() const { return w * h; } };
+struct Circle { double r; double area() const { return 3.14159 * r * r; } };
+
+template <typename T>
+auto const dyno::default_concept_map<Shape, T> = dyno::make_concept_map(
+  "area"_s = [](T const& self) { return self.area(); }
+);
+
+using shape = dyno::poly<Shape, dyno::sbo_storage<16>>;
+
+static std::vector<shape> make_shapes(int percent_squares) {
+  std::vector<shape> shapes;
+  for (std::size_t i = 0; i != 1000; ++i) {
+    if (static_cast<int>(i % 100) < percent_squares)
+      shapes.emplace_back(Square{1.0 * i});
+    else if (i % 2)
+      shapes.emplace_back(Rectangle{1.0 * i, 2.0});
+    else
+      shapes.emplace_back(Circle{1.0 * i});
+  }
+  return shapes;
+}
+
+static void BM_always_dispatch(benchmark::State& state) {
+  std::vector<shape> shapes = make_shapes(state.range(0));
+  std::vector<double> areas(shapes.size());
+  while (state.KeepRunning()) {
+    for (std::size_t i = 0; i != shapes.size(); ++i)
+      areas[i] = shapes[i].virtual_("area"_s)();
+    benchmark::DoNotOptimize(areas.data());
+    benchmark::ClobberMemory();
+  }
+}
+
+static void BM_try_get(benchmark::State& state) {
+  std::vector<shape> shapes = make_shapes(state.range(0));
+  std::vector<double> areas(shapes.size());
+  while (state.KeepRunning()) {
+    for (std::size_t i = 0; i != shapes.size(); ++i) {
+      if (Square const* square = shapes[i].try_get<Square>())
+        areas[i] = square->area();
+      else
+        areas[i] = shapes[i].virtual_("area"_s)();
+    }
+    benchmark::DoNotOptimize(areas.data());
+    benchmark::ClobberMemory();
+  }
+}
+
+BENCHMARK(BM_always_dispatch)->Arg(0)->Arg(50)->Arg(90)->Arg(100);
+BENCHMARK(BM_try_get)->Arg(0)->Arg(50)->Arg(90)->Arg(100);
+BENCHMARK_MAIN();
@@ -0,0 +1,87 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace dyno::literals;
+
+
+// This benchmark measures the cost of using polymorphic objects as the keys
+// of a `std::unordered_map`, with and without caching their hash. The keys
+// are long strings, so hashing them is expensive. Keys are hashed when they
+// are inserted (from a copy of an existing key) and when they are looked up.
+// With many keys, lookups are dominated by cache misses, so we also measure
+// a map that fits in the cache, where the cost of hashing is visible.
+
+struct Key : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  dyno::Hashable{},
+  "value"_s = dyno::method<std::string const& () const>
+)) { };
+
+template <>
+auto const dyno::concept_map<Key, std::string> = dyno::make_concept_map(
+  "value"_s = [](std::string const& self) -> std::string const& { return self; }
+);
+
+struct key_equal {
+  template <typename Poly>
+  bool operator()(Poly const& a, Poly const& b) const {
+    return a.virtual_("value"_s)() == b.virtual_("value"_s)();
+  }
+};
+
+static std::vector<std::string> make_strings(std::size_t n) {
+  std::vector<std::string> strings;
+  strings.reserve(n);
+  for (std::size_t i = 0; i != n; ++i)
+    strings.push_back(std::string(256, 'x') + std::to_string(i));
+  return strings;
+}
+
+template <typename Storage>
+static void BM_insert(benchmark::State& state) {
+  using Poly = dyno::poly<Key, Storage>;
+  std::vector<Poly> keys;
+  for (std::string const& s : make_strings(state.range(0)))
+    keys.emplace_back(s);
+
+  while (state.KeepRunning()) {
+    std::unordered_map<Poly, int, std::hash<Poly>, key_equal> map;
+    for (Poly const& key : keys)
+      map.emplace(key, 0);
+    benchmark::DoNotOptimize(map);
+  }
+}
+
+template <typename Storage>
+static void BM_find(benchmark::State& state) {
+  using Poly = dyno::poly<Key, Storage>;
+  std::vector<Poly> keys;
+  std::unordered_map<Poly, int, std::hash<Poly>, key_equal> map;
+  for (std::string const& s : make_strings(state.range(0))) {
+    keys.emplace_back(s);
+    map.emplace(Poly{s}, 0);
+  }
+
+  while (state.KeepRunning()) {
+    for (Poly const& key : keys)
+      benchmark::DoNotOptimize(map.find(key));
+  }
+}
+
+BENCHMARK_TEMPLATE(BM_insert, dyno::remote_storage)->Arg(10000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_insert, dyno::cached_hash_storage<dyno::remote_storage>)->Arg(10000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_find, dyno::remote_storage)->Arg(10000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_find, dyno::cached_hash_storage<dyno::remote_storage>)->Arg(10000)->Arg(1000000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,37 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "model.hpp"
+
+#include <dyno.hpp>
+
+#include <benchmark/benchmark.h>
+using namespace dyno::literals;
+
+
+// This benchmark measures the overhead of collecting statistics about virtual
+// calls using `dyno::instrumented`, with and without sampling the latency.
+
+template <typename VTablePolicy>
+static void BM_instrumented(benchmark::State& state) {
+  unsigned int x = 0;
+  model<VTablePolicy> m{x};
+  int const N = state.range(0);
+  while (state.KeepRunning()) {
+    for (int i = 0; i != N; ++i) {
+      benchmark::DoNotOptimize(m);
+      m.f1();
+      m.f2();
+    }
+  }
+}
+
+using remote = dyno::vtable<dyno::remote<dyno::everything>>;
+
+static constexpr int N = 100;
+BENCHMARK_TEMPLATE(BM_instrumented, remote)->Arg(N);
+BENCHMARK_TEMPLATE(BM_instrumented, dyno::instrumented<remote>)->Arg(N);
+BENCHMARK_TEMPLATE(BM_instrumented, dyno::instrumented<remote, 1024>)->Arg(N);
+BENCHMARK_TEMPLATE(BM_instrumented, dyno::instrumented<remote, 1>)->Arg(N);
+BENCHMARK_MAIN();
@@ -9,6 +9,8 @@
 #include <array>
 #include <cassert>
 #include <iterator>
+#include <list>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -56,6 +58,26 @@ int main() {
     DYNO_CHECK(result == input);
   }
 
+  ////////////////////////////////////////////////////////////////////////////
+  // Move-only elements
+  ////////////////////////////////////////////////////////////////////////////
+  {
+    using Iterator = any_iterator<std::unique_ptr<int>, std::forward_iterator_tag>;
+    std::list<std::unique_ptr<int>> input;
+    input.push_back(std::make_unique<int>(1));
+    input.push_back(std::make_unique<int>(2));
+
+    Iterator first{input.begin()}, last{input.end()};
+    DYNO_CHECK(**first == 1);
+
+    // Elements that can't be copied are read one at a time, in place.
+    auto c = first.next_chunk(last, nullptr, 0);
+    DYNO_CHECK(c.size == 1 && c.data == &input.front());
+    c = first.next_chunk(last, nullptr, 0);
+    DYNO_CHECK(c.size == 1 && c.data == &input.back());
+    DYNO_CHECK(first.next_chunk(last, nullptr, 0).size == 0);
+  }
+
   ////////////////////////////////////////////////////////////////////////////
   // Copy-construction
   ////////////////////////////////////////////////////////////////////////////
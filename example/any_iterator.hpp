@@ -8,12 +8,31 @@
 #include <dyno.hpp>
 
 #include <cassert>
+#include <cstddef>
 #include <iterator>
+#include <memory>
 #include <type_traits>
 #include <utility>
+#include <vector>
 using namespace dyno::literals;
 
 
+// A sequence of contiguous elements read from an iterator in one go (see the
+// "next_chunk" function of the Iterator concept below). Reading elements by
+// chunks amortizes the cost of the dynamic dispatch over many elements.
+template <typename Element>
+struct chunk {
+  Element const* data;
+  std::size_t size;
+
+  Element const* begin() const { return data; }
+  Element const* end() const { return data + size; }
+};
+
+template <typename Reference>
+using chunk_element_t = std::remove_cv_t<std::remove_reference_t<Reference>>;
+
+
 // This is the definition of an Iterator concept using a "generic" language.
 // Instead of defining specific methods that must be defined, it defines its
 // interface in terms of compile-time strings, assuming these may be fulfilled
@@ -25,7 +44,10 @@ struct Iterator : decltype(dyno::requires_(
   dyno::Destructible{},
   dyno::Swappable{},
   "increment"_s = dyno::function<void (dyno::T&)>,
-  "dereference"_s = dyno::function<Reference (dyno::T&)>
+  "dereference"_s = dyno::function<Reference (dyno::T&)>,
+  "next_chunk"_s = dyno::function<chunk<chunk_element_t<Reference>> (
+    dyno::T&, dyno::T const&, chunk_element_t<Reference>*, std::size_t
+  )>
 )) { };
 
 template <typename Reference>
@@ -54,13 +76,56 @@ struct RandomAccessIterator : decltype(dyno::requires_(
 )) { };
 
 
+namespace detail {
+  // Returns whether the elements in `[first, last)` can be read directly from
+  // memory as an array of `Element`s.
+  template <typename It, typename Element>
+  constexpr bool is_contiguous_over() {
+    using Value = typename std::iterator_traits<It>::value_type;
+    using Reference = typename std::iterator_traits<It>::reference;
+    constexpr bool is_contiguous = std::is_pointer<It>::value ||
+      std::is_same<It, typename std::vector<Value>::iterator>::value ||
+      std::is_same<It, typename std::vector<Value>::const_iterator>::value;
+    return is_contiguous && std::is_lvalue_reference<Reference>::value &&
+           std::is_same<std::remove_cv_t<Value>, Element>::value;
+  }
+} // end namespace detail
+
 // This is some kind of concept map; it maps the "generic" iterator interface
 // (method names as compile-time strings) to actual implementations for a
 // specific iterator type.
+//
+// "next_chunk" reads the elements starting at `self` (and before `last`), and
+// advances `self` past them. When the iterator is contiguous, all the elements
+// are returned as a single chunk pointing into the underlying sequence.
+// Otherwise, at most `capacity` elements are copied into `buffer`, which is
+// uninitialized storage. Elements that can't be copied (e.g. move-only types)
+// are returned one at a time instead, in a chunk pointing to the element
+// itself. An empty chunk is returned when `self == last`.
 template <typename Ref, typename T>
 auto const dyno::default_concept_map<Iterator<Ref>, T> = dyno::make_concept_map(
   "increment"_s = [](T& self) { ++self; },
-  "dereference"_s = [](T& self) -> Ref { return *self; }
+  "dereference"_s = [](T& self) -> Ref { return *self; },
+  "next_chunk"_s = [](T& self, T const& last, chunk_element_t<Ref>* buffer, std::size_t capacity) {
+    using Element = chunk_element_t<Ref>;
+    if constexpr (::detail::is_contiguous_over<T, Element>()) {
+      auto size = static_cast<std::size_t>(std::distance(self, last));
+      Element const* data = size == 0 ? nullptr : std::addressof(*self);
+      self = last;
+      return chunk<Element>{data, size};
+    } else if constexpr (std::is_constructible<Element, Ref>::value) {
+      std::size_t size = 0;
+      for (; size != capacity && !(self == last); ++self, ++size)
+        ::new (static_cast<void*>(buffer + size)) Element(*self);
+      return chunk<Element>{buffer, size};
+    } else {
+      if (self == last)
+        return chunk<Element>{nullptr, 0};
+      Element const* data = std::addressof(*self);
+      ++self;
+      return chunk<Element>{data, 1};
+    }
+  }
 );
 
 template <typename Ref, typename T>
@@ -191,6 +256,18 @@ public:
     return poly_.virtual_("dereference"_s)(poly_);
   }
 
+  // Reads the next elements before `last` and advances past them, with a
+  // single dynamic dispatch. `buffer` must point to uninitialized storage for
+  // `capacity` elements, which is used to hold copies of the elements when
+  // the erased iterator is not contiguous. When the returned chunk points
+  // into `buffer`, the caller is responsible for destroying its elements. An
+  // empty chunk is returned when the iterator is equal to `last`.
+  chunk<chunk_element_t<reference>>
+  next_chunk(any_iterator const& last, chunk_element_t<reference>* buffer, std::size_t capacity) {
+    assert(poly_.virtual_("typeid"_s)() == last.poly_.virtual_("typeid"_s)());
+    return poly_.virtual_("next_chunk"_s)(poly_, last.poly_, buffer, capacity);
+  }
+
   friend bool operator==(any_iterator const& a, any_iterator const& b) {
     assert(a.poly_.virtual_("typeid"_s)() == b.poly_.virtual_("typeid"_s)());
     return a.poly_.virtual_("equal"_s)(a.poly_, b.poly_);
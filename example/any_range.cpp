@@ -3,67 +3,31 @@
 // (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
 
 #include "../test/testing.hpp"
-#include "any_iterator.hpp"
-
-#include <dyno.hpp>
+#include "any_range.hpp"
 
 #include <algorithm>
+#include <cstddef>
 #include <iterator>
 #include <list>
-#include <utility>
+#include <memory>
+#include <numeric>
 #include <vector>
-using namespace dyno::literals;
 
 
 //
-// Example of creating an erased range type for holding anything that has
-// begin() and end() functions.
+// Tests
 //
 
-template <typename Value, typename Category>
-struct Range : decltype(dyno::requires_(
-  "begin"_s = dyno::function<any_iterator<Value, Category> (dyno::T&)>,
-  "end"_s = dyno::function<any_iterator<Value, Category> (dyno::T&)>,
-  "cbegin"_s = dyno::function<any_iterator<Value const, Category> (dyno::T const&)>,
-  "cend"_s = dyno::function<any_iterator<Value const, Category> (dyno::T const&)>
-)) { };
-
-template <typename Value, typename Category, typename R>
-auto const dyno::default_concept_map<Range<Value, Category>, R> = dyno::make_concept_map(
-  "begin"_s = [](R& range) -> any_iterator<Value, Category> {
-    return any_iterator<Value, Category>{range.begin()};
-  },
-  "end"_s = [](R& range) -> any_iterator<Value, Category> {
-    return any_iterator<Value, Category>{range.end()};
-  },
-  "cbegin"_s = [](R const& range) -> any_iterator<Value const, Category> {
-    return any_iterator<Value const, Category>{range.cbegin()};
-  },
-  "cend"_s = [](R const& range) -> any_iterator<Value const, Category> {
-    return any_iterator<Value const, Category>{range.cend()};
-  }
-);
-
-template <typename Value, typename Category>
-struct any_range {
-  template <typename Range>
-  any_range(Range&& r) : poly_{std::forward<Range>(r)} { }
-
-  auto begin()        { return poly_.virtual_("begin"_s)(poly_); }
-  auto end()          { return poly_.virtual_("end"_s)(poly_); }
-  auto begin() const  { return cbegin(); }
-  auto end() const    { return cend(); }
-
-  auto cbegin() const { return poly_.virtual_("cbegin"_s)(poly_); }
-  auto cend() const   { return poly_.virtual_("cend"_s)(poly_); }
-
-private:
-  dyno::poly<Range<Value, Category>> poly_;
+// Element type without a default constructor, which counts its live objects.
+struct Counted {
+  static int live;
+  int value;
+  explicit Counted(int v) : value{v} { ++live; }
+  Counted(Counted const& other) : value{other.value} { ++live; }
+  ~Counted() { --live; }
+  Counted& operator=(Counted const&) = default;
 };
-
-//
-// Tests
-//
+int Counted::live = 0;
 
 int main() {
   using Range = any_range<int, std::forward_iterator_tag>;
@@ -82,4 +46,112 @@ int main() {
     Range list = std::list<int>{1, 2, 3, 4, 5};
     DYNO_CHECK(std::equal(vector.cbegin(), vector.cend(), list.cbegin(), list.cend()));
   }
+  {
+    std::vector<int> input(1000);
+    std::iota(input.begin(), input.end(), 0);
+    Range vector = input;
+    Range list = std::list<int>(input.begin(), input.end());
+
+    std::vector<int> from_vector, from_list;
+    std::size_t vector_chunks = 0, list_chunks = 0;
+    vector.for_each_chunk([&](auto chunk) {
+      from_vector.insert(from_vector.end(), chunk.begin(), chunk.end());
+      ++vector_chunks;
+    });
+    list.for_each_chunk([&](auto chunk) {
+      from_list.insert(from_list.end(), chunk.begin(), chunk.end());
+      ++list_chunks;
+    });
+    DYNO_CHECK(from_vector == input);
+    DYNO_CHECK(from_list == input);
+    DYNO_CHECK(vector_chunks == 1);
+    DYNO_CHECK(list_chunks == 4);
+
+    // Returning `false` from the callback stops the iteration.
+    list_chunks = 0;
+    DYNO_CHECK(!list.for_each_chunk([&](auto) { ++list_chunks; return false; }));
+    DYNO_CHECK(list_chunks == 1);
+    DYNO_CHECK(list.for_each_chunk([&](auto) { return true; }));
+    DYNO_CHECK(find(list, 3) == 3);
+    DYNO_CHECK(find(list, 999) == 999);
+    DYNO_CHECK(find(list, -1) == 1000);
+  }
+  {
+    std::vector<int> input{1, 2, 3, 4, 5};
+    Range vector = input;
+    Range list = std::list<int>(input.begin(), input.end());
+    Range other = std::vector<int>{1, 2, 3, 4, 6};
+    Range shorter = std::list<int>{1, 2, 3, 4};
+
+    DYNO_CHECK(vector.contiguous_data().has_value());
+    DYNO_CHECK(!list.contiguous_data().has_value());
+    DYNO_CHECK(vector.contiguous_data()->size == 5);
+
+    DYNO_CHECK(equal(vector, list));
+    DYNO_CHECK(equal(list, vector));
+    DYNO_CHECK(equal(list, list));
+    DYNO_CHECK(equal(vector, vector));
+    DYNO_CHECK(!equal(vector, other));
+    DYNO_CHECK(!equal(list, other));
+    DYNO_CHECK(!equal(shorter, vector));
+    DYNO_CHECK(!equal(vector, shorter));
+
+    DYNO_CHECK(accumulate(vector, 0) == 15);
+    DYNO_CHECK(accumulate(list, 0) == 15);
+
+    DYNO_CHECK(find(vector, 3) == 2);
+    DYNO_CHECK(find(list, 3) == 2);
+    DYNO_CHECK(find(vector, 42) == 5);
+    DYNO_CHECK(find(list, 42) == 5);
+
+    std::vector<int> from_vector(5), from_list(5);
+    DYNO_CHECK(copy(vector, from_vector.begin()) == from_vector.end());
+    DYNO_CHECK(copy(list, from_list.begin()) == from_list.end());
+    DYNO_CHECK(from_vector == input);
+    DYNO_CHECK(from_list == input);
+  }
+  {
+    std::vector<int> input(1000);
+    std::iota(input.begin(), input.end(), 0);
+    Range list = std::list<int>(input.begin(), input.end());
+    DYNO_CHECK(find(list, 700) == 700);
+    DYNO_CHECK(equal(list, Range{input}));
+  }
+  {
+    // Copies of the elements are destroyed once their chunk is visited.
+    {
+      std::list<Counted> input;
+      for (int i = 0; i != 100; ++i)
+        input.emplace_back(i);
+      any_range<Counted, std::forward_iterator_tag> list = std::move(input);
+      int sum = 0;
+      list.for_each_chunk([&](auto chunk) {
+        for (Counted const& c : chunk)
+          sum += c.value;
+      });
+      DYNO_CHECK(sum == 4950);
+      DYNO_CHECK(Counted::live == 100);
+    }
+    DYNO_CHECK(Counted::live == 0);
+
+    // Move-only elements are visited in place, one at a time.
+    std::list<std::unique_ptr<int>> input;
+    input.push_back(std::make_unique<int>(1));
+    input.push_back(std::make_unique<int>(2));
+    any_range<std::unique_ptr<int>, std::forward_iterator_tag> list = std::move(input);
+    int sum = 0, chunks = 0;
+    list.for_each_chunk([&](auto chunk) {
+      for (auto const& p : chunk)
+        sum += *p;
+      ++chunks;
+    });
+    DYNO_CHECK(sum == 3);
+    DYNO_CHECK(chunks == 2);
+  }
+  {
+    Range empty = std::list<int>{};
+    bool called = false;
+    empty.for_each_chunk([&](auto) { called = true; });
+    DYNO_CHECK(!called);
+  }
 }
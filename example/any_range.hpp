@@ -0,0 +1,205 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef ANY_RANGE_HPP
+#define ANY_RANGE_HPP
+
+#include "any_iterator.hpp"
+
+#include <dyno.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <utility>
+using namespace dyno::literals;
+
+
+//
+// Example of creating an erased range type for holding anything that has
+// begin() and end() functions.
+//
+// When the erased range is contiguous (e.g. a `std::vector`), its elements
+// are also accessible directly through the "contiguous_data" function, which
+// returns an empty optional otherwise. Algorithms over `any_range` use it to
+// work on raw pointers, which is what the standard algorithms are the most
+// optimized for (e.g. `std::copy` becomes a `memmove`).
+//
+
+template <typename Value, typename Category>
+struct Range : decltype(dyno::requires_(
+  "begin"_s = dyno::function<any_iterator<Value, Category> (dyno::T&)>,
+  "end"_s = dyno::function<any_iterator<Value, Category> (dyno::T&)>,
+  "cbegin"_s = dyno::function<any_iterator<Value const, Category> (dyno::T const&)>,
+  "cend"_s = dyno::function<any_iterator<Value const, Category> (dyno::T const&)>,
+  "contiguous_data"_s = dyno::function<std::optional<chunk<Value>> (dyno::T const&)>
+)) { };
+
+template <typename Value, typename Category, typename R>
+auto const dyno::default_concept_map<Range<Value, Category>, R> = dyno::make_concept_map(
+  "begin"_s = [](R& range) -> any_iterator<Value, Category> {
+    return any_iterator<Value, Category>{range.begin()};
+  },
+  "end"_s = [](R& range) -> any_iterator<Value, Category> {
+    return any_iterator<Value, Category>{range.end()};
+  },
+  "cbegin"_s = [](R const& range) -> any_iterator<Value const, Category> {
+    return any_iterator<Value const, Category>{range.cbegin()};
+  },
+  "cend"_s = [](R const& range) -> any_iterator<Value const, Category> {
+    return any_iterator<Value const, Category>{range.cend()};
+  },
+  "contiguous_data"_s = [](R const& range) -> std::optional<chunk<Value>> {
+    using Iterator = decltype(range.cbegin());
+    if constexpr (::detail::is_contiguous_over<Iterator, Value>()) {
+      auto size = static_cast<std::size_t>(std::distance(range.cbegin(), range.cend()));
+      Value const* data = size == 0 ? nullptr : std::addressof(*range.cbegin());
+      return chunk<Value>{data, size};
+    } else {
+      return std::nullopt;
+    }
+  }
+);
+
+template <typename Value, typename Category>
+struct any_range {
+  template <typename Range>
+  any_range(Range&& r) : poly_{std::forward<Range>(r)} { }
+
+  auto begin()        { return poly_.virtual_("begin"_s)(poly_); }
+  auto end()          { return poly_.virtual_("end"_s)(poly_); }
+  auto begin() const  { return cbegin(); }
+  auto end() const    { return cend(); }
+
+  auto cbegin() const { return poly_.virtual_("cbegin"_s)(poly_); }
+  auto cend() const   { return poly_.virtual_("cend"_s)(poly_); }
+
+  // Returns all the elements of the range when they are contiguous in memory,
+  // and an empty optional otherwise.
+  std::optional<chunk<Value>> contiguous_data() const {
+    return poly_.virtual_("contiguous_data"_s)(poly_);
+  }
+
+  // Calls `f` with successive chunks of the elements of the range (see
+  // `any_iterator::next_chunk`). This only pays for a few dynamic dispatches
+  // per chunk, instead of a few per element. When the underlying range is
+  // contiguous, `f` is called only once, with all the elements.
+  //
+  // `f` may return a `bool` telling whether to continue with the next chunk,
+  // in which case this returns whether all the chunks were visited.
+  template <typename F>
+  bool for_each_chunk(F f) const {
+    auto visit = [&f](chunk<Value> c) -> bool {
+      if constexpr (std::is_void<decltype(f(c))>::value) {
+        f(c);
+        return true;
+      } else {
+        return static_cast<bool>(f(c));
+      }
+    };
+
+    if (auto data = contiguous_data())
+      return data->size == 0 || visit(*data);
+
+    // Copies of the elements are constructed in `storage`, and destroyed
+    // once their chunk has been visited.
+    struct destroy_copies {
+      chunk<Value> c;
+      Value* buffer;
+      ~destroy_copies() {
+        if (c.data == buffer)
+          std::destroy_n(buffer, c.size);
+      }
+    };
+
+    alignas(Value) unsigned char storage[chunk_capacity * sizeof(Value)];
+    Value* buffer = reinterpret_cast<Value*>(storage);
+    auto first = cbegin();
+    auto const last = cend();
+    while (true) {
+      destroy_copies c{first.next_chunk(last, buffer, chunk_capacity), buffer};
+      if (c.c.size == 0)
+        return true;
+      if (!visit(c.c))
+        return false;
+    }
+  }
+
+private:
+  // Chunks take at most 1 KiB on the stack, but hold at least one element.
+  static constexpr std::size_t chunk_bytes = 1024;
+  static constexpr std::size_t chunk_capacity =
+    sizeof(Value) < chunk_bytes ? chunk_bytes / sizeof(Value) : 1;
+  dyno::poly<Range<Value, Category>> poly_;
+};
+
+//
+// Algorithms over `any_range`s. They work by chunks of elements, so that only
+// a few dynamic dispatches are required per chunk, and a contiguous range is
+// handled as a single chunk. Hence, these loop over raw pointers most of the
+// time, which the standard algorithms handle best.
+//
+
+template <typename Value, typename Category, typename OutputIterator>
+OutputIterator copy(any_range<Value, Category> const& range, OutputIterator out) {
+  range.for_each_chunk([&](chunk<Value> c) {
+    out = std::copy(c.begin(), c.end(), out);
+  });
+  return out;
+}
+
+template <typename Value, typename Category, typename T>
+T accumulate(any_range<Value, Category> const& range, T init) {
+  range.for_each_chunk([&](chunk<Value> c) {
+    init = std::accumulate(c.begin(), c.end(), std::move(init));
+  });
+  return init;
+}
+
+// Returns the position of the first element equal to `value` in the range,
+// or the number of elements in the range if there is no such element.
+template <typename Value, typename Category>
+std::size_t find(any_range<Value, Category> const& range, Value const& value) {
+  if (auto data = range.contiguous_data())
+    return static_cast<std::size_t>(std::find(data->begin(), data->end(), value) - data->begin());
+
+  std::size_t position = 0;
+  range.for_each_chunk([&](chunk<Value> c) {
+    auto it = std::find(c.begin(), c.end(), value);
+    position += static_cast<std::size_t>(it - c.begin());
+    return it == c.end();
+  });
+  return position;
+}
+
+template <typename Value, typename Category1, typename Category2>
+bool equal(any_range<Value, Category1> const& a, any_range<Value, Category2> const& b) {
+  auto a_data = a.contiguous_data();
+  auto b_data = b.contiguous_data();
+  if (a_data && b_data)
+    return std::equal(a_data->begin(), a_data->end(), b_data->begin(), b_data->end());
+
+  // Compare the chunks of the non-contiguous range with the contiguous one.
+  auto equal_to_contiguous = [](chunk<Value> data, auto const& range) {
+    std::size_t offset = 0;
+    bool const equal = range.for_each_chunk([&](chunk<Value> c) {
+      if (c.size > data.size - offset || !std::equal(c.begin(), c.end(), data.begin() + offset))
+        return false;
+      offset += c.size;
+      return true;
+    });
+    return equal && offset == data.size;
+  };
+  if (a_data)
+    return equal_to_contiguous(*a_data, b);
+  if (b_data)
+    return equal_to_contiguous(*b_data, a);
+  return std::equal(a.begin(), a.end(), b.begin(), b.end());
+}
+
+#endif // ANY_RANGE_HPP
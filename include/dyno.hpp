@@ -5,12 +5,23 @@
 #ifndef DYNO_HPP
 #define DYNO_HPP
 
+#include <dyno/abi_vtable.hpp>
+#include <dyno/atomic_poly.hpp>
 #include <dyno/builtin.hpp>
 #include <dyno/concept.hpp>
 #include <dyno/concept_map.hpp>
+#include <dyno/flat_poly_vector.hpp>
+#include <dyno/function.hpp>
+#include <dyno/instrumented.hpp>
 #include <dyno/macro.hpp>
+#include <dyno/multimethod.hpp>
+#include <dyno/multiversion.hpp>
 #include <dyno/poly.hpp>
+#include <dyno/static_poly.hpp>
 #include <dyno/storage.hpp>
+#include <dyno/task.hpp>
+#include <dyno/task_queue.hpp>
+#include <dyno/thread_pool.hpp>
 #include <dyno/vtable.hpp>
 
 #endif // DYNO_HPP
@@ -0,0 +1,297 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_ABI_VTABLE_HPP
+#define DYNO_ABI_VTABLE_HPP
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/detail/dynamic_dispatch.hpp>
+#include <dyno/detail/erase_function.hpp>
+#include <dyno/detail/erase_signature.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/vtable.hpp>
+
+#include <boost/hana/append.hpp>
+#include <boost/hana/bool.hpp>
+#include <boost/hana/contains.hpp>
+#include <boost/hana/first.hpp>
+#include <boost/hana/fold_left.hpp>
+#include <boost/hana/pair.hpp>
+#include <boost/hana/transform.hpp>
+#include <boost/hana/tuple.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+
+namespace dyno {
+
+// Header of a vtable with a stable layout (see `dyno::abi_vtable`).
+//
+// This is a C-compatible struct, so pointers to it can be returned from
+// `extern "C"` functions exported by plugins. It is immediately followed
+// by `size` function pointers, one for each function of the concept.
+struct abi_vtable_header {
+  // Version of the layout described here. This changes whenever the layout
+  // changes in an incompatible way.
+  static constexpr std::uint32_t current_version = 1;
+
+  std::uint32_t version;
+  std::uint32_t size;
+
+  // Hash of the names and signatures of the functions, in order.
+  std::uint64_t layout;
+};
+
+namespace detail {
+  // Returns the name of `Signature` as spelled by the compiler. This is used
+  // to detect vtables created with different signatures; it is not portable
+  // across compilers, but neither are the signatures themselves.
+  template <typename Signature>
+  constexpr std::string_view signature_name() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return __FUNCSIG__;
+#else
+    return __PRETTY_FUNCTION__;
+#endif
+  }
+
+  constexpr void abi_hash_combine(std::uint64_t& hash, std::string_view s) {
+    for (char c : s) {
+      hash ^= static_cast<unsigned char>(c);
+      hash *= 1099511628211ull; // FNV-1a
+    }
+    hash ^= 0xff;
+    hash *= 1099511628211ull;
+  }
+
+  // Returns the clauses of `Concept` in the order in which they are declared,
+  // with the clauses of refined concepts coming first where the refined
+  // concepts are listed. Clauses appearing several times (e.g. when two
+  // refined concepts refine the same concept) only appear the first time.
+  template <typename Concept>
+  constexpr auto abi_clauses(Concept) {
+    return boost::hana::fold_left(dyno::clauses(Concept{}), boost::hana::make_tuple(),
+    [](auto unique, auto clause) {
+      auto names = boost::hana::transform(unique, boost::hana::first);
+      if constexpr (decltype(boost::hana::contains(names, boost::hana::first(clause)))::value)
+        return unique;
+      else
+        return boost::hana::append(unique, clause);
+    });
+  }
+
+  // The vtable itself: the header followed by the functions, in the order
+  // given by `abi_clauses`. This is a standard-layout type, so a pointer to
+  // it and a pointer to its header can be converted to each other.
+  template <std::size_t N>
+  struct abi_vtable_data {
+    abi_vtable_header header;
+    void (*functions[N])();
+  };
+
+  template <typename Clauses>
+  struct abi_layout;
+
+  template <typename ...Name, typename ...Clause>
+  struct abi_layout<boost::hana::tuple<boost::hana::pair<Name, Clause>...>> {
+    static constexpr std::size_t size = sizeof...(Name);
+    using data = abi_vtable_data<size>;
+
+    template <typename Name_>
+    static constexpr std::size_t index_of() {
+      constexpr bool matches[] = {std::is_same<Name_, Name>::value..., false};
+      std::size_t i = 0;
+      while (!matches[i])
+        ++i;
+      return i;
+    }
+
+    template <typename Name_>
+    static constexpr bool contains = (std::is_same<Name_, Name>::value || ...);
+
+    static constexpr std::uint64_t compute_hash() {
+      std::uint64_t hash = 14695981039346656037ull;
+      (detail::abi_hash_combine(hash, detail::name_chars<Name>::value), ...);
+      (detail::abi_hash_combine(hash, detail::signature_name<
+        typename detail::erase_signature<typename Clause::type>::type
+      >()), ...);
+      return hash;
+    }
+
+    static constexpr std::uint64_t hash = compute_hash();
+
+    template <typename ConceptMap>
+    static data make(ConceptMap map) {
+      // suppress "unused" warnings for empty parameter packs
+      (void)map;
+      return data{
+        abi_vtable_header{abi_vtable_header::current_version, size, hash},
+        {reinterpret_cast<void (*)()>(
+          detail::erase_function<typename Clause::type>(map[Name{}])
+        )...}
+      };
+    }
+  };
+
+  template <typename Concept>
+  using abi_layout_for = abi_layout<decltype(detail::abi_clauses(Concept{}))>;
+
+  template <typename Layout, typename ConceptMap>
+  inline typename Layout::data const abi_static_vtable = Layout::make(ConceptMap{});
+} // end namespace detail
+
+// Class implementing a vtable with a stable layout, which can be passed
+// across shared libraries.
+//
+// The vtable is a pointer to a `dyno::abi_vtable_header` followed by one
+// function pointer for each function of the concept, in the order in which
+// the functions are declared (the functions of refined concepts come first).
+// The header records the number of functions and a hash of their names and
+// signatures, which is checked when a vtable is received from elsewhere, so
+// a plugin built against a different version of the concept is rejected
+// instead of crashing. Calls go directly through the functions of the
+// received vtable, like with `dyno::remote_vtable`.
+//
+// Only the layout of the vtable is stable; the host and plugins must still
+// be built with compatible compilers and agree on the types appearing in the
+// signatures of the concept.
+template <typename Concept>
+struct abi_vtable {
+private:
+  using Layout = detail::abi_layout_for<Concept>;
+  using Data = typename Layout::data;
+
+public:
+  template <typename ConceptMap>
+  explicit abi_vtable(ConceptMap)
+    : vptr_{&detail::abi_static_vtable<Layout, ConceptMap>}
+  { }
+
+  // Uses a vtable exported by another shared library, usually obtained with
+  // `dyno::export_vtable`. Throws `std::runtime_error` if the vtable was not
+  // created for the same concept, or with a different layout.
+  abi_vtable(abi_vtable_header const* header)
+    : vptr_{abi_vtable::check(header)}
+  { }
+
+  template <typename OtherVTable>
+  constexpr abi_vtable(dyno::from_vtable_t, OtherVTable const& other)
+    : vptr_{abi_vtable::convert_vptr(other)}
+  { }
+
+  template <typename Name>
+  constexpr auto contains(Name) const {
+    return boost::hana::bool_c<Layout::template contains<Name>>;
+  }
+
+  template <typename Name>
+  auto operator[](Name name) const {
+    constexpr bool contains_function = Layout::template contains<Name>;
+    if constexpr (contains_function) {
+      using Signature = typename decltype(Concept{}.get_signature(name))::type;
+      using Function = typename detail::erase_signature<Signature>::type*;
+      return reinterpret_cast<Function>(vptr_->functions[Layout::template index_of<Name>()]);
+    } else {
+      static_assert(contains_function,
+        "dyno::abi_vtable::operator[]: Request for a virtual function that is "
+        "not in the vtable. Was this function specified in the concept that "
+        "was used to instantiate this vtable?");
+    }
+  }
+
+  // Like for `dyno::remote_vtable`, this returns `false` when the vtable was
+  // created in another translation unit from a concept map that is not
+  // `inline`, and always returns `false` for vtables exported by another
+  // shared library.
+  template <typename ConceptMap>
+  bool created_from(ConceptMap) const {
+    return vptr_ == &detail::abi_static_vtable<Layout, ConceptMap>;
+  }
+
+  // Returns the header of the vtable, which can be passed to another shared
+  // library.
+  abi_vtable_header const* header() const {
+    return &vptr_->header;
+  }
+
+  friend void swap(abi_vtable& a, abi_vtable& b) {
+    using std::swap;
+    swap(a.vptr_, b.vptr_);
+  }
+
+private:
+  Data const* vptr_;
+
+  static Data const* check(abi_vtable_header const* header) {
+    if (header == nullptr)
+      throw std::runtime_error{"dyno::abi_vtable: received a null vtable"};
+    if (header->version != abi_vtable_header::current_version)
+      throw std::runtime_error{"dyno::abi_vtable: received a vtable with an unsupported "
+                               "layout version"};
+    if (header->size != Layout::size || header->layout != Layout::hash)
+      throw std::runtime_error{"dyno::abi_vtable: received a vtable whose functions don't "
+                               "match the concept; was it created for another version "
+                               "of the concept?"};
+    return reinterpret_cast<Data const*>(header);
+  }
+
+  template <typename OtherVTable>
+  static constexpr Data const* convert_vptr(OtherVTable const& other) {
+    constexpr bool is_same_vtable = std::is_same<OtherVTable, abi_vtable>::value;
+    static_assert(is_same_vtable,
+      "dyno::abi_vtable: Trying to construct a vtable from a vtable of a "
+      "different type. Since ABI-stable vtables are created for a single "
+      "concept, this is not supported.");
+    if constexpr (is_same_vtable)
+      return other.vptr_;
+    else
+      return nullptr;
+  }
+};
+
+// Vtable policy storing all the functions in a `dyno::abi_vtable`.
+//
+// This is meant for concepts whose models are provided by plugins loaded at
+// runtime. The plugin exports the vtable of each model with
+// `dyno::export_vtable`, along with a function creating the model, and the
+// host creates a `dyno::poly` using that vtable:
+// ```
+// // In the plugin
+// extern "C" dyno::abi_vtable_header const* circle_vtable() {
+//   return dyno::export_vtable<Shape, Circle>();
+// }
+// extern "C" void make_circle(void* where, double radius) {
+//   new (where) Circle{radius};
+// }
+//
+// // In the host
+// using AnyShape = dyno::poly<Shape, dyno::remote_storage, dyno::abi_vtable_policy>;
+// AnyShape shape{dyno::construct_with_vtable_t{}, circle_vtable(),
+//                [](void* where) { make_circle(where, 2.0); }};
+// ```
+struct abi_vtable_policy {
+  template <typename Concept>
+  using apply = dyno::abi_vtable<Concept>;
+};
+
+// Returns the vtable used by a `dyno::poly<Concept, Storage, dyno::abi_vtable_policy>`
+// holding an object of type `T`, with the functions of the concept map of `T`.
+template <typename Concept, typename T>
+abi_vtable_header const* export_vtable() {
+  using ActualConcept = detail::poly_concept<Concept>;
+  using ConceptMap = decltype(dyno::complete_concept_map<ActualConcept, T>(
+    dyno::concept_map<ActualConcept, T>
+  ));
+  return &detail::abi_static_vtable<detail::abi_layout_for<ActualConcept>, ConceptMap>.header;
+}
+
+} // end namespace dyno
+
+#endif // DYNO_ABI_VTABLE_HPP
@@ -0,0 +1,188 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_ATOMIC_POLY_HPP
+#define DYNO_ATOMIC_POLY_HPP
+
+#include <dyno/poly.hpp>
+#include <dyno/storage.hpp>
+#include <dyno/vtable.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+
+namespace dyno {
+
+namespace detail {
+  inline std::atomic<std::size_t> next_reader_index{0};
+
+  // Returns a small number identifying the calling thread, used to spread
+  // the readers of a `dyno::atomic_poly` over several counters.
+  inline std::size_t reader_index() {
+    thread_local std::size_t const index =
+      next_reader_index.fetch_add(1, std::memory_order_relaxed);
+    return index;
+  }
+} // end namespace detail
+
+// Cell holding a polymorphic object satisfying `Concept`, which can be read
+// by any number of threads while other threads replace the object.
+//
+// This is meant for read-mostly objects that are swapped at runtime, like
+// configurable strategies. Reading is wait-free: it takes one atomic increment
+// on a counter that is usually private to the reading thread, and one atomic
+// load. Replacing the object is comparatively expensive, since the writer must
+// wait for the readers still using the old object before destroying it.
+//
+// This is a form of read-copy-update, where readers are tracked with pairs of
+// counters like in sleepable RCU. Readers increment the counter of the current
+// epoch, whose parity selects one of the two counters. After publishing a new
+// object, a writer flips the epoch twice, each time waiting for the readers
+// counted in the previous epoch to leave. Once that's done, no reader can
+// still be using the old object. For example:
+// ```
+// dyno::atomic_poly<PricingRule> rule{FlatRate{0.05}};
+//
+// // from any number of threads
+// auto r = rule.load();
+// double price = r->virtual_("price"_s)(order);
+//
+// // from any other thread
+// rule.store(TieredRate{...});
+// ```
+//
+// Since the object is shared by all the readers, they only get a reference
+// to const (a `dyno::poly_cref`). The object is held in a
+// `dyno::poly<Concept, dyno::remote_storage, VTablePolicy>`.
+template <
+  typename Concept,
+  typename VTablePolicy = dyno::vtable<dyno::remote<dyno::everything>>
+>
+class atomic_poly {
+public:
+  using value_type = dyno::poly<Concept, dyno::remote_storage, VTablePolicy>;
+  using reference = dyno::poly_cref<Concept, VTablePolicy>;
+
+private:
+  struct node {
+    template <typename T>
+    explicit node(T&& t) : value{std::forward<T>(t)}, ref{value} { }
+
+    value_type value;
+    reference ref;
+  };
+
+  static constexpr std::size_t cache_line = 64;
+  static constexpr std::size_t reader_slots = 16;
+
+  struct alignas(cache_line) slot {
+    std::atomic<std::size_t> readers[2] = {{0}, {0}};
+  };
+
+public:
+  // Keeps the object returned by `atomic_poly::load()` alive, and gives access
+  // to it. The object is not destroyed until the guard is destroyed, even if
+  // it is replaced in the meantime. Guards should be short-lived, since they
+  // hold back the writers.
+  class read_guard {
+  public:
+    read_guard(read_guard&& other)
+      : readers_{std::exchange(other.readers_, nullptr)}, node_{other.node_}
+    { }
+
+    read_guard(read_guard const&) = delete;
+    read_guard& operator=(read_guard const&) = delete;
+    read_guard& operator=(read_guard&&) = delete;
+
+    ~read_guard() {
+      if (readers_)
+        readers_->fetch_sub(1, std::memory_order_release);
+    }
+
+    reference const& get() const { return node_->ref; }
+    reference const& operator*() const { return node_->ref; }
+    reference const* operator->() const { return &node_->ref; }
+
+  private:
+    friend class atomic_poly;
+    read_guard(std::atomic<std::size_t>* readers, node const* n)
+      : readers_{readers}, node_{n}
+    { }
+
+    std::atomic<std::size_t>* readers_;
+    node const* node_;
+  };
+
+  template <typename T,
+    typename = std::enable_if_t<!std::is_same<std::decay_t<T>, atomic_poly>::value>,
+    typename = std::enable_if_t<std::is_constructible<value_type, T&&>::value>
+  >
+  explicit atomic_poly(T&& t)
+    : current_{new node{std::forward<T>(t)}}
+  { }
+
+  atomic_poly(atomic_poly const&) = delete;
+  atomic_poly& operator=(atomic_poly const&) = delete;
+
+  // The behavior is undefined if some `read_guard`s are still alive.
+  ~atomic_poly() {
+    delete current_.load(std::memory_order_relaxed);
+  }
+
+  // Returns a guard giving access to the current object. This is wait-free.
+  read_guard load() const {
+    slot& s = slots_[detail::reader_index() % reader_slots];
+    std::size_t epoch = epoch_.load(std::memory_order_seq_cst);
+    std::atomic<std::size_t>* readers = &s.readers[epoch & 1];
+    readers->fetch_add(1, std::memory_order_seq_cst);
+    return read_guard{readers, current_.load(std::memory_order_seq_cst)};
+  }
+
+  // Replaces the object with a new one constructed from `t`, and destroys
+  // the old object once no reader is using it anymore. Concurrent calls to
+  // `store` are serialized. This blocks until the readers that may still be
+  // using the old object are done with it; hence, calling `store` while the
+  // same thread holds a `read_guard` on this cell deadlocks.
+  template <typename T, typename = std::enable_if_t<
+    std::is_constructible<value_type, T&&>::value
+  >>
+  void store(T&& t) {
+    node* fresh = new node{std::forward<T>(t)};
+    std::lock_guard<std::mutex> lock{writer_mutex_};
+    node* old = current_.exchange(fresh, std::memory_order_seq_cst);
+
+    // A reader may read the epoch right before a flip, and increment its
+    // counter only after we checked that counter. That reader sees the new
+    // object, but it is counted in the epoch that was just retired, where the
+    // next writer would not look for it. The second flip makes that epoch
+    // current again, so the next writer waits for such readers.
+    for (int flip = 0; flip != 2; ++flip) {
+      std::size_t previous = epoch_.fetch_add(1, std::memory_order_seq_cst);
+      this->wait_for_readers(previous & 1);
+    }
+    delete old;
+  }
+
+private:
+  void wait_for_readers(std::size_t parity) const {
+    for (slot const& s : slots_) {
+      while (s.readers[parity].load(std::memory_order_acquire) != 0)
+        std::this_thread::yield();
+    }
+  }
+
+  mutable slot slots_[reader_slots];
+  alignas(cache_line) std::atomic<node*> current_;
+  std::atomic<std::size_t> epoch_{0};
+  std::mutex writer_mutex_;
+};
+
+} // end namespace dyno
+
+#endif // DYNO_ATOMIC_POLY_HPP
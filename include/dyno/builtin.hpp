@@ -7,8 +7,12 @@
 
 #include <dyno/concept.hpp>
 #include <dyno/concept_map.hpp>
+#include <dyno/detail/erase_function.hpp>
+#include <dyno/detail/erase_signature.hpp>
 
 #include <cstddef>
+#include <cstring>
+#include <functional>
 #include <type_traits>
 #include <typeinfo>
 
@@ -27,13 +31,90 @@ struct storage_info {
 template <typename T>
 constexpr auto storage_info_for = storage_info{sizeof(T), alignof(T)};
 
+namespace detail {
+  // Function object calling `F`, but which is stored in vtables as the
+  // function `Thunk::apply` instead of a thunk generated for `F`.
+  //
+  // This is used by the builtin concepts for functions that behave the same
+  // for many models (e.g. copying any trivially copyable type of a given
+  // size), so that all these models share a single function in their vtables
+  // instead of each getting its own copy of the same code. When the erased
+  // signature doesn't match `Thunk::apply` (e.g. with a custom eraser), a
+  // thunk is generated for `F` as usual.
+  template <typename F, typename Thunk>
+  struct shared_thunk { };
+
+  template <typename Thunk, bool Enabled, typename F>
+  constexpr auto share_thunk_if(F f) {
+    if constexpr (Enabled)
+      return detail::shared_thunk<F, Thunk>{};
+    else
+      return f;
+  }
+
+  template <typename F, typename Thunk, typename Signature>
+  struct shared_thunk_lambda : detail::default_constructible_lambda<F, Signature> {
+    template <typename ErasedSignature, typename Eraser>
+    static constexpr auto erase() {
+      using Erased = typename detail::erase_signature<ErasedSignature, Eraser>::type*;
+      if constexpr (std::is_same<decltype(&Thunk::apply), Erased>::value)
+        return &Thunk::apply;
+      else
+        return detail::erase_function<ErasedSignature, Eraser>(
+          detail::default_constructible_lambda<F, Signature>{}
+        );
+    }
+  };
+
+  template <typename F, typename Thunk, typename R, typename ...Args>
+  struct default_constructible_lambda<shared_thunk<F, Thunk>, R(Args...)>
+    : shared_thunk_lambda<F, Thunk, R(Args...)>
+  { };
+
+  template <typename F, typename Thunk, typename ...Args>
+  struct default_constructible_lambda<shared_thunk<F, Thunk>, void(Args...)>
+    : shared_thunk_lambda<F, Thunk, void(Args...)>
+  { };
+
+  // Function shared by all the models with the same size and alignment.
+  template <std::size_t Size, std::size_t Alignment>
+  struct storage_info_thunk {
+    DYNO_THUNK_ATTRIBUTES static dyno::storage_info apply() {
+      return dyno::storage_info{Size, Alignment};
+    }
+  };
+
+  // Functions shared by all the trivially copy (or move) constructible models
+  // with the same size.
+  template <std::size_t Size>
+  struct trivial_copy_construct_thunk {
+    DYNO_THUNK_ATTRIBUTES static void apply(void* p, void const* other) {
+      std::memcpy(p, other, Size);
+    }
+  };
+
+  template <std::size_t Size>
+  struct trivial_move_construct_thunk {
+    DYNO_THUNK_ATTRIBUTES static void apply(void* p, void* other) {
+      std::memcpy(p, other, Size);
+    }
+  };
+
+  // Function shared by all the trivially destructible models.
+  struct trivial_destruct_thunk {
+    DYNO_THUNK_ATTRIBUTES static void apply(void*) { }
+  };
+} // end namespace detail
+
 struct Storable : decltype(dyno::requires_(
   "storage_info"_s = dyno::function<dyno::storage_info()>
 )) { };
 
 template <typename T>
-auto const default_concept_map<Storable, T> = dyno::make_concept_map(
-  "storage_info"_s = []() { return dyno::storage_info_for<T>; }
+inline auto const default_concept_map<Storable, T> = dyno::make_concept_map(
+  "storage_info"_s = detail::share_thunk_if<
+    detail::storage_info_thunk<sizeof(T), alignof(T)>, true
+  >([]() { return dyno::storage_info_for<T>; })
 );
 
 
@@ -42,7 +123,7 @@ struct TypeId : decltype(dyno::requires_(
 )) { };
 
 template <typename T>
-auto const default_concept_map<TypeId, T> = dyno::make_concept_map(
+inline auto const default_concept_map<TypeId, T> = dyno::make_concept_map(
   "typeid"_s = []() -> std::type_info const& { return typeid(T); }
 );
 
@@ -52,7 +133,7 @@ struct DefaultConstructible : decltype(dyno::requires_(
 )) { };
 
 template <typename T>
-auto const default_concept_map<DefaultConstructible, T,
+inline auto const default_concept_map<DefaultConstructible, T,
   std::enable_if_t<std::is_default_constructible<T>::value>
 > = dyno::make_concept_map(
   "default-construct"_s = [](void* p) {
@@ -66,12 +147,15 @@ struct MoveConstructible : decltype(dyno::requires_(
 )) { };
 
 template <typename T>
-auto const default_concept_map<MoveConstructible, T,
+inline auto const default_concept_map<MoveConstructible, T,
   std::enable_if_t<std::is_move_constructible<T>::value>
 > = dyno::make_concept_map(
-  "move-construct"_s = [](void* p, T&& other) {
+  "move-construct"_s = detail::share_thunk_if<
+    detail::trivial_move_construct_thunk<sizeof(T)>,
+    std::is_trivially_move_constructible<T>::value
+  >([](void* p, T&& other) {
     new (p) T(std::move(other));
-  }
+  })
 );
 
 
@@ -81,12 +165,15 @@ struct CopyConstructible : decltype(dyno::requires_(
 )) { };
 
 template <typename T>
-auto const default_concept_map<CopyConstructible, T,
+inline auto const default_concept_map<CopyConstructible, T,
   std::enable_if_t<std::is_copy_constructible<T>::value>
 > = dyno::make_concept_map(
-  "copy-construct"_s = [](void* p, T const& other) {
+  "copy-construct"_s = detail::share_thunk_if<
+    detail::trivial_copy_construct_thunk<sizeof(T)>,
+    std::is_trivially_copy_constructible<T>::value
+  >([](void* p, T const& other) {
     new (p) T(other);
-  }
+  })
 );
 
 
@@ -111,22 +198,37 @@ struct EqualityComparable : decltype(dyno::requires_(
 )) { };
 
 template <typename T>
-auto const default_concept_map<EqualityComparable, T,
+inline auto const default_concept_map<EqualityComparable, T,
   decltype((void)(std::declval<T>() == std::declval<T>()))
 > = dyno::make_concept_map(
   "equal"_s = [](T const& a, T const& b) -> bool { return a == b; }
 );
 
 
+struct Hashable : decltype(dyno::requires_(
+  "hash"_s = dyno::function<std::size_t (dyno::T const&)>
+)) { };
+
+template <typename T>
+inline auto const default_concept_map<Hashable, T,
+  decltype((void)std::hash<T>{}(std::declval<T const&>()))
+> = dyno::make_concept_map(
+  "hash"_s = [](T const& self) -> std::size_t { return std::hash<T>{}(self); }
+);
+
+
 struct Destructible : decltype(dyno::requires_(
   "destruct"_s = dyno::function<void (dyno::T&)>
 )) { };
 
 template <typename T>
-auto const default_concept_map<Destructible, T,
+inline auto const default_concept_map<Destructible, T,
   std::enable_if_t<std::is_destructible<T>::value>
 > = dyno::make_concept_map(
-  "destruct"_s = [](T& self) { self.~T(); }
+  "destruct"_s = detail::share_thunk_if<
+    detail::trivial_destruct_thunk,
+    std::is_trivially_destructible<T>::value
+  >([](T& self) { self.~T(); })
 );
 
 } // end namespace dyno
@@ -7,20 +7,21 @@
 
 #include <dyno/detail/dsl.hpp>
 #include <dyno/detail/has_duplicates.hpp>
+#include <dyno/detail/index_of.hpp>
 
 #include <boost/hana/any_of.hpp>
-#include <boost/hana/at_key.hpp>
+#include <boost/hana/at.hpp>
 #include <boost/hana/basic_tuple.hpp>
 #include <boost/hana/bool.hpp>
 #include <boost/hana/contains.hpp>
-#include <boost/hana/core/to.hpp>
 #include <boost/hana/filter.hpp>
 #include <boost/hana/first.hpp>
 #include <boost/hana/flatten.hpp>
-#include <boost/hana/map.hpp>
 #include <boost/hana/pair.hpp>
+#include <boost/hana/second.hpp>
 #include <boost/hana/transform.hpp>
 
+#include <cstddef>
 #include <type_traits>
 #include <utility>
 
@@ -36,6 +37,13 @@ namespace detail {
     expand_clauses(boost::hana::pair<Str, Fun> const&)
   { return {}; }
 
+  // Hot clauses are equivalent to the clause they wrap, except for vtable
+  // policies looking at them explicitly through `dyno::hot_clause_names`.
+  template <typename Str, typename Fun>
+  constexpr boost::hana::basic_tuple<boost::hana::pair<Str, Fun>>
+    expand_clauses(boost::hana::pair<Str, dyno::hot_t<Fun>> const&)
+  { return {}; }
+
   template <typename ...Clauses>
   constexpr auto expand_clauses(dyno::concept_<Clauses...> const&) {
     return boost::hana::flatten(
@@ -43,6 +51,23 @@ namespace detail {
     );
   }
 
+  template <typename Str, typename Fun>
+  constexpr boost::hana::basic_tuple<>
+    expand_hot_clause_names(boost::hana::pair<Str, Fun> const&)
+  { return {}; }
+
+  template <typename Str, typename Fun>
+  constexpr boost::hana::basic_tuple<Str>
+    expand_hot_clause_names(boost::hana::pair<Str, dyno::hot_t<Fun>> const&)
+  { return {}; }
+
+  template <typename ...Clauses>
+  constexpr auto expand_hot_clause_names(dyno::concept_<Clauses...> const&) {
+    return boost::hana::flatten(
+      boost::hana::make_basic_tuple(detail::expand_hot_clause_names(Clauses{})...)
+    );
+  }
+
   struct concept_base { };
 } // end namespace detail
 
@@ -67,6 +92,17 @@ constexpr auto clause_names(dyno::concept_<Clauses...> const& c) {
   return boost::hana::transform(dyno::clauses(c), boost::hana::first);
 }
 
+// Returns a sequence containing the names of the clauses of the given concept
+// and its derived concepts that were marked as hot with `dyno::hot`.
+//
+// The clauses of refined concepts come first, and the clauses of a concept
+// are in the order in which they were declared.
+template <typename ...Clauses>
+constexpr auto hot_clause_names(dyno::concept_<Clauses...> const&) {
+  auto all = boost::hana::make_basic_tuple(detail::expand_hot_clause_names(Clauses{})...);
+  return boost::hana::flatten(all);
+}
+
 // Returns a sequence of the concepts refined by the given concept.
 //
 // Only the concepts that are refined directly by `c` are returned, i.e. we
@@ -88,6 +124,22 @@ namespace detail {
     });
   }
 
+  // Returns whether the concept declares a multimethod directly (not in one
+  // of its refined concepts). This only looks at the types of the clauses, so
+  // it is cheap enough to be checked for every concept map.
+  template <typename Clause>
+  constexpr bool is_multimethod_clause = false;
+
+  template <typename Name, typename Signature>
+  constexpr bool is_multimethod_clause<
+    boost::hana::pair<Name, dyno::multimethod_t<Signature>>
+  > = true;
+
+  template <typename ...Clauses>
+  constexpr bool declares_multimethod(dyno::concept_<Clauses...> const&) {
+    return (detail::is_multimethod_clause<Clauses> || ...);
+  }
+
   template <typename ...Clauses>
   constexpr auto has_duplicate_clause(dyno::concept_<Clauses...> const& c) {
     auto direct = detail::direct_clauses(c);
@@ -105,6 +157,37 @@ namespace detail {
       return boost::hana::contains(base_clause_names, boost::hana::first(clause));
     });
   }
+
+  // Index of the clause named `Name` in a sequence of clauses returned by
+  // `dyno::clauses`, or the number of clauses if there is no such clause.
+  //
+  // This is used instead of turning the clauses into a `boost::hana::map`,
+  // which is a lot more expensive at compile-time for large concepts.
+  template <typename Name, typename Clauses>
+  struct clause_index;
+
+  template <typename Name, typename ...N, typename ...C>
+  struct clause_index<Name, boost::hana::basic_tuple<boost::hana::pair<N, C>...>>
+    : std::integral_constant<std::size_t, detail::index_of<Name, N...>()>
+  {
+    static constexpr bool found = detail::index_of<Name, N...>() != sizeof...(N);
+  };
+
+  // Returns whether all the names in the first sequence of compile-time
+  // strings are in the second one.
+  template <typename ...Name, typename ...Key>
+  constexpr auto contains_names(boost::hana::basic_tuple<Name...> const&,
+                                boost::hana::basic_tuple<Key...> const&) {
+    return boost::hana::bool_c<
+      ((detail::index_of<Name, Key...>() != sizeof...(Key)) && ...)
+    >;
+  }
+
+  // Returns whether `Concept` has a clause named `Name`.
+  template <typename Concept, typename Name>
+  constexpr bool has_clause = detail::clause_index<
+    Name, decltype(dyno::clauses(Concept{}))
+  >::found;
 } // end namespace detail
 
 // A `concept_` is a collection of clauses and refined concepts representing
@@ -130,9 +213,10 @@ struct concept_ : detail::concept_base {
     "if there are any.");
 
   template <typename Name>
-  constexpr auto get_signature(Name name) const {
-    auto clauses = boost::hana::to_map(dyno::clauses(*this));
-    return clauses[name];
+  constexpr auto get_signature(Name) const {
+    using AllClauses = decltype(dyno::clauses(*this));
+    constexpr std::size_t index = detail::clause_index<Name, AllClauses>::value;
+    return boost::hana::second(boost::hana::at_c<index>(AllClauses{}));
   }
 };
 
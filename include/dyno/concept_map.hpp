@@ -10,14 +10,12 @@
 #include <dyno/detail/dsl.hpp>
 #include <dyno/detail/empty_object.hpp>
 #include <dyno/detail/has_duplicates.hpp>
+#include <dyno/detail/index_of.hpp>
 
-#include <boost/hana/at_key.hpp>
 #include <boost/hana/bool.hpp>
-#include <boost/hana/contains.hpp>
 #include <boost/hana/core/to.hpp>
 #include <boost/hana/difference.hpp>
 #include <boost/hana/fold_left.hpp>
-#include <boost/hana/is_subset.hpp>
 #include <boost/hana/keys.hpp>
 #include <boost/hana/map.hpp>
 #include <boost/hana/pair.hpp>
@@ -55,6 +53,13 @@ namespace detail {
   };
 } // end namespace detail
 
+namespace detail {
+  // An entry of a `concept_map_t`, associating a function name to the type
+  // of its implementation.
+  template <typename Name, typename Function>
+  struct concept_map_entry { };
+} // end namespace detail
+
 // A concept map is a statically-known mapping from functions implemented by
 // a type `T` to functions defined by a concept. A concept map is what's being
 // used to fill the vtable extracted from a concept definition. An instance of
@@ -71,10 +76,14 @@ struct concept_map_t<Concept, T, boost::hana::pair<Name, Function>...> {
   constexpr concept_map_t() = default;
 
   template <typename Name_>
-  constexpr auto operator[](Name_ name) const {
-    constexpr bool is_known_function = boost::hana::contains(as_hana_map{}, name);
+  constexpr auto operator[](Name_) const {
+    constexpr bool is_known_function = (std::is_same<Name_, Name>::value || ...);
     if constexpr (is_known_function) {
-      return boost::hana::at_key(as_hana_map{}, name);
+      using F = decltype(concept_map_t::function_for<Name_>(entries{}));
+      using Signature = typename decltype(Concept{}.get_signature(Name_{}))::type;
+      return detail::default_constructible_lambda<
+        F, typename detail::bind_signature<Signature, T>::type
+      >{};
     } else {
       static_assert(is_known_function,
         "dyno::concept_map_t::operator[]: Request for the implementation of a "
@@ -88,17 +97,13 @@ struct concept_map_t<Concept, T, boost::hana::pair<Name, Function>...> {
   }
 
 private:
-  using as_hana_map = boost::hana::map<
-    boost::hana::pair<
-      Name,
-      detail::default_constructible_lambda<
-        Function,
-        typename detail::bind_signature<
-          typename decltype(Concept{}.get_signature(Name{}))::type, T
-        >::type
-      >
-    >...
-  >;
+  // The implementation of a function is found by deducing the only base of
+  // `entries` with that name, which is much cheaper to compile than building
+  // a `boost::hana::map` holding every function of the concept map.
+  struct entries : detail::concept_map_entry<Name, Function>... { };
+
+  template <typename Name_, typename F>
+  static F function_for(detail::concept_map_entry<Name_, F> const&);
 };
 
 // Creates a concept map associating function names to function implementations.
@@ -129,23 +134,42 @@ constexpr auto make_concept_map(boost::hana::pair<Name, Function> ...mappings) {
 // can be used to define a default concept map for a family of type, by using
 // `std::enable_if`.
 template <typename Concept, typename T, typename = void>
-auto const default_concept_map = dyno::make_concept_map();
+inline auto const default_concept_map = dyno::make_concept_map();
 
 // Customization point for users to define their models of concepts.
 //
 // This can be specialized by clients to provide concept maps for the concepts
 // and types they wish. The third parameter can be used to define a concept
 // map for a family of type, by using `std::enable_if`.
+//
+// Specializations defined in a header should be declared `inline`. Otherwise,
+// each translation unit gets its own copy of the concept map (and of the
+// closures inside it), and `dyno::poly::try_get` can't recognize an object
+// stored in another translation unit.
 template <typename Concept, typename T, typename = void>
-auto const concept_map = dyno::make_concept_map();
+inline auto const concept_map = dyno::make_concept_map();
 
 namespace detail {
+  // Returns the entries of the concept map of `T` for the multimethods
+  // declared directly in `Concept`. This is defined in `<dyno/multimethod.hpp>`,
+  // which must be included when using concepts that declare multimethods.
+  template <typename Concept, typename T>
+  constexpr auto multimethod_concept_map();
+
   // Takes a Hana map, and completes it by interpreting it as a concept map
   // for fulfilling the given `Concept` for the given type `T`.
   template <typename Concept, typename T, typename Map>
   constexpr auto complete_concept_map_impl(Map map) {
-    // 1. Bring in the functions provided in the default concept map.
-    auto with_defaults = boost::hana::union_(dyno::default_concept_map<Concept, T>, map);
+    // 1. Bring in the functions provided in the default concept map, and the
+    //    entries for the multimethods, which are never provided explicitly.
+    //    Concepts without multimethods don't pay for looking them up.
+    auto with_defaults = [&] {
+      auto defaults = boost::hana::union_(dyno::default_concept_map<Concept, T>, map);
+      if constexpr (detail::declares_multimethod(Concept{}))
+        return boost::hana::union_(detail::multimethod_concept_map<Concept, T>(), defaults);
+      else
+        return defaults;
+    }();
 
     // 2. For each refined concept, recursively complete the concept map for
     //    that Concept and merge that into the current concept map.
@@ -170,7 +194,7 @@ namespace detail {
   // Returns whether a Hana map, when interpreted as a concept map for fulfilling
   // the given `Concept`, is missing any functions.
   template <typename Concept, typename T, typename Map>
-  struct concept_map_is_complete : decltype(boost::hana::is_subset(
+  struct concept_map_is_complete : decltype(detail::contains_names(
     dyno::clause_names(Concept{}),
     boost::hana::keys(std::declval<Map>())
   )) { };
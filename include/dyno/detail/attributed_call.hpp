@@ -0,0 +1,69 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_DETAIL_ATTRIBUTED_CALL_HPP
+#define DYNO_DETAIL_ATTRIBUTED_CALL_HPP
+
+#include <dyno/detail/dsl.hpp>
+
+#include <type_traits>
+#include <utility>
+
+
+namespace dyno { namespace detail {
+
+// Calls the function pointer `fptr` with the given arguments, telling the
+// compiler that the call has no side effects when the clause it implements
+// is marked with `dyno::pure` or `dyno::const_`.
+//
+// Attributes on the functions stored in the vtable would be useless, since
+// the compiler doesn't know which function it is calling through a function
+// pointer. Instead, the call goes through a wrapper function carrying the
+// attribute. That wrapper must never be inlined, since the attribute would
+// be lost with it; the cost is a direct call, which is predicted perfectly.
+// In exchange, the compiler can merge calls to the wrapper that have the
+// same arguments when no memory is written in between. Calls are not hoisted
+// out of loops that write to memory, since the function pointer and the
+// object are reloaded after each store; in that case, the wrapper is pure
+// overhead (see `benchmark/pure.cpp`).
+//
+// When the function is not a plain function pointer (e.g. with some vtable
+// policies that wrap the function), or when the compiler doesn't support the
+// attributes, the function is simply called.
+#if defined(__GNUC__)
+template <typename R, typename ...Args>
+[[gnu::pure, gnu::noinline]]
+R pure_call(R (*fptr)(Args...), Args ...args)
+{ return fptr(static_cast<Args&&>(args)...); }
+
+template <typename R, typename ...Args>
+[[gnu::const, gnu::noinline]]
+R const_call(R (*fptr)(Args...), Args ...args)
+{ return fptr(static_cast<Args&&>(args)...); }
+
+template <typename ...Attributes, typename R, typename ...Args, typename ...Actual>
+constexpr R attributed_call(R (*fptr)(Args...), Actual&& ...args) {
+  constexpr bool is_const = detail::has_attribute<dyno::const_, Attributes...>;
+  constexpr bool is_pure = detail::has_attribute<dyno::pure, Attributes...>;
+  static_assert(!(is_const || is_pure) || !std::is_void<R>::value,
+    "dyno::pure: A function marked as pure or const must not return void, "
+    "since it could only be called for its side effects.");
+
+  if constexpr (is_const)
+    return detail::const_call<R, Args...>(fptr, std::forward<Actual>(args)...);
+  else if constexpr (is_pure)
+    return detail::pure_call<R, Args...>(fptr, std::forward<Actual>(args)...);
+  else
+    return fptr(std::forward<Actual>(args)...);
+}
+#endif
+
+template <typename ...Attributes, typename F, typename ...Actual>
+constexpr decltype(auto) attributed_call(F const& f, Actual&& ...args) {
+  return f(std::forward<Actual>(args)...);
+}
+
+}} // end namespace dyno::detail
+
+#endif // DYNO_DETAIL_ATTRIBUTED_CALL_HPP
@@ -12,66 +12,184 @@
 #include <boost/hana/tuple.hpp>
 #include <boost/hana/type.hpp>
 
+#include <cstddef>
 #include <type_traits>
 #include <utility>
 
 
 namespace dyno {
 
-template <typename Signature>
-struct function_t { using type = Signature; };
+// Attribute of a clause in a concept that promises that the function has no
+// observable side effects, and that its result only depends on its arguments
+// and on the state reachable from them. Calls to such a function through a
+// `dyno::poly` are made in a way that lets the optimizer merge repeated calls
+// with the same arguments, provided no memory is written in between.
+//
+// In practice, this only helps when the same function is called several
+// times in a single expression or basic block. Calls are not hoisted out of
+// loops that write to memory (e.g. a pure `size()` in the condition of a loop
+// filling an array), and every call that is not merged costs an additional
+// direct call, i.e. about half a nanosecond. In such loops, store the result
+// in a local variable before the loop instead.
+//
+// Note that this is a promise made to the compiler; if the implementation of
+// the function does have side effects, the behavior is undefined. Also note
+// that a pure function can't return `void`. For example:
+// ```
+// struct Container : decltype(dyno::requires_(
+//   "size"_s = dyno::method<std::size_t () const, dyno::pure>
+// )) { };
+// ```
+struct pure { };
 
-template <typename Sig1, typename Sig2>
-constexpr auto operator==(function_t<Sig1>, function_t<Sig2>) {
-  return boost::hana::bool_c<std::is_same<Sig1, Sig2>::value>;
+// Attribute of a clause in a concept that promises that the result of the
+// function only depends on the value of its arguments, without even looking
+// at memory reachable from them. This is stronger than `dyno::pure`, and
+// it is mostly useful for functions that return a property of the model's
+// type (e.g. its size), as opposed to a property of the object itself.
+struct const_ { };
+
+namespace detail {
+  template <typename Attribute>
+  struct is_clause_attribute : std::false_type { };
+  template <>
+  struct is_clause_attribute<dyno::pure> : std::true_type { };
+  template <>
+  struct is_clause_attribute<dyno::const_> : std::true_type { };
+
+  template <typename Attribute, typename ...Attributes>
+  constexpr bool has_attribute = (std::is_same<Attribute, Attributes>::value || ...);
+} // end namespace detail
+
+template <typename Signature, typename ...Attributes>
+struct function_t {
+  static_assert((detail::is_clause_attribute<Attributes>::value && ...),
+    "dyno::function: The only attributes that can be given to a function "
+    "are `dyno::pure` and `dyno::const_`.");
+
+  using type = Signature;
+};
+
+template <typename Sig1, typename ...Attrs1, typename Sig2, typename ...Attrs2>
+constexpr auto operator==(function_t<Sig1, Attrs1...>, function_t<Sig2, Attrs2...>) {
+  return boost::hana::bool_c<
+    std::is_same<function_t<Sig1, Attrs1...>, function_t<Sig2, Attrs2...>>::value
+  >;
 }
 
-template <typename Sig1, typename Sig2>
-constexpr auto operator!=(function_t<Sig1> m1, function_t<Sig2> m2) {
+template <typename Sig1, typename ...Attrs1, typename Sig2, typename ...Attrs2>
+constexpr auto operator!=(function_t<Sig1, Attrs1...> m1, function_t<Sig2, Attrs2...> m2) {
   return !(m1 == m2);
 }
 
 // Right-hand-side of a clause in a concept that signifies a function with the
-// given signature.
-template <typename Signature>
-constexpr function_t<Signature> function{};
+// given signature. Attributes like `dyno::pure` can optionally be specified
+// after the signature.
+template <typename Signature, typename ...Attributes>
+constexpr function_t<Signature, Attributes...> function{};
 
-template <typename Signature>
+template <typename Signature, typename ...Attributes>
 struct method_t;
 
 // Right-hand-side of a clause in a concept that signifies a method with the
 // given signature. The first parameter of the resulting function is implicitly
 // `dyno::T&` for a non-const method, and `dyno::T const&` for a const method.
-template <typename Signature>
-constexpr method_t<Signature> method{};
+// Attributes like `dyno::pure` can optionally be specified after the signature.
+template <typename Signature, typename ...Attributes>
+constexpr method_t<Signature, Attributes...> method{};
 
 // Placeholder type representing the type of ref-unqualified `*this` when
 // defining a clause in a concept.
 struct T;
 
-template <typename R, typename ...Args>
-struct method_t<R(Args...)> { using type = R (dyno::T&, Args...); };
-template <typename R, typename ...Args>
-struct method_t<R(Args...) &> { using type = R (dyno::T&, Args...); };
-template <typename R, typename ...Args>
-struct method_t<R(Args...) &&> { using type = R (dyno::T&&, Args...); };
-
-template <typename R, typename ...Args>
-struct method_t<R(Args...) const> { using type = R (dyno::T const&, Args...); };
-template <typename R, typename ...Args>
-struct method_t<R(Args...) const&> { using type = R (dyno::T const&, Args...); };
+namespace detail {
+  template <typename ...Attributes>
+  struct method_attributes {
+    static_assert((detail::is_clause_attribute<Attributes>::value && ...),
+      "dyno::method: The only attributes that can be given to a method "
+      "are `dyno::pure` and `dyno::const_`.");
+  };
+}
+
+template <typename R, typename ...Args, typename ...Attributes>
+struct method_t<R(Args...), Attributes...> : detail::method_attributes<Attributes...>
+{ using type = R (dyno::T&, Args...); };
+template <typename R, typename ...Args, typename ...Attributes>
+struct method_t<R(Args...) &, Attributes...> : detail::method_attributes<Attributes...>
+{ using type = R (dyno::T&, Args...); };
+template <typename R, typename ...Args, typename ...Attributes>
+struct method_t<R(Args...) &&, Attributes...> : detail::method_attributes<Attributes...>
+{ using type = R (dyno::T&&, Args...); };
+
+template <typename R, typename ...Args, typename ...Attributes>
+struct method_t<R(Args...) const, Attributes...> : detail::method_attributes<Attributes...>
+{ using type = R (dyno::T const&, Args...); };
+template <typename R, typename ...Args, typename ...Attributes>
+struct method_t<R(Args...) const&, Attributes...> : detail::method_attributes<Attributes...>
+{ using type = R (dyno::T const&, Args...); };
 // const&& not supported because it's stupid
 
+template <typename Sig1, typename ...Attrs1, typename Sig2, typename ...Attrs2>
+constexpr auto operator==(method_t<Sig1, Attrs1...>, method_t<Sig2, Attrs2...>) {
+  return boost::hana::bool_c<
+    std::is_same<method_t<Sig1, Attrs1...>, method_t<Sig2, Attrs2...>>::value
+  >;
+}
+
+template <typename Sig1, typename ...Attrs1, typename Sig2, typename ...Attrs2>
+constexpr auto operator!=(method_t<Sig1, Attrs1...> m1, method_t<Sig2, Attrs2...> m2) {
+  return !(m1 == m2);
+}
+
+template <typename Signature>
+struct multimethod_t {
+  // The vtable does not hold the implementation of a multimethod, which
+  // depends on more than one type. Instead, it holds a function returning
+  // the index of the model in the dispatch table of the multimethod.
+  using type = std::size_t ();
+  using signature = Signature;
+};
+
+// Right-hand-side of a clause in a concept that signifies a multimethod with
+// the given signature. The signature must contain exactly two placeholders,
+// and the implementation that gets called is selected based on the dynamic
+// types of both of these arguments. See `dyno::define_multimethod` for how
+// to provide implementations of a multimethod.
+template <typename Signature>
+constexpr multimethod_t<Signature> multimethod{};
+
 template <typename Sig1, typename Sig2>
-constexpr auto operator==(method_t<Sig1>, method_t<Sig2>) {
+constexpr auto operator==(multimethod_t<Sig1>, multimethod_t<Sig2>) {
   return boost::hana::bool_c<std::is_same<Sig1, Sig2>::value>;
 }
 
 template <typename Sig1, typename Sig2>
-constexpr auto operator!=(method_t<Sig1> m1, method_t<Sig2> m2) {
+constexpr auto operator!=(multimethod_t<Sig1> m1, multimethod_t<Sig2> m2) {
   return !(m1 == m2);
 }
 
+template <typename Clause>
+struct hot_t { using clause = Clause; };
+
+// Marks a clause of a concept as being hot, i.e. as being called often
+// enough that it is worth storing it right inside the `dyno::poly` instead
+// of in a remote vtable. This is only a hint that is used by some vtable
+// policies (see `dyno::auto_vtable`); otherwise, a hot clause is exactly
+// equivalent to the clause it wraps. For example:
+// ```
+// struct Iterator : decltype(dyno::requires_(
+//   "increment"_s = dyno::hot(dyno::function<void (dyno::T&)>),
+//   ...
+// )) { };
+// ```
+template <typename Signature, typename ...Attributes>
+constexpr hot_t<function_t<Signature, Attributes...>>
+hot(function_t<Signature, Attributes...>) { return {}; }
+
+template <typename Signature, typename ...Attributes>
+constexpr hot_t<method_t<Signature, Attributes...>>
+hot(method_t<Signature, Attributes...>) { return {}; }
+
 namespace detail {
   template <typename Name, typename ...Args>
   struct delayed_call {
@@ -117,6 +235,13 @@ namespace detail {
   }
 } // end namespace detail
 
+// GCC only diagnoses the non-standard literal operator below with -pedantic
+// in C++20 mode, and it has no specific warning flag to silence it.
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
 inline namespace literals {
   // Creates a compile-time string that can be used as the left-hand-side when
   // defining clauses or filling concept maps.
@@ -124,6 +249,10 @@ inline namespace literals {
   constexpr auto operator""_s() { return detail::string<c...>{}; }
 } // end namespace literals
 
+#if defined(__GNUC__) && !defined(__clang__)
+#  pragma GCC diagnostic pop
+#endif
+
 // Creates a Dyno compile-time string without requiring the use of a
 // user-defined literal.
 //
@@ -0,0 +1,320 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_DETAIL_DYNAMIC_DISPATCH_HPP
+#define DYNO_DETAIL_DYNAMIC_DISPATCH_HPP
+
+#include <dyno/concept.hpp>
+#include <dyno/detail/dsl.hpp>
+#include <dyno/detail/is_placeholder.hpp>
+
+#include <boost/hana/basic_tuple.hpp>
+#include <boost/hana/flatten.hpp>
+#include <boost/hana/pair.hpp>
+#include <boost/hana/unpack.hpp>
+
+#include <any>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+
+namespace dyno {
+
+// Exception thrown by `dyno::poly::invoke_dynamic` when there is no function
+// with the requested name, or when it is called with the wrong number of
+// arguments.
+class bad_dynamic_call : public std::invalid_argument {
+public:
+  using std::invalid_argument::invalid_argument;
+};
+
+namespace detail {
+
+// FNV-1a hash of a name.
+constexpr std::uint64_t name_hash(char const* s, std::size_t n) {
+  std::uint64_t hash = 14695981039346656037ull;
+  for (std::size_t i = 0; i != n; ++i) {
+    hash ^= static_cast<unsigned char>(s[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// Perfect hash table mapping `N` names to their index in `[0, N)`, with
+// at most one candidate per slot. It is built with the hash-and-displace
+// method: the names are first split into buckets of about two names using
+// their hash. Then, from the largest bucket to the smallest, we look for a
+// displacement of the hash that sends all the names of the bucket to free
+// slots. The table has twice as many slots as names (rounded up to a power
+// of two), so that a displacement is found after a few tries. Unlike looking
+// for a single hash function without collisions, whose cost is exponential
+// in the number of names, this stays cheap for concepts with many clauses.
+template <std::size_t N>
+struct perfect_hash {
+  static constexpr std::size_t power_of_two(std::size_t min) {
+    std::size_t n = 1;
+    while (n < min)
+      n *= 2;
+    return n;
+  }
+
+  static constexpr std::size_t slot_count() { return power_of_two(2 * N); }
+  static constexpr std::size_t bucket_count() { return power_of_two(N / 2); }
+
+  std::uint32_t displacements[bucket_count()] = {};
+  int slots[slot_count()] = {};
+
+  constexpr perfect_hash(char const* const (&names)[N + 1], std::size_t const (&sizes)[N + 1]) {
+    std::uint64_t hashes[N + 1] = {};
+    std::size_t bucket_sizes[bucket_count()] = {};
+    std::size_t largest = 0;
+    for (std::size_t i = 0; i != N; ++i) {
+      hashes[i] = detail::name_hash(names[i], sizes[i]);
+      std::size_t size = ++bucket_sizes[bucket_of(hashes[i])];
+      largest = size > largest ? size : largest;
+    }
+    for (int& slot : slots)
+      slot = -1;
+
+    for (std::size_t size = largest; size != 0; --size) {
+      for (std::size_t b = 0; b != bucket_count(); ++b) {
+        if (bucket_sizes[b] != size)
+          continue;
+
+        // Try displacements until all the names of the bucket fall in slots
+        // that are free, and distinct from each other. Names of the bucket
+        // are marked with `-2` while we try a displacement.
+        for (std::uint32_t d = 0; ; ++d) {
+          bool placed = true;
+          for (std::size_t i = 0; i != N && placed; ++i) {
+            if (bucket_of(hashes[i]) != b)
+              continue;
+            int& slot = slots[slot_of(hashes[i], d)];
+            placed = slot == -1;
+            if (placed)
+              slot = -2;
+          }
+          for (std::size_t i = 0; i != N; ++i) {
+            if (bucket_of(hashes[i]) != b)
+              continue;
+            int& slot = slots[slot_of(hashes[i], d)];
+            if (slot == -2)
+              slot = placed ? static_cast<int>(i) : -1;
+          }
+          if (placed) {
+            displacements[b] = d;
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  // The low bits of the hash depend on all the characters of the name, so
+  // they are used to select the bucket. The slot is taken from the high bits
+  // of a multiplication, which depend on all the bits of the hash.
+  static constexpr std::size_t bucket_of(std::uint64_t hash) {
+    return static_cast<std::size_t>(hash) & (bucket_count() - 1);
+  }
+
+  static constexpr std::size_t slot_of(std::uint64_t hash, std::uint32_t displacement) {
+    std::uint64_t h = (hash ^ (displacement * 0x9e3779b97f4a7c15ull)) * 0xff51afd7ed558ccdull;
+    return static_cast<std::size_t>(h >> 32) & (slot_count() - 1);
+  }
+
+  constexpr std::size_t slot_of(char const* name, std::size_t size) const {
+    std::uint64_t hash = detail::name_hash(name, size);
+    return slot_of(hash, displacements[bucket_of(hash)]);
+  }
+};
+
+// Converts an argument passed to `invoke_dynamic` to the type of a parameter.
+// Non-const lvalue references are passed as `std::reference_wrapper`s, and
+// everything else is passed by value.
+template <typename Param>
+decltype(auto) unmarshal(std::any& arg) {
+  using Raw = std::remove_cv_t<std::remove_reference_t<Param>>;
+  if constexpr (std::is_lvalue_reference<Param>::value &&
+                !std::is_const<std::remove_reference_t<Param>>::value)
+    return std::any_cast<std::reference_wrapper<Raw>>(arg).get();
+  else if constexpr (std::is_rvalue_reference<Param>::value)
+    return std::move(std::any_cast<Raw&>(arg));
+  else
+    return std::any_cast<Raw&>(arg);
+}
+
+template <typename R, typename ...Params, typename F, std::size_t ...I>
+std::any marshal_call(F const& f, std::any* args, std::index_sequence<I...>) {
+  if constexpr (std::is_void<R>::value) {
+    f(detail::unmarshal<Params>(args[I])...);
+    return {};
+  } else {
+    return std::any{f(detail::unmarshal<Params>(args[I])...)};
+  }
+}
+
+// Returns whether a function returning `R` and taking parameters `Params`
+// (beyond `*this`) can be called through `invoke_dynamic`.
+template <typename R, typename ...Params>
+constexpr bool dynamically_callable =
+  (std::is_void<R>::value || std::is_copy_constructible<std::decay_t<R>>::value) &&
+  !(detail::is_placeholder<Params>::value || ...);
+
+// Calls the clause named `Name` on the poly `p` of type `PolyRef` (either
+// `Poly&` or `Poly const&`), with arguments taken out of `std::any`s. Only
+// methods and functions whose first parameter is the object itself can be
+// called this way, and only if they can be called on `PolyRef`.
+template <typename PolyRef, typename Name, typename Clause>
+struct dynamic_invoker {
+  static constexpr bool enabled = false;
+};
+
+template <typename PolyRef, typename Name, typename R, typename ...Params, typename ...Attributes>
+struct dynamic_invoker<PolyRef, Name, dyno::method_t<R(Params...), Attributes...>> {
+  static constexpr bool enabled = !std::is_const<std::remove_reference_t<PolyRef>>::value &&
+                                  detail::dynamically_callable<R, Params...>;
+  static constexpr std::size_t arity = sizeof...(Params);
+  static std::any invoke(PolyRef p, std::any* args) {
+    return detail::marshal_call<R, Params...>(p.virtual_(Name{}), args,
+                                              std::index_sequence_for<Params...>{});
+  }
+};
+
+template <typename PolyRef, typename Name, typename R, typename ...Params, typename ...Attributes>
+struct dynamic_invoker<PolyRef, Name, dyno::method_t<R(Params...) &, Attributes...>>
+  : dynamic_invoker<PolyRef, Name, dyno::method_t<R(Params...), Attributes...>>
+{ };
+
+template <typename PolyRef, typename Name, typename R, typename ...Params, typename ...Attributes>
+struct dynamic_invoker<PolyRef, Name, dyno::method_t<R(Params...) const, Attributes...>> {
+  static constexpr bool enabled = detail::dynamically_callable<R, Params...>;
+  static constexpr std::size_t arity = sizeof...(Params);
+  static std::any invoke(PolyRef p, std::any* args) {
+    return detail::marshal_call<R, Params...>(p.virtual_(Name{}), args,
+                                              std::index_sequence_for<Params...>{});
+  }
+};
+
+template <typename PolyRef, typename Name, typename R, typename ...Params, typename ...Attributes>
+struct dynamic_invoker<PolyRef, Name, dyno::method_t<R(Params...) const&, Attributes...>>
+  : dynamic_invoker<PolyRef, Name, dyno::method_t<R(Params...) const, Attributes...>>
+{ };
+
+template <typename PolyRef, typename Name, typename Self, typename R, typename ...Params>
+struct function_invoker {
+  static constexpr bool enabled =
+    (std::is_same<Self, dyno::T const&>::value ||
+     (std::is_same<Self, dyno::T&>::value && !std::is_const<std::remove_reference_t<PolyRef>>::value)) &&
+    detail::dynamically_callable<R, Params...>;
+  static constexpr std::size_t arity = sizeof...(Params);
+  static std::any invoke(PolyRef p, std::any* args) {
+    auto f = p.virtual_(Name{});
+    auto call = [&f, &p](auto&& ...xs) -> decltype(auto) {
+      return f(p, static_cast<decltype(xs)&&>(xs)...);
+    };
+    return detail::marshal_call<R, Params...>(call, args, std::index_sequence_for<Params...>{});
+  }
+};
+
+template <typename PolyRef, typename Name, typename R, typename ...Params, typename ...Attributes>
+struct dynamic_invoker<PolyRef, Name, dyno::function_t<R(Params...), Attributes...>> {
+  static constexpr bool enabled = false;
+};
+
+template <typename PolyRef, typename Name, typename R, typename Self, typename ...Params, typename ...Attributes>
+struct dynamic_invoker<PolyRef, Name, dyno::function_t<R(Self, Params...), Attributes...>>
+  : function_invoker<PolyRef, Name, Self, R, Params...>
+{ };
+
+template <typename Name>
+struct name_chars;
+
+template <char ...c>
+struct name_chars<detail::string<c...>> {
+  static constexpr char value[sizeof...(c) + 1] = {c..., '\0'};
+};
+
+// Table of the functions of `Concept` that can be called by name on a
+// `PolyRef`, indexed by a perfect hash of their names.
+template <typename PolyRef, typename Concept,
+          typename Clauses = decltype(dyno::clauses(Concept{}))>
+struct dynamic_dispatch;
+
+template <typename PolyRef, typename Concept, typename ...Names, typename ...Clauses>
+struct dynamic_dispatch<PolyRef, Concept,
+                        boost::hana::basic_tuple<boost::hana::pair<Names, Clauses>...>> {
+private:
+  struct entry {
+    char const* name;
+    std::size_t size;
+    std::size_t arity;
+    std::any (*invoke)(PolyRef, std::any*);
+  };
+
+  template <typename Name, typename Clause>
+  static constexpr bool enabled = dynamic_invoker<PolyRef, Name, Clause>::enabled;
+
+  static constexpr std::size_t count = (std::size_t{0} + ... + (enabled<Names, Clauses> ? 1 : 0));
+
+  template <typename Name, typename Clause>
+  static constexpr auto entry_for() {
+    using Invoker = dynamic_invoker<PolyRef, Name, Clause>;
+    if constexpr (Invoker::enabled) {
+      return boost::hana::make_basic_tuple(entry{
+        name_chars<Name>::value, sizeof(name_chars<Name>::value) - 1,
+        Invoker::arity, &Invoker::invoke
+      });
+    } else {
+      return boost::hana::make_basic_tuple();
+    }
+  }
+
+  // The entries of the enabled clauses, followed by a sentinel entry.
+  static constexpr auto make_entries() {
+    auto all = boost::hana::flatten(boost::hana::make_basic_tuple(entry_for<Names, Clauses>()...));
+    return boost::hana::unpack(all, [](auto ...e) {
+      return std::array<entry, count + 1>{{e..., entry{"", 0, 0, nullptr}}};
+    });
+  }
+
+  static constexpr std::array<entry, count + 1> entries = make_entries();
+
+  static constexpr perfect_hash<count> make_table() {
+    char const* names[count + 1] = {};
+    std::size_t sizes[count + 1] = {};
+    for (std::size_t i = 0; i != count; ++i) {
+      names[i] = entries[i].name;
+      sizes[i] = entries[i].size;
+    }
+    return perfect_hash<count>{names, sizes};
+  }
+
+  static constexpr perfect_hash<count> table = make_table();
+
+public:
+  static std::any invoke(PolyRef p, std::string_view name, std::any* args, std::size_t n) {
+    int slot = table.slots[table.slot_of(name.data(), name.size())];
+    entry const& e = entries[slot == -1 ? count : static_cast<std::size_t>(slot)];
+    if (e.invoke == nullptr || e.size != name.size() ||
+        std::memcmp(e.name, name.data(), name.size()) != 0)
+      throw dyno::bad_dynamic_call{"dyno::poly::invoke_dynamic: no function named '" +
+                                   std::string{name} + "' can be called on this object"};
+    if (e.arity != n)
+      throw dyno::bad_dynamic_call{"dyno::poly::invoke_dynamic: wrong number of arguments "
+                                   "for '" + std::string{name} + "'"};
+    return e.invoke(p, args);
+  }
+};
+
+}} // end namespace dyno::detail
+
+#endif // DYNO_DETAIL_DYNAMIC_DISPATCH_HPP
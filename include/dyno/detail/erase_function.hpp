@@ -10,9 +10,28 @@
 
 #include <boost/callable_traits/function_type.hpp>
 
+#include <type_traits>
 #include <utility>
 
 
+// Attributes of the functions stored in vtables.
+//
+// When `DYNO_HOT_THUNKS` is defined, these functions are marked as hot, which
+// makes GCC place them in the `.text.hot` section when optimizations are
+// enabled. The linker groups that section together, so the thunks of all the
+// models end up next to each other instead of being scattered across the
+// program, next to the first function that happened to instantiate them.
+//
+// This is opt-in, because the attribute also makes the compiler optimize the
+// thunks more aggressively and treat the paths calling them as likely. That
+// is only desirable when dynamic dispatch is on the hot path of the program,
+// which only the program itself (or a profile) can tell.
+#if defined(DYNO_HOT_THUNKS) && defined(__GNUC__)
+#  define DYNO_THUNK_ATTRIBUTES [[gnu::hot]]
+#else
+#  define DYNO_THUNK_ATTRIBUTES
+#endif
+
 namespace dyno { namespace detail {
 
 template <typename Eraser, typename F, typename PlaceholderSig, typename ActualSig>
@@ -21,7 +40,7 @@ struct thunk;
 template <typename Eraser, typename F, typename R_pl, typename ...Args_pl,
                                        typename R_ac, typename ...Args_ac>
 struct thunk<Eraser, F, R_pl(Args_pl...), R_ac(Args_ac...)> {
-  static constexpr auto
+  DYNO_THUNK_ATTRIBUTES static constexpr auto
   apply(typename detail::erase_placeholder<Eraser, Args_pl>::type ...args)
     -> typename detail::erase_placeholder<Eraser, R_pl>::type
   {
@@ -38,7 +57,7 @@ struct thunk<Eraser, F, R_pl(Args_pl...), R_ac(Args_ac...)> {
 template <typename Eraser, typename F,    /* void */  typename ...Args_pl,
                                        typename R_ac, typename ...Args_ac>
 struct thunk<Eraser, F, void(Args_pl...), R_ac(Args_ac...)> {
-  static constexpr auto
+  DYNO_THUNK_ATTRIBUTES static constexpr auto
   apply(typename detail::erase_placeholder<Eraser, Args_pl>::type ...args)
     -> void
   {
@@ -50,6 +69,17 @@ struct thunk<Eraser, F, void(Args_pl...), R_ac(Args_ac...)> {
   }
 };
 
+// Function objects may pick the function to store in the vtable themselves,
+// by providing a static `erase<Signature, Eraser>()` function returning it
+// (see `dyno::multiversion`).
+template <typename F, typename Signature, typename Eraser, typename = void>
+struct erases_itself : std::false_type { };
+
+template <typename F, typename Signature, typename Eraser>
+struct erases_itself<F, Signature, Eraser, decltype(
+  (void)F::template erase<Signature, Eraser>()
+)> : std::true_type { };
+
 // Transform an actual (stateless) function object with statically typed
 // parameters into a type-erased function suitable for storage in a vtable.
 //
@@ -63,9 +93,13 @@ struct thunk<Eraser, F, void(Args_pl...), R_ac(Args_ac...)> {
 //  - Should we be returning a lambda that erases its arguments?
 template <typename Signature, typename Eraser = void, typename F>
 constexpr auto erase_function(F const&) {
-  using ActualSignature = boost::callable_traits::function_type_t<F>;
-  using Thunk = detail::thunk<Eraser, F, Signature, ActualSignature>;
-  return &Thunk::apply;
+  if constexpr (detail::erases_itself<F, Signature, Eraser>::value) {
+    return F::template erase<Signature, Eraser>();
+  } else {
+    using ActualSignature = boost::callable_traits::function_type_t<F>;
+    using Thunk = detail::thunk<Eraser, F, Signature, ActualSignature>;
+    return &Thunk::apply;
+  }
 }
 
 }} // end namespace dyno::detail
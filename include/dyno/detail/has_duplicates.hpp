@@ -5,24 +5,36 @@
 #ifndef DYNO_DETAIL_HAS_DUPLICATES_HPP
 #define DYNO_DETAIL_HAS_DUPLICATES_HPP
 
-#include <boost/hana/core/to.hpp>
-#include <boost/hana/length.hpp>
-#include <boost/hana/not_equal.hpp>
-#include <boost/hana/set.hpp>
+#include <dyno/detail/index_of.hpp>
+
+#include <boost/hana/bool.hpp>
+#include <boost/hana/unpack.hpp>
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
 
 
 namespace dyno { namespace detail {
 
+template <typename ...T, std::size_t ...I>
+constexpr bool has_duplicates_impl(std::index_sequence<I...>) {
+  return ((detail::index_of<T, T...>() != I) || ...);
+}
+
 // Returns whether a Foldable contains duplicate elements, i.e. elements
-// that compare equal to each other.
+// that have the same type. This is meant to be used with sequences of
+// compile-time strings, where equality is the same as having the same type.
 //
 // TODO: Lift this into the public interface of Hana.
 template <typename Foldable>
 constexpr auto has_duplicates(Foldable const& foldable) {
-  return boost::hana::not_equal(
-    boost::hana::length(boost::hana::to_set(foldable)),
-    boost::hana::length(foldable)
-  );
+  return boost::hana::unpack(foldable, [](auto const& ...x) {
+    constexpr bool result = detail::has_duplicates_impl<std::decay_t<decltype(x)>...>(
+      std::index_sequence_for<decltype(x)...>{}
+    );
+    return boost::hana::bool_c<result>;
+  });
 }
 
 }} // end namespace dyno::detail
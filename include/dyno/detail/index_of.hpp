@@ -0,0 +1,31 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_DETAIL_INDEX_OF_HPP
+#define DYNO_DETAIL_INDEX_OF_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+
+namespace dyno { namespace detail {
+
+// Returns the index of the first occurrence of `T` in `Ts...`, or
+// `sizeof...(Ts)` if `T` is not in `Ts...`.
+//
+// This is a single constexpr evaluation instead of a recursive instantiation,
+// which makes it much cheaper to compile than going through Hana's
+// associative sequences.
+template <typename T, typename ...Ts>
+constexpr std::size_t index_of() {
+  constexpr bool matches[] = {std::is_same<T, Ts>::value..., true};
+  std::size_t i = 0;
+  while (!matches[i])
+    ++i;
+  return i;
+}
+
+}} // end namespace dyno::detail
+
+#endif // DYNO_DETAIL_INDEX_OF_HPP
@@ -25,6 +25,15 @@ template <> struct is_placeholder<dyno::T const&> : std::true_type { };
 template <> struct is_placeholder<dyno::T const&&> : std::true_type { };
 template <> struct is_placeholder<dyno::T const*> : std::true_type { };
 
+// Returns whether `T` is a placeholder through which the object can't be
+// modified.
+template <typename T>
+struct is_const_placeholder : std::false_type { };
+
+template <> struct is_const_placeholder<dyno::T const&> : std::true_type { };
+template <> struct is_const_placeholder<dyno::T const&&> : std::true_type { };
+template <> struct is_const_placeholder<dyno::T const*> : std::true_type { };
+
 }} // end namespace dyno::detail
 
 #endif // DYNO_DETAIL_IS_PLACEHOLDER_HPP
@@ -0,0 +1,413 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_FLAT_POLY_VECTOR_HPP
+#define DYNO_FLAT_POLY_VECTOR_HPP
+
+#include <dyno/poly.hpp>
+#include <dyno/vtable.hpp>
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#  define DYNO_HAS_MMAP
+#endif
+
+
+namespace dyno {
+
+namespace detail {
+  // Alignment of the objects in a flat container, and of the buffer holding
+  // them. Objects with a stricter alignment can't be stored.
+  inline constexpr std::size_t flat_alignment = 16;
+
+  // Number of bits of an entry holding the index of the model; the other bits
+  // hold the offset of the object in the buffer.
+  inline constexpr std::uint64_t flat_model_bits = 24;
+  inline constexpr std::uint64_t flat_model_mask = (std::uint64_t{1} << flat_model_bits) - 1;
+
+  struct alignas(flat_alignment) flat_block {
+    unsigned char bytes[flat_alignment];
+  };
+
+  // Header of the files written by `dyno::flat_poly_vector::write`. The file
+  // is laid out as follows, where each section starts at a multiple of
+  // `flat_file_alignment` bytes:
+  //  - the header
+  //  - the entries, one 64-bit integer per element
+  //  - the objects
+  struct flat_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t fingerprint;
+    std::uint64_t size;
+    std::uint64_t data_size;
+  };
+
+  inline constexpr char flat_magic[8] = {'d', 'y', 'n', 'o', 'f', 'l', 'a', 't'};
+  inline constexpr std::uint32_t flat_version = 1;
+  inline constexpr std::uint32_t flat_byte_order = 0x01020304;
+  inline constexpr std::size_t flat_file_alignment = 64;
+
+  constexpr std::size_t flat_round_up(std::size_t n, std::size_t alignment)
+  { return (n + alignment - 1) / alignment * alignment; }
+
+  // Table mapping the index of each model of a registry to a function
+  // creating a reference to an object of that model.
+  template <typename Reference, typename Registry>
+  struct flat_dispatch;
+} // end namespace detail
+
+// List of the types that can be stored in a `dyno::flat_poly_vector`.
+//
+// Instead of a pointer to their vtable, which is only valid in the process
+// that created them, objects stored in a flat container are tagged with the
+// index of their type in the registry. That index is stable across processes,
+// as long as the registry lists the same types in the same order. Hence, new
+// types must be appended at the end of a registry whose containers have been
+// written to disk.
+//
+// The objects are stored and reloaded as raw bytes, so the models must be
+// trivially copyable. They must also not contain pointers, which would not be
+// valid when the objects are reloaded, but that can't be checked.
+template <typename ...Models>
+struct model_registry {
+  static_assert((std::is_trivially_copyable<Models>::value && ...),
+    "dyno::model_registry: All the models must be trivially copyable, since "
+    "objects are stored and reloaded as raw bytes.");
+  static_assert(((alignof(Models) <= detail::flat_alignment) && ...),
+    "dyno::model_registry: The models can't have an alignment stricter than "
+    "that of the buffer they are stored in (16 bytes).");
+  static_assert(sizeof...(Models) <= detail::flat_model_mask,
+    "dyno::model_registry: Too many models.");
+
+  static constexpr std::size_t size() { return sizeof...(Models); }
+
+  // Returns the index of `T` in the registry.
+  template <typename T>
+  static constexpr std::uint32_t index_of() {
+    constexpr bool matches[] = {std::is_same<T, Models>::value..., false};
+    std::uint32_t i = 0;
+    while (!matches[i])
+      ++i;
+    return i;
+  }
+
+  template <typename T>
+  static constexpr bool contains = (std::is_same<T, Models>::value || ...);
+
+  // Hash of the number, sizes and alignments of the models, stored in files
+  // to detect files written with an incompatible registry. This can't detect
+  // all incompatibilities, e.g. a model whose members are reordered.
+  static constexpr std::uint64_t fingerprint() {
+    std::uint64_t hash = 14695981039346656037ull; // FNV-1a
+    std::uint64_t const values[] = {sizeof...(Models), sizeof(Models)..., alignof(Models)...};
+    for (std::uint64_t value : values) {
+      for (int byte = 0; byte != 8; ++byte) {
+        hash ^= (value >> (8 * byte)) & 0xff;
+        hash *= 1099511628211ull;
+      }
+    }
+    return hash;
+  }
+};
+
+namespace detail {
+  template <typename Reference, typename ...Models>
+  struct flat_dispatch<Reference, dyno::model_registry<Models...>> {
+    template <typename T>
+    static Reference make(void const* object)
+    { return Reference{*static_cast<T const*>(object)}; }
+
+    static constexpr Reference (*table[sizeof...(Models)])(void const*) = {&make<Models>...};
+  };
+
+  // Read-only access to the elements of a flat container, shared by the
+  // in-memory and the mapped containers. `Derived` must provide `entries()`
+  // and `objects()`, returning pointers to the beginning of the entries and
+  // of the objects, respectively, and `size()`.
+  template <typename Derived, typename Concept, typename Registry, typename VTablePolicy>
+  class flat_poly_access {
+  public:
+    using reference = dyno::poly_cref<Concept, VTablePolicy>;
+
+    class const_iterator {
+    public:
+      using iterator_category = std::input_iterator_tag;
+      using value_type = typename flat_poly_access::reference;
+      using reference = value_type;
+      using pointer = void;
+      using difference_type = std::ptrdiff_t;
+
+      const_iterator(Derived const* self, std::size_t i) : self_{self}, i_{i} { }
+
+      reference operator*() const { return (*self_)[i_]; }
+      const_iterator& operator++() { ++i_; return *this; }
+      const_iterator operator++(int) { auto tmp = *this; ++i_; return tmp; }
+
+      friend bool operator==(const_iterator const& a, const_iterator const& b)
+      { return a.i_ == b.i_; }
+      friend bool operator!=(const_iterator const& a, const_iterator const& b)
+      { return a.i_ != b.i_; }
+
+    private:
+      Derived const* self_;
+      std::size_t i_;
+    };
+
+    // Returns a reference to the `i`-th object. The reference is invalidated
+    // when the container is modified or destroyed.
+    reference operator[](std::size_t i) const {
+      Derived const& self = static_cast<Derived const&>(*this);
+      assert(i < self.size());
+      std::uint64_t entry = self.entries()[i];
+      std::size_t model = static_cast<std::size_t>(entry & detail::flat_model_mask);
+      std::size_t offset = static_cast<std::size_t>(entry >> detail::flat_model_bits);
+      return detail::flat_dispatch<reference, Registry>::table[model](self.objects() + offset);
+    }
+
+    bool empty() const { return static_cast<Derived const&>(*this).size() == 0; }
+
+    const_iterator begin() const
+    { return const_iterator{static_cast<Derived const*>(this), 0}; }
+
+    const_iterator end() const {
+      Derived const* self = static_cast<Derived const*>(this);
+      return const_iterator{self, self->size()};
+    }
+  };
+} // end namespace detail
+
+// Container of polymorphic objects satisfying `Concept`, whose types are
+// listed in `Registry` (a `dyno::model_registry`), and which can be written
+// to a file and mapped back in memory without rebuilding the objects.
+//
+// The objects are stored contiguously in a single buffer, each tagged with
+// the index of its type in the registry. Elements are accessed as
+// `dyno::poly_cref`s, whose vtable is found from the index of the model. A
+// container written with `write` can be loaded with `dyno::mapped_poly_vector`
+// in a process using the same registry, e.g. after a restart:
+// ```
+// using Rules = dyno::model_registry<Threshold, Range, Always>;
+//
+// dyno::flat_poly_vector<Rule, Rules> rules;
+// rules.push_back(Threshold{10});
+// rules.push_back(Range{2, 5});
+// std::ofstream out{"rules.bin", std::ios::binary};
+// rules.write(out);
+//
+// // later, maybe in another process
+// dyno::mapped_poly_vector<Rule, Rules> mapped{"rules.bin"};
+// for (auto rule : mapped)
+//   rule.virtual_("matches"_s)(order);
+// ```
+template <
+  typename Concept,
+  typename Registry,
+  typename VTablePolicy = dyno::vtable<dyno::remote<dyno::everything>>
+>
+class flat_poly_vector
+  : public detail::flat_poly_access<flat_poly_vector<Concept, Registry, VTablePolicy>,
+                                    Concept, Registry, VTablePolicy>
+{
+public:
+  std::size_t size() const { return entries_.size(); }
+
+  void reserve(std::size_t objects, std::size_t bytes = 0) {
+    entries_.reserve(objects);
+    data_.reserve(detail::flat_round_up(bytes, detail::flat_alignment) / detail::flat_alignment);
+  }
+
+  // Appends a copy of `t` at the end of the container.
+  template <typename T>
+  void push_back(T const& t) {
+    static_assert(Registry::template contains<T>,
+      "dyno::flat_poly_vector::push_back: The type of the object must be in "
+      "the model registry of the container.");
+
+    constexpr std::uint64_t model = Registry::template index_of<T>();
+    std::size_t offset = detail::flat_round_up(data_size_, alignof(T));
+    data_size_ = offset + sizeof(T);
+    data_.resize(detail::flat_round_up(data_size_, detail::flat_alignment) / detail::flat_alignment);
+    std::memcpy(this->objects() + offset, &t, sizeof(T));
+    entries_.push_back(static_cast<std::uint64_t>(offset) << detail::flat_model_bits | model);
+  }
+
+  void clear() {
+    entries_.clear();
+    data_.clear();
+    data_size_ = 0;
+  }
+
+  // Writes the container to `out`, which should be opened in binary mode.
+  // The file can be loaded back with `dyno::mapped_poly_vector`, on a machine
+  // with the same byte order and with a program using the same registry.
+  void write(std::ostream& out) const {
+    detail::flat_header header{};
+    std::memcpy(header.magic, detail::flat_magic, sizeof(header.magic));
+    header.version = detail::flat_version;
+    header.byte_order = detail::flat_byte_order;
+    header.fingerprint = Registry::fingerprint();
+    header.size = entries_.size();
+    header.data_size = data_size_;
+
+    char const padding[detail::flat_file_alignment] = {};
+    auto write_section = [&](void const* p, std::size_t n) {
+      out.write(static_cast<char const*>(p), static_cast<std::streamsize>(n));
+      std::size_t pad = detail::flat_round_up(n, detail::flat_file_alignment) - n;
+      out.write(padding, static_cast<std::streamsize>(pad));
+    };
+    write_section(&header, sizeof(header));
+    write_section(entries_.data(), entries_.size() * sizeof(std::uint64_t));
+    write_section(data_.data(), data_size_);
+  }
+
+private:
+  template <typename, typename, typename, typename>
+  friend class detail::flat_poly_access;
+
+  std::uint64_t const* entries() const { return entries_.data(); }
+  unsigned char* objects() { return reinterpret_cast<unsigned char*>(data_.data()); }
+  unsigned char const* objects() const { return reinterpret_cast<unsigned char const*>(data_.data()); }
+
+  std::vector<std::uint64_t> entries_;
+  std::vector<detail::flat_block> data_;
+  std::size_t data_size_ = 0;
+};
+
+#if defined(DYNO_HAS_MMAP)
+// Read-only view of a `dyno::flat_poly_vector` written to a file, which is
+// mapped in memory.
+//
+// Opening the file only maps it and checks its header, so it takes constant
+// time regardless of the number of objects; the pages holding the objects
+// are read by the operating system when they are first accessed. The
+// contents of the file are trusted: only the header is checked against the
+// registry, so the file must have been written by `flat_poly_vector::write`.
+//
+// Failing to open or map the file throws a `std::system_error`, and a file
+// with an invalid header throws a `std::runtime_error`.
+template <
+  typename Concept,
+  typename Registry,
+  typename VTablePolicy = dyno::vtable<dyno::remote<dyno::everything>>
+>
+class mapped_poly_vector
+  : public detail::flat_poly_access<mapped_poly_vector<Concept, Registry, VTablePolicy>,
+                                    Concept, Registry, VTablePolicy>
+{
+public:
+  explicit mapped_poly_vector(char const* path) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd == -1)
+      throw std::system_error{errno, std::generic_category(), path};
+
+    struct stat info;
+    if (::fstat(fd, &info) == -1) {
+      int error = errno;
+      ::close(fd);
+      throw std::system_error{error, std::generic_category(), path};
+    }
+    map_size_ = static_cast<std::size_t>(info.st_size);
+    if (map_size_ < sizeof(detail::flat_header)) {
+      ::close(fd);
+      throw std::runtime_error{std::string{"dyno::mapped_poly_vector: file is too small: "} + path};
+    }
+
+    void* map = ::mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (map == MAP_FAILED)
+      throw std::system_error{error, std::generic_category(), path};
+    map_ = static_cast<unsigned char const*>(map);
+
+    try {
+      this->check_header(path);
+    } catch (...) {
+      ::munmap(const_cast<unsigned char*>(map_), map_size_);
+      throw;
+    }
+  }
+
+  mapped_poly_vector(mapped_poly_vector&& other)
+    : map_{std::exchange(other.map_, nullptr)}
+    , map_size_{std::exchange(other.map_size_, 0)}
+    , size_{std::exchange(other.size_, 0)}
+    , entries_{other.entries_}
+    , objects_{other.objects_}
+  { }
+
+  mapped_poly_vector(mapped_poly_vector const&) = delete;
+  mapped_poly_vector& operator=(mapped_poly_vector const&) = delete;
+  mapped_poly_vector& operator=(mapped_poly_vector&&) = delete;
+
+  ~mapped_poly_vector() {
+    if (map_ != nullptr)
+      ::munmap(const_cast<unsigned char*>(map_), map_size_);
+  }
+
+  std::size_t size() const { return size_; }
+
+private:
+  template <typename, typename, typename, typename>
+  friend class detail::flat_poly_access;
+
+  std::uint64_t const* entries() const { return entries_; }
+  unsigned char const* objects() const { return objects_; }
+
+  void check_header(char const* path) {
+    detail::flat_header header;
+    std::memcpy(&header, map_, sizeof(header));
+    auto fail = [path](char const* what) {
+      throw std::runtime_error{std::string{"dyno::mapped_poly_vector: "} + what + ": " + path};
+    };
+    if (std::memcmp(header.magic, detail::flat_magic, sizeof(header.magic)) != 0)
+      fail("not a file written by dyno::flat_poly_vector");
+    if (header.version != detail::flat_version)
+      fail("unsupported version");
+    if (header.byte_order != detail::flat_byte_order)
+      fail("file written on a machine with a different byte order");
+    if (header.fingerprint != Registry::fingerprint())
+      fail("file written with a different model registry");
+
+    std::size_t entries_offset = detail::flat_round_up(sizeof(header), detail::flat_file_alignment);
+    std::size_t objects_offset = entries_offset + detail::flat_round_up(
+      static_cast<std::size_t>(header.size) * sizeof(std::uint64_t), detail::flat_file_alignment);
+    if (header.size > map_size_ / sizeof(std::uint64_t) ||
+        objects_offset + header.data_size > map_size_)
+      fail("file is truncated");
+
+    size_ = static_cast<std::size_t>(header.size);
+    entries_ = reinterpret_cast<std::uint64_t const*>(map_ + entries_offset);
+    objects_ = map_ + objects_offset;
+  }
+
+  unsigned char const* map_ = nullptr;
+  std::size_t map_size_ = 0;
+  std::size_t size_ = 0;
+  std::uint64_t const* entries_ = nullptr;
+  unsigned char const* objects_ = nullptr;
+};
+#endif // DYNO_HAS_MMAP
+
+} // end namespace dyno
+
+#endif // DYNO_FLAT_POLY_VECTOR_HPP
@@ -0,0 +1,458 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_FUNCTION_HPP
+#define DYNO_FUNCTION_HPP
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/detail/dsl.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/storage.hpp>
+#include <dyno/vtable.hpp>
+
+#include <boost/hana/contains.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+
+namespace dyno {
+
+namespace detail {
+  // Compile-time string used as the name of the clause implementing the
+  // `I`-th signature of a `dyno::Callable`, i.e. "call0", "call1", etc.
+  template <std::size_t I, char ...c>
+  struct call_name : call_name<I / 10, static_cast<char>('0' + I % 10), c...> { };
+
+  template <char ...c>
+  struct call_name<0, c...> { using type = detail::string<'c', 'a', 'l', 'l', c...>; };
+
+  template <std::size_t I>
+  using call_name_t = typename call_name<I / 10, static_cast<char>('0' + I % 10)>::type;
+
+  // Traits describing the signatures accepted by the `dyno::Callable` concept.
+  // A signature `R(Args...)` means that the callable is invoked as a non-const
+  // lvalue, whereas `R(Args...) const` means it is invoked as a const lvalue.
+  // Any of these can additionally be marked `noexcept`.
+  template <typename Signature>
+  struct function_signature;
+
+  template <typename R, typename ...Args>
+  struct function_signature<R(Args...)> {
+    using clause = R (dyno::T&, Args...);
+    template <typename F>
+    using is_invocable = std::is_invocable_r<R, F&, Args...>;
+  };
+
+  template <typename R, typename ...Args>
+  struct function_signature<R(Args...) const> {
+    using clause = R (dyno::T const&, Args...);
+    template <typename F>
+    using is_invocable = std::is_invocable_r<R, F const&, Args...>;
+  };
+
+  template <typename R, typename ...Args>
+  struct function_signature<R(Args...) noexcept> {
+    using clause = R (dyno::T&, Args...);
+    template <typename F>
+    using is_invocable = std::is_nothrow_invocable_r<R, F&, Args...>;
+  };
+
+  template <typename R, typename ...Args>
+  struct function_signature<R(Args...) const noexcept> {
+    using clause = R (dyno::T const&, Args...);
+    template <typename F>
+    using is_invocable = std::is_nothrow_invocable_r<R, F const&, Args...>;
+  };
+
+  template <typename Signature>
+  struct is_const_signature : std::false_type { };
+  template <typename R, typename ...Args>
+  struct is_const_signature<R(Args...) const> : std::true_type { };
+  template <typename R, typename ...Args>
+  struct is_const_signature<R(Args...) const noexcept> : std::true_type { };
+
+  // Returns the plain function type corresponding to a signature. This is
+  // used as the default type of the callable when constructing a function
+  // wrapper, which allows passing overloaded functions like `std::to_string`.
+  template <typename Signature>
+  struct plain_signature;
+  template <typename R, typename ...Args>
+  struct plain_signature<R(Args...)> { using type = R(Args...); };
+  template <typename R, typename ...Args>
+  struct plain_signature<R(Args...) const> { using type = R(Args...); };
+  template <typename R, typename ...Args>
+  struct plain_signature<R(Args...) noexcept> { using type = R(Args...); };
+  template <typename R, typename ...Args>
+  struct plain_signature<R(Args...) const noexcept> { using type = R(Args...); };
+
+  template <typename Signature, typename ...Signatures>
+  struct first_plain_signature : plain_signature<Signature> { };
+
+  // Type of the object held by a function wrapper in the null state. Calling
+  // it throws `std::bad_function_call`.
+  struct empty_function { };
+
+  template <typename R, typename F, typename ...Args>
+  constexpr R invoke_function(F& f, Args&& ...args) {
+    if constexpr (std::is_same<std::remove_const_t<F>, detail::empty_function>{}) {
+      throw std::bad_function_call{};
+    } else if constexpr (std::is_void<R>{}) {
+      std::invoke(f, std::forward<Args>(args)...);
+    } else {
+      return std::invoke(f, std::forward<Args>(args)...);
+    }
+  }
+
+  // Concept satisfied by callables that can be called with the `I`-th
+  // signature of a `dyno::Callable`.
+  template <std::size_t I, typename Signature>
+  struct Invocable : decltype(dyno::requires_(
+    detail::call_name_t<I>{} = dyno::function<typename function_signature<Signature>::clause>
+  )) { };
+
+  template <typename Indices, typename ...Signatures>
+  struct make_callable;
+
+  template <std::size_t ...I, typename ...Signatures>
+  struct make_callable<std::index_sequence<I...>, Signatures...> {
+    using type = decltype(dyno::requires_(detail::Invocable<I, Signatures>{}...));
+  };
+
+  // Concept used to tell whether a function wrapper is in the null state.
+  struct NullableFunction : decltype(dyno::requires_(
+    "empty"_s = dyno::function<bool ()>
+  )) { };
+} // end namespace detail
+
+template <std::size_t I, typename R, typename ...Args, typename F>
+inline auto const default_concept_map<detail::Invocable<I, R(Args...)>, F> = dyno::make_concept_map(
+  detail::call_name_t<I>{} = [](F& f, Args ...args) -> R {
+    return detail::invoke_function<R>(f, std::forward<Args>(args)...);
+  }
+);
+
+template <std::size_t I, typename R, typename ...Args, typename F>
+inline auto const default_concept_map<detail::Invocable<I, R(Args...) const>, F> = dyno::make_concept_map(
+  detail::call_name_t<I>{} = [](F const& f, Args ...args) -> R {
+    return detail::invoke_function<R>(f, std::forward<Args>(args)...);
+  }
+);
+
+template <std::size_t I, typename R, typename ...Args, typename F>
+inline auto const default_concept_map<detail::Invocable<I, R(Args...) noexcept>, F> = dyno::make_concept_map(
+  detail::call_name_t<I>{} = [](F& f, Args ...args) -> R {
+    return detail::invoke_function<R>(f, std::forward<Args>(args)...);
+  }
+);
+
+template <std::size_t I, typename R, typename ...Args, typename F>
+inline auto const default_concept_map<detail::Invocable<I, R(Args...) const noexcept>, F> = dyno::make_concept_map(
+  detail::call_name_t<I>{} = [](F const& f, Args ...args) -> R {
+    return detail::invoke_function<R>(f, std::forward<Args>(args)...);
+  }
+);
+
+template <typename F>
+inline auto const default_concept_map<detail::NullableFunction, F> = dyno::make_concept_map(
+  "empty"_s = []() { return std::is_same<F, detail::empty_function>::value; }
+);
+
+// Concept satisfied by function objects that can be called with each of the
+// given signatures.
+//
+// Each signature is of the form `R(Args...)`, optionally followed by `const`
+// and/or `noexcept`. The function object is invoked as a non-const lvalue
+// unless the signature is `const`, in which case it is invoked as a const
+// lvalue. The `I`-th signature is represented by a clause named "callI",
+// which can be used to dispatch to it through a `dyno::poly`.
+template <typename ...Signatures>
+struct Callable
+  : detail::make_callable<std::index_sequence_for<Signatures...>, Signatures...>::type
+{ };
+
+namespace detail {
+  // Base class providing the call operator of a function wrapper for the
+  // `I`-th signature. The wrapper must provide a `call_(name, args...)`
+  // function calling the clause with the given name.
+  template <typename Derived, std::size_t I, typename Signature>
+  struct function_call;
+
+  template <typename Derived, std::size_t I, typename R, typename ...Args>
+  struct function_call<Derived, I, R(Args...)> {
+    R operator()(Args ...args) {
+      return static_cast<Derived&>(*this).call_(detail::call_name_t<I>{}, std::forward<Args>(args)...);
+    }
+  };
+
+  template <typename Derived, std::size_t I, typename R, typename ...Args>
+  struct function_call<Derived, I, R(Args...) const> {
+    R operator()(Args ...args) const {
+      return static_cast<Derived const&>(*this).call_(detail::call_name_t<I>{}, std::forward<Args>(args)...);
+    }
+  };
+
+  template <typename Derived, std::size_t I, typename R, typename ...Args>
+  struct function_call<Derived, I, R(Args...) noexcept> {
+    R operator()(Args ...args) noexcept {
+      return static_cast<Derived&>(*this).call_(detail::call_name_t<I>{}, std::forward<Args>(args)...);
+    }
+  };
+
+  template <typename Derived, std::size_t I, typename R, typename ...Args>
+  struct function_call<Derived, I, R(Args...) const noexcept> {
+    R operator()(Args ...args) const noexcept {
+      return static_cast<Derived const&>(*this).call_(detail::call_name_t<I>{}, std::forward<Args>(args)...);
+    }
+  };
+
+  template <typename Derived, typename Indices, typename ...Signatures>
+  struct function_calls;
+
+  template <typename Derived, std::size_t ...I, typename ...Signatures>
+  struct function_calls<Derived, std::index_sequence<I...>, Signatures...>
+    : detail::function_call<Derived, I, Signatures>...
+  {
+    using detail::function_call<Derived, I, Signatures>::operator()...;
+  };
+
+  // The function pointers used to call the function object are stored
+  // directly inside the wrapper, so that calling it only requires a single
+  // indirection. The rest of the vtable (used for copying, moving, etc..)
+  // is stored remotely.
+  template <typename Indices>
+  struct function_vtable;
+
+  template <std::size_t ...I>
+  struct function_vtable<std::index_sequence<I...>> {
+    using type = dyno::vtable<
+      dyno::local<dyno::only<detail::call_name_t<I>...>>,
+      dyno::remote<dyno::everything_else>
+    >;
+  };
+
+  template <bool Copyable>
+  struct function_copy_control { };
+
+  template <>
+  struct function_copy_control<false> {
+    function_copy_control() = default;
+    function_copy_control(function_copy_control const&) = delete;
+    function_copy_control(function_copy_control&&) = default;
+    function_copy_control& operator=(function_copy_control const&) = delete;
+    function_copy_control& operator=(function_copy_control&&) = default;
+  };
+
+  template <typename Concept>
+  constexpr bool is_copyable_concept = decltype(
+    boost::hana::contains(dyno::clause_names(Concept{}), "copy-construct"_s)
+  )::value;
+} // end namespace detail
+
+// Polymorphic function wrapper similar to `std::function`, but customizable
+// in the usual Dyno ways.
+//
+// `basic_function` holds an arbitrary function object that can be called
+// with each of the provided `Signatures`. Each signature results in an
+// overload of the call operator, so that `basic_function<..., int(int),
+// void(std::string) const>` can be called both as `f(1)` and as `f("abc")`
+// (the latter also on a const `basic_function`). A signature marked `noexcept`
+// produces a `noexcept` call operator, and the wrapper can then only be
+// constructed from function objects whose invocation is `noexcept`.
+//
+// Different aspects of `basic_function` can be customized:
+//  `ObjectConcept`
+//    The concept that the held function object must satisfy in addition to
+//    being callable. This is usually `dyno::CopyConstructible` for a copyable
+//    wrapper, or `dyno::MoveConstructible` for a move-only wrapper. The
+//    wrapper is copyable if and only if this concept has a "copy-construct"
+//    clause.
+//
+//  `Storage`
+//    The storage policy used to hold the function object. For example,
+//    `dyno::sbo_storage<Size>` provides a small buffer of `Size` bytes, and
+//    `dyno::local_storage<Size>` never allocates.
+//
+// The function pointers used for calling the function object are always
+// stored inside the wrapper itself, so a call costs a single indirection.
+//
+// A default-constructed `basic_function` is in the null state, as is one
+// constructed from a null function pointer or a null pointer to member.
+// Calling a function wrapper in the null state throws `std::bad_function_call`
+// (and hence terminates the program if the signature is `noexcept`).
+template <typename ObjectConcept, typename Storage, typename ...Signatures>
+class basic_function
+  : public detail::function_calls<
+      basic_function<ObjectConcept, Storage, Signatures...>,
+      std::index_sequence_for<Signatures...>,
+      Signatures...
+    >
+  , private detail::function_copy_control<detail::is_copyable_concept<ObjectConcept>>
+{
+  static_assert(sizeof...(Signatures) > 0,
+    "dyno::basic_function: At least one signature must be provided.");
+
+  template <typename, std::size_t, typename>
+  friend struct detail::function_call;
+
+  using Concept = decltype(dyno::requires_(
+    ObjectConcept{},
+    dyno::Callable<Signatures...>{},
+    detail::NullableFunction{}
+  ));
+  using VTable = typename detail::function_vtable<std::index_sequence_for<Signatures...>>::type;
+  using Poly = dyno::poly<Concept, Storage, VTable>;
+
+  template <typename F>
+  static Poly make_poly(F&& f) {
+    using RawF = std::remove_cv_t<std::remove_reference_t<F>>;
+    if constexpr (std::is_pointer<RawF>{} || std::is_member_pointer<RawF>{}) {
+      if (f == nullptr)
+        return Poly{detail::empty_function{}};
+    }
+    return Poly{std::forward<F>(f)};
+  }
+
+  template <typename Name, typename ...Args>
+  decltype(auto) call_(Name name, Args&& ...args)
+  { return poly_.virtual_(name)(poly_, std::forward<Args>(args)...); }
+
+  template <typename Name, typename ...Args>
+  decltype(auto) call_(Name name, Args&& ...args) const
+  { return poly_.virtual_(name)(poly_, std::forward<Args>(args)...); }
+
+  Poly poly_;
+
+public:
+  basic_function() : poly_{detail::empty_function{}} { }
+  basic_function(std::nullptr_t) : basic_function{} { }
+
+  template <typename F = typename detail::first_plain_signature<Signatures...>::type,
+            typename RawF = std::decay_t<F>,
+    typename = std::enable_if_t<std::conjunction<
+      std::negation<std::is_same<RawF, basic_function>>,
+      typename detail::function_signature<Signatures>::template is_invocable<RawF>...,
+      std::is_constructible<Poly, F>
+    >::value>
+  >
+  basic_function(F&& f) : poly_{make_poly(std::forward<F>(f))} { }
+
+  basic_function(basic_function const&) = default;
+  basic_function(basic_function&&) = default;
+  basic_function& operator=(basic_function const&) = default;
+  basic_function& operator=(basic_function&&) = default;
+
+  basic_function& operator=(std::nullptr_t) {
+    basic_function{}.swap(*this);
+    return *this;
+  }
+
+  template <typename F, typename = std::enable_if_t<
+    !std::is_same<std::decay_t<F>, basic_function>{} &&
+    std::is_constructible<basic_function, F>{}
+  >>
+  basic_function& operator=(F&& f) {
+    basic_function{std::forward<F>(f)}.swap(*this);
+    return *this;
+  }
+
+  void swap(basic_function& other) { poly_.swap(other.poly_); }
+  friend void swap(basic_function& a, basic_function& b) { a.swap(b); }
+
+  explicit operator bool() const { return !poly_.virtual_("empty"_s)(); }
+
+  friend bool operator==(basic_function const& f, std::nullptr_t) { return !f; }
+  friend bool operator==(std::nullptr_t, basic_function const& f) { return !f; }
+  friend bool operator!=(basic_function const& f, std::nullptr_t) { return !!f; }
+  friend bool operator!=(std::nullptr_t, basic_function const& f) { return !!f; }
+};
+
+// Copyable function wrapper storing small function objects (up to 16 bytes)
+// inline, and larger ones on the heap.
+template <typename ...Signatures>
+using any_function = dyno::basic_function<
+  dyno::CopyConstructible, dyno::sbo_storage<16>, Signatures...
+>;
+
+// Move-only function wrapper storing small function objects (up to 16 bytes)
+// inline, and larger ones on the heap. This can hold function objects that
+// are not copyable.
+template <typename ...Signatures>
+using unique_function = dyno::basic_function<
+  dyno::MoveConstructible, dyno::sbo_storage<16>, Signatures...
+>;
+
+// Copyable function wrapper that never allocates. Trying to construct it from
+// a function object that does not fit in `Size` bytes is a compile-time error.
+template <std::size_t Size, typename ...Signatures>
+using inplace_function = dyno::basic_function<
+  dyno::CopyConstructible, dyno::local_storage<Size>, Signatures...
+>;
+
+// Non-owning reference to a function object that can be called with each of
+// the given `Signatures`.
+//
+// `function_ref` is meant to be used as a function parameter; it does not
+// copy the function object it is constructed from, and it does not manage
+// its lifetime. The referenced function object must outlive the
+// `function_ref`, otherwise the behavior is undefined. A `function_ref` is
+// always bound to a function object (there is no null state), and it can only
+// refer to a const function object if all of its signatures are `const`.
+// Functions (as opposed to function objects) can't be referred to directly;
+// wrap them in a lambda instead.
+template <typename ...Signatures>
+class function_ref
+  : public detail::function_calls<
+      function_ref<Signatures...>,
+      std::index_sequence_for<Signatures...>,
+      Signatures...
+    >
+{
+  static_assert(sizeof...(Signatures) > 0,
+    "dyno::function_ref: At least one signature must be provided.");
+
+  template <typename, std::size_t, typename>
+  friend struct detail::function_call;
+
+  // Since the function object is never copied nor destroyed, a `dyno::poly`
+  // is not needed. Only the functions used to call it are stored, along
+  // with a pointer to it.
+  using Concept = dyno::Callable<Signatures...>;
+  using VTable = typename dyno::vtable<dyno::local<dyno::everything>>::template apply<Concept>;
+
+  template <typename Name, typename ...Args>
+  decltype(auto) call_(Name name, Args&& ...args) const
+  { return vtable_[name](object_, std::forward<Args>(args)...); }
+
+  VTable vtable_;
+  void* object_;
+
+public:
+  template <typename F, typename Referenced = std::remove_reference_t<F>,
+                        typename RawF = std::remove_cv_t<Referenced>,
+    typename = std::enable_if_t<
+      !std::is_same<RawF, function_ref>{} && std::is_object<RawF>{} &&
+      (!std::is_const<Referenced>{} || (detail::is_const_signature<Signatures>::value && ...)) &&
+      (detail::function_signature<Signatures>::template is_invocable<Referenced>::value && ...)
+    >
+  >
+  function_ref(F&& f)
+    : vtable_{dyno::complete_concept_map<Concept, RawF>(dyno::concept_map<Concept, RawF>)}
+    // If `f` is const, all the signatures are const too, so the function
+    // object is never accessed through a non-const path.
+    , object_{const_cast<RawF*>(std::addressof(static_cast<Referenced&>(f)))}
+  { }
+
+  function_ref(function_ref const&) = default;
+  function_ref& operator=(function_ref const&) = default;
+};
+
+} // end namespace dyno
+
+#endif // DYNO_FUNCTION_HPP
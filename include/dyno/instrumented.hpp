@@ -0,0 +1,447 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_INSTRUMENTED_HPP
+#define DYNO_INSTRUMENTED_HPP
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/vtable.hpp>
+
+#include <boost/hana/basic_tuple.hpp>
+#include <boost/hana/string.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <ostream>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+
+namespace dyno {
+
+// Number of buckets in the latency histograms. Bucket `i` counts the calls
+// that took between `2^i` and `2^(i+1)` nanoseconds (the first bucket also
+// counts calls that took less than a nanosecond).
+constexpr std::size_t latency_buckets = 32;
+
+// Statistics about the calls made to a function of a concept, for a given
+// model of that concept. See `dyno::instrumented`.
+//
+// The names of the concept and of the model are the ones returned by
+// `std::type_info::name()`, and are hence implementation-defined.
+struct call_statistics {
+  char const* concept_name;
+  char const* model_name;
+  char const* function_name;
+  std::uint64_t calls;
+  std::uint64_t samples; // number of calls whose latency was measured
+  std::array<std::uint64_t, latency_buckets> latency;
+};
+
+namespace detail {
+  struct call_record {
+    std::type_info const* concept_;
+    std::type_info const* model;
+    char const* function;
+    std::size_t id;
+    std::atomic<std::uint64_t> calls{0}; // calls made by threads that exited
+    std::array<std::atomic<std::uint64_t>, latency_buckets> latency{};
+    call_record* next = nullptr;
+  };
+
+  // Intrusive list of all the call records of the program. Records are only
+  // ever added to that list, never removed, so it can be traversed without
+  // taking a lock.
+  inline std::atomic<call_record*> call_records{nullptr};
+  inline std::atomic<std::size_t> next_call_record_id{0};
+
+  inline void register_call_record(call_record* record) {
+    record->id = next_call_record_id.fetch_add(1, std::memory_order_relaxed);
+    record->next = call_records.load(std::memory_order_relaxed);
+    while (!call_records.compare_exchange_weak(record->next, record,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed))
+      ;
+  }
+
+  // Call counters of a single thread, indexed by the id of call records.
+  //
+  // Only the owning thread ever modifies its counters, which makes it possible
+  // to increment them without a read-modify-write operation. The counters are
+  // allocated in chunks, on demand. They are merged into the call records
+  // when the thread exits.
+  struct thread_call_counters {
+    static constexpr std::size_t chunk_size = 256;
+    static constexpr std::size_t max_chunks = 256;
+
+    std::array<std::atomic<std::atomic<std::uint64_t>*>, max_chunks> chunks{};
+    thread_call_counters* next = nullptr;
+    thread_call_counters* prev = nullptr;
+
+    thread_call_counters();
+    ~thread_call_counters();
+
+    // Returns the counter for the given call record, or a null pointer if
+    // there are too many call records to use per-thread counters.
+    std::atomic<std::uint64_t>* counter(call_record const& record) {
+      std::size_t chunk = record.id / chunk_size;
+      if (chunk >= max_chunks)
+        return nullptr;
+      std::atomic<std::uint64_t>* counters = chunks[chunk].load(std::memory_order_relaxed);
+      if (counters == nullptr) {
+        counters = new std::atomic<std::uint64_t>[chunk_size]();
+        chunks[chunk].store(counters, std::memory_order_release);
+      }
+      return &counters[record.id % chunk_size];
+    }
+
+    std::uint64_t count(call_record const& record) const {
+      std::size_t chunk = record.id / chunk_size;
+      if (chunk >= max_chunks)
+        return 0;
+      std::atomic<std::uint64_t> const* counters = chunks[chunk].load(std::memory_order_acquire);
+      return counters ? counters[record.id % chunk_size].load(std::memory_order_relaxed) : 0;
+    }
+  };
+
+  // Protects the list of per-thread counters. Both are constant-initialized.
+  inline std::mutex thread_call_counters_mutex{};
+  inline thread_call_counters* thread_call_counters_list = nullptr;
+
+  inline thread_call_counters::thread_call_counters() {
+    std::lock_guard<std::mutex> lock{thread_call_counters_mutex};
+    next = thread_call_counters_list;
+    if (next)
+      next->prev = this;
+    thread_call_counters_list = this;
+  }
+
+  inline thread_call_counters::~thread_call_counters() {
+    std::lock_guard<std::mutex> lock{thread_call_counters_mutex};
+    call_record* record = call_records.load(std::memory_order_acquire);
+    for (; record != nullptr; record = record->next)
+      record->calls.fetch_add(count(*record), std::memory_order_relaxed);
+
+    (prev ? prev->next : thread_call_counters_list) = next;
+    if (next)
+      next->prev = prev;
+    for (auto& chunk : chunks)
+      delete[] chunk.load(std::memory_order_relaxed);
+  }
+
+  // Counts a call to the function of the given call record, and returns the
+  // number of calls to that function made by the current thread before.
+  inline std::uint64_t count_call(call_record& record) {
+    thread_local thread_call_counters counters;
+    if (std::atomic<std::uint64_t>* counter = counters.counter(record)) {
+      std::uint64_t n = counter->load(std::memory_order_relaxed);
+      counter->store(n + 1, std::memory_order_relaxed);
+      return n;
+    }
+    return record.calls.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // `dyno::poly` adds some builtin concepts to the concept it is given, so
+  // we report the first refined concept when there is one, since that's
+  // the concept users know about.
+  template <typename Concept>
+  struct reported_concept { using type = Concept; };
+
+  template <typename First, typename ...Rest>
+  struct reported_concept<dyno::concept_<First, Rest...>> {
+    using type = std::conditional_t<
+      std::is_base_of<detail::concept_base, First>::value,
+      First, dyno::concept_<First, Rest...>
+    >;
+  };
+
+  template <typename ConceptMap>
+  struct concept_map_model { using type = void; };
+
+  template <typename Concept, typename T, typename ...Mappings>
+  struct concept_map_model<dyno::concept_map_t<Concept, T, Mappings...>> {
+    using type = T;
+  };
+
+  // Holds one call record for each function of `Concept`, for the model
+  // whose concept map is `ConceptMap`.
+  template <typename Concept, typename ConceptMap,
+            typename Names = decltype(dyno::clause_names(Concept{}))>
+  struct call_record_block;
+
+  template <typename Concept, typename ConceptMap, typename ...Names>
+  struct call_record_block<Concept, ConceptMap, boost::hana::basic_tuple<Names...>> {
+    std::array<call_record, sizeof...(Names)> records;
+
+    call_record_block() {
+      using Model = typename concept_map_model<ConceptMap>::type;
+      char const* names[] = {boost::hana::to<char const*>(Names{})..., nullptr};
+      for (std::size_t i = 0; i != sizeof...(Names); ++i) {
+        records[i].concept_ = &typeid(typename reported_concept<Concept>::type);
+        records[i].model = &typeid(Model);
+        records[i].function = names[i];
+        detail::register_call_record(&records[i]);
+      }
+    }
+
+    static call_record* get() {
+      static call_record_block block;
+      return block.records.data();
+    }
+  };
+
+  inline std::size_t latency_bucket(std::chrono::nanoseconds latency) {
+    std::uint64_t ns = static_cast<std::uint64_t>(std::max(latency.count(), decltype(latency.count()){1}));
+    std::size_t bucket = 0;
+    while (ns >>= 1)
+      ++bucket;
+    return std::min(bucket, latency_buckets - 1);
+  }
+
+  // Records the time elapsed between its construction and its destruction
+  // in the latency histogram of a call record.
+  struct latency_sample {
+    explicit latency_sample(call_record* record)
+      : record_{record}, start_{std::chrono::steady_clock::now()}
+    { }
+
+    ~latency_sample() {
+      auto latency = std::chrono::steady_clock::now() - start_;
+      record_->latency[detail::latency_bucket(latency)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    latency_sample(latency_sample const&) = delete;
+    latency_sample& operator=(latency_sample const&) = delete;
+
+  private:
+    call_record* record_;
+    std::chrono::steady_clock::time_point start_;
+  };
+
+  // Function object returned by `instrumented_vtable::operator[]`. It updates
+  // the call record of the function before calling it.
+  template <typename Function, std::size_t SampleEvery>
+  struct instrumented_function {
+    Function function;
+    call_record* record;
+
+    template <typename ...Args>
+    decltype(auto) operator()(Args&& ...args) const {
+      std::uint64_t n = detail::count_call(*record);
+      if constexpr (SampleEvery != 0) {
+        if (n % SampleEvery == 0) {
+          detail::latency_sample sample{record};
+          return function(std::forward<Args>(args)...);
+        }
+      }
+      (void)n;
+      return function(std::forward<Args>(args)...);
+    }
+  };
+} // end namespace detail
+
+// Class implementing a vtable that records statistics about the calls made
+// through another vtable.
+//
+// Every function returned by `operator[]` is wrapped so that calling it
+// increments a counter specific to the concept, the function and the model
+// of the concept. When `SampleEvery` is not zero, the latency of one call
+// out of `SampleEvery` is also recorded in a histogram. Unlike the counters,
+// latency histograms are not per-thread: a single histogram of atomic
+// buckets is shared by all threads, since sampled calls are rare enough for
+// the contention not to matter next to the cost of reading the clock. Note
+// that functions called by the library itself (e.g. to copy the object held
+// in a storage) are counted too.
+template <typename VTable, typename Concept, std::size_t SampleEvery>
+struct instrumented_vtable {
+  template <typename ConceptMap>
+  explicit instrumented_vtable(ConceptMap map)
+    : vtable_{map}
+    , records_{detail::call_record_block<Concept, ConceptMap>::get()}
+  { }
+
+  // Only identical vtables are supported, since the statistics of a model
+  // are specific to the concept they were collected for.
+  template <typename OtherVTable>
+  instrumented_vtable(dyno::from_vtable_t, OtherVTable const& other)
+    : vtable_{instrumented_vtable::check_same(other).vtable_}
+    , records_{other.records_}
+  { }
+
+  template <typename Name>
+  constexpr auto contains(Name name) const {
+    return vtable_.contains(name);
+  }
+
+  template <typename Name>
+  constexpr auto operator[](Name name) const {
+    using Function = decltype(vtable_[name]);
+    constexpr std::size_t index = detail::clause_index<Name, decltype(dyno::clauses(Concept{}))>::value;
+    return detail::instrumented_function<Function, SampleEvery>{
+      vtable_[name], &records_[index]
+    };
+  }
+
+  template <typename ConceptMap, typename = std::enable_if_t<
+    detail::can_identify_concept_map<VTable, ConceptMap>::value
+  >>
+  bool created_from(ConceptMap map) const {
+    return vtable_.created_from(map);
+  }
+
+  friend void swap(instrumented_vtable& a, instrumented_vtable& b) {
+    using std::swap;
+    swap(a.vtable_, b.vtable_);
+    swap(a.records_, b.records_);
+  }
+
+private:
+  template <typename, typename, std::size_t>
+  friend struct instrumented_vtable;
+
+  VTable vtable_;
+  detail::call_record* records_;
+
+  template <typename OtherVTable>
+  static constexpr OtherVTable const& check_same(OtherVTable const& other) {
+    static_assert(std::is_same<OtherVTable, instrumented_vtable>::value,
+      "dyno::instrumented_vtable: Trying to construct an instrumented vtable "
+      "from a vtable of a different type. This is not supported, since the "
+      "statistics collected by an instrumented vtable are specific to the "
+      "concept it was created for.");
+    return other;
+  }
+};
+
+// Vtable policy collecting statistics about the calls made through the vtable
+// generated by another vtable policy.
+//
+// This can be used to find out which functions of which models dominate the
+// calls made through type-erased objects, for example:
+// ```
+// using Shape = dyno::poly<Drawable, dyno::remote_storage,
+//                          dyno::instrumented<dyno::vtable<dyno::remote<dyno::everything>>>>;
+// // ... use Shape ...
+// dyno::dump_call_statistics(std::cerr);
+// ```
+//
+// Calls are counted in per-thread counters, so counting is cheap and doesn't
+// cause contention between threads. When `SampleEvery` is not zero, the latency
+// of one call out of `SampleEvery` (in each thread) is also measured using
+// `std::chrono::steady_clock`, which is much more expensive. When the
+// `DYNO_NO_INSTRUMENTATION` macro is defined, this is exactly equivalent to
+// `Policy`, so instrumentation can be compiled out of release builds without
+// changing any code.
+template <typename Policy = dyno::vtable<dyno::remote<dyno::everything>>,
+          std::size_t SampleEvery = 0>
+struct instrumented {
+#if defined(DYNO_NO_INSTRUMENTATION)
+  template <typename Concept>
+  using apply = typename Policy::template apply<Concept>;
+#else
+  template <typename Concept>
+  using apply = dyno::instrumented_vtable<
+    typename Policy::template apply<Concept>, Concept, SampleEvery
+  >;
+#endif
+};
+
+// Returns the statistics collected so far by all the instrumented vtables of
+// the program, in an unspecified order. This can be called concurrently with
+// calls made through instrumented vtables, in which case the counters are
+// read in an unspecified order.
+inline std::vector<dyno::call_statistics> call_statistics_snapshot() {
+  std::vector<dyno::call_statistics> result;
+  std::lock_guard<std::mutex> lock{detail::thread_call_counters_mutex};
+  detail::call_record const* record = detail::call_records.load(std::memory_order_acquire);
+  for (; record != nullptr; record = record->next) {
+    dyno::call_statistics stats{};
+    stats.concept_name = record->concept_->name();
+    stats.model_name = record->model->name();
+    stats.function_name = record->function;
+    stats.calls = record->calls.load(std::memory_order_relaxed);
+    auto* counters = detail::thread_call_counters_list;
+    for (; counters != nullptr; counters = counters->next)
+      stats.calls += counters->count(*record);
+    for (std::size_t i = 0; i != latency_buckets; ++i) {
+      stats.latency[i] = record->latency[i].load(std::memory_order_relaxed);
+      stats.samples += stats.latency[i];
+    }
+    result.push_back(stats);
+  }
+  return result;
+}
+
+// Writes the statistics of all the functions that were called at least once
+// to the given stream, starting with the most called functions.
+inline void dump_call_statistics(std::ostream& out) {
+  std::vector<dyno::call_statistics> stats = dyno::call_statistics_snapshot();
+  std::sort(stats.begin(), stats.end(), [](auto const& a, auto const& b) {
+    return a.calls > b.calls;
+  });
+  for (dyno::call_statistics const& s : stats) {
+    if (s.calls == 0)
+      continue;
+    out << s.concept_name << ' ' << s.model_name << ' ' << s.function_name
+        << ": " << s.calls << " calls";
+    if (s.samples != 0) {
+      out << ", latency histogram (" << s.samples << " samples):";
+      for (std::size_t i = 0; i != latency_buckets; ++i) {
+        if (s.latency[i] != 0)
+          out << " [" << (std::uint64_t{1} << i) << "ns: " << s.latency[i] << ']';
+      }
+    }
+    out << '\n';
+  }
+}
+
+// Writes the call frequencies collected so far for the functions of `Concept`
+// as a `dyno::profile` named `name`, in a form that can be saved to a header
+// and included in a later build to lay out vtables with `dyno::profiled`.
+//
+// The calls made to each function are summed over all the models of the
+// concept. Only functions that were called at least once are included in the
+// profile, by decreasing number of calls.
+template <typename Concept>
+void write_profile(std::ostream& out, char const* name) {
+  std::vector<std::pair<char const*, std::uint64_t>> functions;
+  for (dyno::call_statistics const& s : dyno::call_statistics_snapshot()) {
+    if (s.calls == 0 || std::strcmp(s.concept_name, typeid(Concept).name()) != 0)
+      continue;
+    auto it = std::find_if(functions.begin(), functions.end(), [&](auto const& f) {
+      return std::strcmp(f.first, s.function_name) == 0;
+    });
+    if (it == functions.end())
+      functions.emplace_back(s.function_name, s.calls);
+    else
+      it->second += s.calls;
+  }
+  std::stable_sort(functions.begin(), functions.end(), [](auto const& a, auto const& b) {
+    return a.second > b.second;
+  });
+
+  out << "struct " << name << " : dyno::profile<\n";
+  for (std::size_t i = 0; i != functions.size(); ++i) {
+    out << "  dyno::profile_entry<dyno::detail::string<";
+    for (char const* c = functions[i].first; *c != '\0'; ++c)
+      out << (c == functions[i].first ? "" : ", ") << static_cast<int>(*c);
+    out << ">, " << functions[i].second << ">"
+        << (i + 1 == functions.size() ? "" : ",")
+        << " // " << functions[i].first << '\n';
+  }
+  out << "> { };\n";
+}
+
+} // end namespace dyno
+
+#endif // DYNO_INSTRUMENTED_HPP
@@ -0,0 +1,338 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_MULTIMETHOD_HPP
+#define DYNO_MULTIMETHOD_HPP
+
+#include <dyno/concept.hpp>
+#include <dyno/detail/dsl.hpp>
+#include <dyno/detail/empty_object.hpp>
+#include <dyno/detail/erase_function.hpp>
+#include <dyno/detail/erase_signature.hpp>
+#include <dyno/detail/is_placeholder.hpp>
+
+#include <boost/callable_traits/function_type.hpp>
+#include <boost/callable_traits/return_type.hpp>
+#include <boost/hana/basic_tuple.hpp>
+#include <boost/hana/bool.hpp>
+#include <boost/hana/contains.hpp>
+#include <boost/hana/filter.hpp>
+#include <boost/hana/first.hpp>
+#include <boost/hana/front.hpp>
+#include <boost/hana/map.hpp>
+#include <boost/hana/pair.hpp>
+#include <boost/hana/second.hpp>
+#include <boost/hana/transform.hpp>
+#include <boost/hana/type.hpp>
+#include <boost/hana/unpack.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace dyno {
+
+// Exception thrown when calling a multimethod with a combination of types for
+// which no implementation was defined, when no fallback was defined either.
+struct bad_multimethod_call : std::exception {
+  char const* what() const noexcept override {
+    return "dyno::bad_multimethod_call";
+  }
+};
+
+namespace detail {
+  template <typename T>
+  struct is_multimethod : std::false_type { };
+
+  template <typename Signature>
+  struct is_multimethod<dyno::multimethod_t<Signature>> : std::true_type { };
+
+  // Returns a tuple containing a reference to `arg` if `Keep` is true, and
+  // an empty tuple otherwise. This is used with `std::tuple_cat` to filter
+  // arguments based on whether they are placeholders.
+  template <bool Keep, typename Arg>
+  constexpr auto keep_if(Arg&& arg) {
+    if constexpr (Keep)
+      return std::forward_as_tuple(std::forward<Arg>(arg));
+    else
+      return std::tuple<>{};
+  }
+
+  // Metafunction returning a `std::tuple` of the model types used at the
+  // positions of the placeholders of `Signature` in `ActualSignature`.
+  template <typename Signature, typename ActualSignature>
+  struct multimethod_models;
+
+  template <typename R, typename ...Args, typename R_ac, typename ...Args_ac>
+  struct multimethod_models<R(Args...), R_ac(Args_ac...)> {
+    static_assert(sizeof...(Args) == sizeof...(Args_ac),
+      "dyno::define_multimethod: The function provided as the implementation "
+      "of a multimethod must have the same number of parameters as specified "
+      "in the signature of the multimethod.");
+
+    using type = decltype(std::tuple_cat(std::declval<
+      std::conditional_t<detail::is_placeholder<Args>::value,
+        std::tuple<std::remove_cv_t<std::remove_pointer_t<std::remove_reference_t<Args_ac>>>>,
+        std::tuple<>
+      >
+    >()...));
+  };
+
+  // Function object used as the fallback of a multimethod when none was
+  // provided by the user.
+  template <typename R>
+  struct throw_bad_multimethod_call {
+    template <typename ...Args>
+    R operator()(Args&& ...) const { throw dyno::bad_multimethod_call{}; }
+  };
+
+  // Function stored in the dispatch table of a multimethod for combinations
+  // of types without an implementation. It calls the fallback function object
+  // `F` with the arguments that are not placeholders.
+  template <typename F, typename Signature,
+            typename Erased = typename detail::erase_signature<Signature>::type>
+  struct multimethod_fallback;
+
+  template <typename F, typename R, typename ...Args, typename ...Erased>
+  struct multimethod_fallback<F, R(Args...), R(Erased...)> {
+    static R apply(Erased ...args) {
+      return std::apply(detail::empty_object<F>::get(), std::tuple_cat(
+        detail::keep_if<!detail::is_placeholder<Args>::value>(std::forward<Erased>(args))...
+      ));
+    }
+  };
+
+  // Returns the concept declaring the clause named `Name` among `Concept` and
+  // the concepts it refines, as a `boost::hana::basic_type`.
+  template <typename Name, typename Concept>
+  constexpr auto declaring_concept(Concept c) {
+    constexpr bool declared_here = decltype(boost::hana::contains(
+      boost::hana::transform(detail::direct_clauses(c), boost::hana::first), Name{}
+    ))::value;
+    if constexpr (declared_here) {
+      return boost::hana::basic_type<Concept>{};
+    } else {
+      auto declaring = boost::hana::filter(dyno::refined_concepts(c), [](auto base) {
+        return boost::hana::bool_c<detail::has_clause<decltype(base), Name>>;
+      });
+      return detail::declaring_concept<Name>(boost::hana::front(declaring));
+    }
+  }
+
+  template <typename Concept, typename Name>
+  using declaring_concept_t = typename decltype(detail::declaring_concept<Name>(Concept{}))::type;
+
+  // Class holding the dispatch table of the multimethod with the given
+  // `Name` and `Signature`, declared in `Concept`.
+  //
+  // Each model of a concept containing the multimethod is assigned a dense
+  // index (starting at 0) the first time it is needed, and the implementation
+  // for a pair of models is found at the intersection of their indices in a
+  // square table. Looking up an implementation is thus O(1), and it does not
+  // require taking a lock. When the table needs to grow, a new (larger) table
+  // is created and published atomically. Old tables are kept alive, since
+  // another thread could still be looking into them.
+  //
+  // Multimethods with the same name and signature declared in different
+  // concepts have different dispatch tables. A multimethod declared in a
+  // concept and called through a refining concept uses the same table.
+  template <typename Concept, typename Name, typename Signature>
+  class multimethod_table {
+    using Erased = typename detail::erase_signature<Signature>::type;
+    using Result = boost::callable_traits::return_type_t<Signature>;
+
+    static_assert(!detail::is_placeholder<Result>::value,
+      "dyno::multimethod: The return type of a multimethod can't be a placeholder.");
+
+    struct table {
+      table(std::size_t n, Erased* fallback, std::unique_ptr<table> previous)
+        : size{n}, cells{new std::atomic<Erased*>[n * n]}, previous{std::move(previous)}
+      {
+        for (std::size_t i = 0; i != n * n; ++i)
+          cells[i].store(fallback, std::memory_order_relaxed);
+      }
+
+      std::size_t size;
+      std::unique_ptr<std::atomic<Erased*>[]> cells;
+      std::unique_ptr<table> previous;
+    };
+
+    // All the members are constant-initialized, so that the table can be
+    // used during static initialization without a function-local static.
+    std::atomic<table const*> current_{nullptr};
+    std::atomic<Erased*> fallback_{&detail::multimethod_fallback<
+      detail::throw_bad_multimethod_call<Result>, Signature
+    >::apply};
+    std::mutex mutex_{}; // serializes modifications of the table
+    std::unique_ptr<table> latest_{};
+    std::atomic<std::size_t> next_index_{0};
+
+  public:
+    constexpr multimethod_table() = default;
+
+    static multimethod_table& instance();
+
+    // Returns the index of the given model in the dispatch table.
+    template <typename T>
+    static std::size_t index() {
+      static std::size_t const i = instance().next_index_++;
+      return i;
+    }
+
+    Erased* lookup(std::size_t i, std::size_t j) const {
+      table const* t = current_.load(std::memory_order_acquire);
+      if (t != nullptr && i < t->size && j < t->size)
+        return t->cells[i * t->size + j].load(std::memory_order_relaxed);
+      return fallback_.load(std::memory_order_relaxed);
+    }
+
+    void define(std::size_t i, std::size_t j, Erased* f) {
+      std::lock_guard<std::mutex> lock{mutex_};
+      std::size_t size = latest_ ? latest_->size : 0;
+      if (i >= size || j >= size) {
+        // Grow geometrically so that defining N^2 implementations only
+        // creates O(log N) tables.
+        std::size_t n = std::max({2 * size, i + 1, j + 1});
+        auto bigger = std::make_unique<table>(n, fallback_.load(), std::move(latest_));
+        table const& old = *bigger->previous;
+        for (std::size_t r = 0; size != 0 && r != size; ++r)
+          for (std::size_t c = 0; c != size; ++c)
+            bigger->cells[r * n + c].store(old.cells[r * size + c].load());
+        latest_ = std::move(bigger);
+      }
+      latest_->cells[i * latest_->size + j].store(f);
+      current_.store(latest_.get(), std::memory_order_release);
+    }
+
+    void define_fallback(Erased* f) {
+      std::lock_guard<std::mutex> lock{mutex_};
+      Erased* old = fallback_.exchange(f);
+      if (latest_) {
+        for (std::size_t i = 0; i != latest_->size * latest_->size; ++i) {
+          if (latest_->cells[i].load() == old)
+            latest_->cells[i].store(f);
+        }
+      }
+    }
+  };
+
+  template <typename Concept, typename Name, typename Signature>
+  inline multimethod_table<Concept, Name, Signature> multimethod_table_instance{};
+
+  template <typename Concept, typename Name, typename Signature>
+  multimethod_table<Concept, Name, Signature>& multimethod_table<Concept, Name, Signature>::instance()
+  { return multimethod_table_instance<Concept, Name, Signature>; }
+
+  template <typename Table, typename T>
+  struct multimethod_index {
+    std::size_t operator()() const { return Table::template index<T>(); }
+  };
+
+  // Returns a Hana map containing the entries of a concept map for the
+  // multimethods declared directly in `Concept`, for the model `T`. These
+  // entries are never provided by users.
+  template <typename Concept, typename T>
+  constexpr auto multimethod_concept_map() {
+    auto multimethods = boost::hana::filter(detail::direct_clauses(Concept{}), [](auto clause) {
+      using Clause = std::decay_t<decltype(boost::hana::second(clause))>;
+      return boost::hana::bool_c<detail::is_multimethod<Clause>::value>;
+    });
+    return boost::hana::unpack(multimethods, [](auto ...clause) {
+      return boost::hana::make_map(
+        boost::hana::make_pair(boost::hana::first(clause), detail::multimethod_index<
+          detail::multimethod_table<
+            Concept,
+            std::decay_t<decltype(boost::hana::first(clause))>,
+            typename std::decay_t<decltype(boost::hana::second(clause))>::signature
+          >,
+          T
+        >{})...
+      );
+    });
+  }
+
+  template <typename Concept, typename Name>
+  using multimethod_signature = typename decltype(Concept{}.get_signature(Name{}))::signature;
+} // end namespace detail
+
+// Defines the implementation of a multimethod for a combination of types.
+//
+// `Concept` must be a concept containing a multimethod clause with the given
+// `name`. `f` must be a stateless function object whose parameters match the
+// signature of the multimethod, except placeholders are replaced by the types
+// this implementation applies to. For example:
+// ```
+// struct Shape : decltype(dyno::requires_(
+//   "collide"_s = dyno::multimethod<bool (dyno::T const&, dyno::T const&)>
+// )) { };
+//
+// dyno::define_multimethod<Shape>("collide"_s, [](Circle const&, Square const&) {
+//   return ...;
+// });
+// ```
+//
+// Implementations can be defined at any time, typically at startup, and this
+// function is thread-safe. Calling a multimethod with a combination of types
+// for which no implementation was defined calls the fallback of the multimethod
+// (see `dyno::define_multimethod_fallback`).
+template <typename Concept, typename Name, typename F>
+void define_multimethod(Name, F f) {
+  static_assert(std::is_empty<F>{},
+    "dyno::define_multimethod: Only stateless function objects can be used "
+    "as the implementation of a multimethod.");
+  using Clause = decltype(Concept{}.get_signature(Name{}));
+  static_assert(detail::is_multimethod<Clause>::value,
+    "dyno::define_multimethod: The clause with this name in the concept is "
+    "not a multimethod. Make sure to use `dyno::multimethod<...>` when "
+    "declaring the clause in the concept.");
+  using Signature = typename Clause::signature;
+  using Models = typename detail::multimethod_models<
+    Signature, boost::callable_traits::function_type_t<F>
+  >::type;
+  static_assert(std::tuple_size<Models>::value == 2,
+    "dyno::define_multimethod: The signature of a multimethod must contain "
+    "exactly two placeholders.");
+
+  using Table = detail::multimethod_table<
+    detail::declaring_concept_t<Concept, Name>, Name, Signature
+  >;
+  Table::instance().define(
+    Table::template index<std::tuple_element_t<0, Models>>(),
+    Table::template index<std::tuple_element_t<1, Models>>(),
+    detail::erase_function<Signature>(f)
+  );
+}
+
+// Defines the fallback of a multimethod, which is called for combinations of
+// types that don't have an implementation.
+//
+// `f` must be a stateless function object callable with the arguments of the
+// multimethod that are not placeholders; e.g. `f` is called without arguments
+// for a multimethod with signature `bool (dyno::T const&, dyno::T const&)`.
+// When no fallback is defined, `dyno::bad_multimethod_call` is thrown.
+template <typename Concept, typename Name, typename F>
+void define_multimethod_fallback(Name, F) {
+  static_assert(std::is_empty<F>{},
+    "dyno::define_multimethod_fallback: Only stateless function objects can be "
+    "used as the fallback of a multimethod.");
+  using Signature = detail::multimethod_signature<Concept, Name>;
+  using Table = detail::multimethod_table<
+    detail::declaring_concept_t<Concept, Name>, Name, Signature
+  >;
+  Table::instance().define_fallback(
+    &detail::multimethod_fallback<F, Signature>::apply
+  );
+}
+
+} // end namespace dyno
+
+#endif // DYNO_MULTIMETHOD_HPP
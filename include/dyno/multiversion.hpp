@@ -0,0 +1,204 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_MULTIVERSION_HPP
+#define DYNO_MULTIVERSION_HPP
+
+#include <dyno/concept_map.hpp>
+#include <dyno/detail/empty_object.hpp>
+#include <dyno/detail/erase_function.hpp>
+#include <dyno/detail/erase_signature.hpp>
+#include <dyno/vtable.hpp>
+
+#include <boost/hana/basic_tuple.hpp>
+#include <boost/hana/pair.hpp>
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#  define DYNO_HAS_CPU_SUPPORTS
+#endif
+
+namespace dyno {
+
+// Instruction sets that implementations can be selected on with
+// `dyno::multiversion`.
+//
+// An instruction set is a type with a static `supported()` function returning
+// whether the CPU running the program supports it. Other instruction sets can
+// be defined the same way. The instruction sets defined here are never
+// supported on platforms other than x86, so the fallback implementation is
+// always used there.
+namespace isa {
+  struct sse4_2 {
+    static bool supported() {
+#if defined(DYNO_HAS_CPU_SUPPORTS)
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("sse4.2");
+#else
+      return false;
+#endif
+    }
+  };
+
+  struct avx2 {
+    static bool supported() {
+#if defined(DYNO_HAS_CPU_SUPPORTS)
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+#else
+      return false;
+#endif
+    }
+  };
+
+  struct avx512f {
+    static bool supported() {
+#if defined(DYNO_HAS_CPU_SUPPORTS)
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx512f");
+#else
+      return false;
+#endif
+    }
+  };
+} // end namespace isa
+
+// Function object holding several implementations of the same function, which
+// is created by `dyno::multiversion`.
+template <typename InstructionSets, typename Functions>
+struct multiversioned;
+
+template <typename ...InstructionSet, typename ...Function>
+struct multiversioned<boost::hana::basic_tuple<InstructionSet...>,
+                      boost::hana::basic_tuple<Function...>> {
+  // Returns the index of the implementation used on this CPU, which is the
+  // first one whose instruction set is supported, or the fallback. This is
+  // only computed once.
+  static std::size_t selected() {
+    static std::size_t const index = [] {
+      bool const supported[] = {InstructionSet::supported()..., true};
+      std::size_t i = 0;
+      while (!supported[i])
+        ++i;
+      return i;
+    }();
+    return index;
+  }
+};
+
+// Creates a function for a concept map with one implementation for each of
+// the given instruction sets, plus a fallback implementation used when the
+// CPU supports none of them.
+//
+// Implementations are tried in order, so the instruction sets should be
+// listed from the most to the least specific. When the function is stored in
+// a vtable, the implementation to use is selected when the vtable is created,
+// and the vtable points to it directly; calls don't check the CPU again. Since
+// such vtables can't be initialized at compile-time, the static vtable of a
+// model using `dyno::multiversion` is created the first time a `dyno::poly`
+// is created from that model, which costs a check of a guard variable.
+//
+// Each implementation must be a stateless function object, and is usually
+// compiled for its instruction set using compiler-specific attributes:
+// ```
+// template <typename T>
+// auto const dyno::concept_map<Kernel, T> = dyno::make_concept_map(
+//   "run"_s = dyno::multiversion<dyno::isa::avx512f, dyno::isa::avx2>(
+//     [](T const& self, float* data) { run_avx512(self, data); },
+//     [](T const& self, float* data) { run_avx2(self, data); },
+//     [](T const& self, float* data) { run_scalar(self, data); }
+//   )
+// );
+// ```
+template <typename ...InstructionSet, typename ...Function>
+constexpr auto multiversion(Function ...) {
+  static_assert(sizeof...(Function) == sizeof...(InstructionSet) + 1,
+    "dyno::multiversion: There must be one implementation for each instruction "
+    "set, followed by a fallback implementation.");
+  return dyno::multiversioned<boost::hana::basic_tuple<InstructionSet...>,
+                              boost::hana::basic_tuple<Function...>>{};
+}
+
+namespace detail {
+  template <typename Multiversioned, typename R, typename ...Args>
+  struct multiversioned_lambda;
+
+  template <typename ...InstructionSet, typename ...Function, typename R, typename ...Args>
+  struct multiversioned_lambda<
+    dyno::multiversioned<boost::hana::basic_tuple<InstructionSet...>,
+                         boost::hana::basic_tuple<Function...>>, R, Args...
+  > {
+    using Multiversioned = dyno::multiversioned<boost::hana::basic_tuple<InstructionSet...>,
+                                                boost::hana::basic_tuple<Function...>>;
+
+    template <typename F>
+    static R call(Args ...args) {
+      auto lambda = detail::empty_object<F>::get();
+      return lambda(std::forward<Args>(args)...);
+    }
+
+    // Calling the function directly (e.g. through `dyno::static_poly`) checks
+    // which implementation was selected on each call.
+    R operator()(Args ...args) const {
+      using Call = R (*)(Args...);
+      static constexpr Call calls[] = {&multiversioned_lambda::call<Function>...};
+      return calls[Multiversioned::selected()](std::forward<Args>(args)...);
+    }
+
+    // When the function is erased, the implementation is selected once, and
+    // the vtable holds that implementation directly.
+    template <typename Signature, typename Eraser>
+    static auto erase() {
+      using Erased = typename detail::erase_signature<Signature, Eraser>::type*;
+      Erased const all[] = {
+        detail::erase_function<Signature, Eraser>(
+          detail::default_constructible_lambda<Function, R(Args...)>{}
+        )...
+      };
+      return all[Multiversioned::selected()];
+    }
+  };
+
+  template <typename ...InstructionSet, typename ...Function, typename R, typename ...Args>
+  struct default_constructible_lambda<
+    dyno::multiversioned<boost::hana::basic_tuple<InstructionSet...>,
+                         boost::hana::basic_tuple<Function...>>, R(Args...)
+  > : multiversioned_lambda<
+    dyno::multiversioned<boost::hana::basic_tuple<InstructionSet...>,
+                         boost::hana::basic_tuple<Function...>>, R, Args...
+  > { };
+
+  template <typename ...InstructionSet, typename ...Function, typename ...Args>
+  struct default_constructible_lambda<
+    dyno::multiversioned<boost::hana::basic_tuple<InstructionSet...>,
+                         boost::hana::basic_tuple<Function...>>, void(Args...)
+  > : multiversioned_lambda<
+    dyno::multiversioned<boost::hana::basic_tuple<InstructionSet...>,
+                         boost::hana::basic_tuple<Function...>>, void, Args...
+  > { };
+
+  template <typename F>
+  struct is_multiversioned : std::false_type { };
+
+  template <typename InstructionSets, typename Functions>
+  struct is_multiversioned<dyno::multiversioned<InstructionSets, Functions>>
+    : std::true_type
+  { };
+
+  // The vtables of models using `dyno::multiversion` are created at runtime,
+  // once the implementations have been selected.
+  template <typename Concept, typename T, typename ...Name, typename ...Function>
+  struct is_erased_at_runtime<
+    dyno::concept_map_t<Concept, T, boost::hana::pair<Name, Function>...>
+  > : std::integral_constant<bool, (detail::is_multiversioned<Function>::value || ...)>
+  { };
+} // end namespace detail
+
+} // end namespace dyno
+
+#endif // DYNO_MULTIVERSION_HPP
@@ -8,21 +8,178 @@
 #include <dyno/builtin.hpp>
 #include <dyno/concept.hpp>
 #include <dyno/concept_map.hpp>
+#include <dyno/detail/attributed_call.hpp>
+#include <dyno/detail/dynamic_dispatch.hpp>
 #include <dyno/detail/is_placeholder.hpp>
+#include <dyno/multimethod.hpp>
 #include <dyno/storage.hpp>
 #include <dyno/vtable.hpp>
 
-#include <boost/hana/contains.hpp>
-#include <boost/hana/core/to.hpp>
-#include <boost/hana/map.hpp>
 #include <boost/hana/unpack.hpp>
 
+#include <any>
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
 
 namespace dyno {
 
+template <typename Concept, typename Storage, typename VTablePolicy>
+struct poly;
+
+namespace detail {
+  // Returns whether `OtherConcept` contains (at least) all the clauses of
+  // `Concept`, which happens when it refines `Concept`. In that case, the
+  // vtable of a `dyno::poly<OtherConcept>` can be used to create the vtable
+  // of a `dyno::poly<Concept>`.
+  template <typename Concept, typename OtherConcept>
+  struct is_subconcept
+    : decltype(detail::contains_names(
+      dyno::clause_names(Concept{}),
+      dyno::clause_names(OtherConcept{})
+    ))
+  { };
+
+  // The concept used to create the vtable of a `dyno::poly<Concept>`, which
+  // also contains the functions required to manage the lifetime of the object.
+  template <typename Concept>
+  using poly_concept = decltype(dyno::requires_(
+    Concept{},
+    dyno::Destructible{},
+    dyno::Storable{}
+  ));
+
+  // Returns whether `Storage` caches the hash of the object it holds (see
+  // the `PolymorphicStorage` concept).
+  template <typename Storage, typename VTable, typename = void>
+  struct has_cached_hash : std::false_type { };
+
+  template <typename Storage, typename VTable>
+  struct has_cached_hash<Storage, VTable, decltype((void)
+    std::declval<Storage const&>().hash(std::declval<VTable const&>())
+  )> : std::true_type { };
+
+  // Returns whether `T` is a `dyno::poly` whose concept refines `Concept`,
+  // which a `dyno::poly<Concept>` is converted from (instead of holding it).
+  template <typename Concept, typename T>
+  struct is_refining_poly : std::false_type { };
+
+  template <typename Concept, typename OtherConcept, typename Storage, typename VTablePolicy>
+  struct is_refining_poly<Concept, dyno::poly<OtherConcept, Storage, VTablePolicy>>
+    : is_subconcept<Concept, OtherConcept>
+  { };
+
+  // Implementation of `std::hash<dyno::poly<...>>`. When the concept of the
+  // `dyno::poly` does not contain `dyno::Hashable`, the specialization is
+  // disabled, like `std::hash` is for other types that can't be hashed.
+  template <typename Poly, typename = void>
+  struct poly_hash {
+    poly_hash() = delete;
+    poly_hash(poly_hash const&) = delete;
+    poly_hash& operator=(poly_hash const&) = delete;
+  };
+
+  template <typename Concept, typename Storage, typename VTablePolicy>
+  struct poly_hash<dyno::poly<Concept, Storage, VTablePolicy>,
+    std::enable_if_t<is_subconcept<dyno::Hashable, Concept>::value>
+  > {
+    std::size_t operator()(dyno::poly<Concept, Storage, VTablePolicy> const& p) const {
+      using VTable = typename dyno::poly<Concept, Storage, VTablePolicy>::VTable;
+      if constexpr (has_cached_hash<Storage, VTable>::value)
+        return p.storage_.hash(p.vtable_);
+      else
+        return p.vtable_["hash"_s](p.storage_.get());
+    }
+  };
+} // end namespace detail
+
+// Explicit instantiation of the vtable of a model.
+//
+// Every translation unit creating a `dyno::poly` from an object of type `T`
+// normally completes the concept map of `T`, instantiates the functions of
+// the vtable and, for remote vtables, a static vtable. With many translation
+// units, this is a lot of duplicated work for the compiler and the linker.
+// Instead, a project can declare in a header that the vtable of a model is
+// instantiated elsewhere:
+// ```
+// // shape.hpp
+// DYNO_EXTERN_VTABLE(Drawable, Square);
+// ```
+// and instantiate it in exactly one translation unit:
+// ```
+// // shape.cpp
+// #include "shape.hpp"
+// DYNO_INSTANTIATE_VTABLE(Drawable, Square);
+// ```
+// Other translation units then get the vtable by calling a function defined
+// in that translation unit, and never look at the concept map of `Square`.
+// An optional third argument is the vtable policy of the `dyno::poly`s this
+// applies to, which defaults to the one of `dyno::poly`. `dyno::poly`s using
+// other vtable policies are not affected.
+//
+// `DYNO_EXTERN_VTABLE` must be used at global scope, before any `dyno::poly`
+// is created from the model, and it must be seen by all the translation units
+// creating such `dyno::poly`s. Creating a `dyno::poly` from an externed model
+// costs a function call, which can't be inlined without link-time
+// optimization. `try_get` keeps working across translation units, as long as
+// at least one function is stored remotely (as usual).
+template <typename Concept, typename T,
+          typename VTablePolicy = dyno::vtable<dyno::remote<dyno::everything>>>
+struct extern_vtable {
+  using VTable = typename VTablePolicy::template apply<detail::poly_concept<Concept>>;
+
+  // Returns the vtable of `T`.
+  static VTable get();
+
+  // Returns whether `vtable` was returned by `get()`.
+  static bool created(VTable const& vtable);
+};
+
+// These are not defined in the class, so they are not inline and an explicit
+// instantiation declaration prevents instantiating them.
+template <typename Concept, typename T, typename VTablePolicy>
+typename extern_vtable<Concept, T, VTablePolicy>::VTable
+extern_vtable<Concept, T, VTablePolicy>::get() {
+  using ActualConcept = detail::poly_concept<Concept>;
+  return VTable{dyno::complete_concept_map<ActualConcept, T>(dyno::concept_map<ActualConcept, T>)};
+}
+
+template <typename Concept, typename T, typename VTablePolicy>
+bool extern_vtable<Concept, T, VTablePolicy>::created(VTable const& vtable) {
+  using ActualConcept = detail::poly_concept<Concept>;
+  using ConceptMap = decltype(dyno::complete_concept_map<ActualConcept, T>(
+    dyno::concept_map<ActualConcept, T>
+  ));
+  // All members are instantiated by `DYNO_INSTANTIATE_VTABLE`, so this can't
+  // be an error when the vtable can't identify concept maps. `dyno::poly`
+  // reports that error instead.
+  if constexpr (detail::can_identify_concept_map<VTable, ConceptMap>::value)
+    return vtable.created_from(ConceptMap{});
+  else
+    return false;
+}
+
+namespace detail {
+  // Whether the vtable of `T` is instantiated in another translation unit,
+  // for `dyno::poly`s of `Concept` using `VTablePolicy`. This is specialized
+  // by `DYNO_EXTERN_VTABLE`.
+  template <typename Concept, typename T,
+            typename VTablePolicy = dyno::vtable<dyno::remote<dyno::everything>>>
+  constexpr bool has_extern_vtable = false;
+} // end namespace detail
+
+#define DYNO_EXTERN_VTABLE(Concept, ...)                                        \
+  template <>                                                                   \
+  constexpr bool dyno::detail::has_extern_vtable<Concept, __VA_ARGS__> = true;  \
+  extern template struct dyno::extern_vtable<Concept, __VA_ARGS__>
+
+#define DYNO_INSTANTIATE_VTABLE(Concept, ...)                                   \
+  template struct dyno::extern_vtable<Concept, __VA_ARGS__>
+
 // A `dyno::poly` encapsulates an object of a polymorphic type that supports the
 // interface of the given `Concept`.
 //
@@ -53,6 +210,24 @@ namespace dyno {
 //    for methods. This must be a specialization of `dyno::vtable`.
 //    See `dyno::vtable` for details.
 //
+// A `dyno::poly` can also be constructed from a `dyno::poly` whose concept
+// refines `Concept` and that uses the same `Storage`. In that case, the object
+// is not rebuilt from its concrete type (which is unknown); instead, the vtable
+// is created from the vtable of the other `dyno::poly`, and the storage is
+// moved (or copied) using the other vtable. Moving a `dyno::poly<Derived>`
+// into a `dyno::poly<Base>` thus never reallocates with `dyno::remote_storage`.
+// When both vtables are remote, the static vtable of the destination is
+// created from the static vtable of the source the first time a given model
+// is converted, and shared by all the conversions of that model afterwards.
+// A remote vtable can't be created from a vtable that is not remote, since
+// the functions it needs are not known independently of the concrete type.
+//
+// Similarly, a `dyno::poly` using a non-owning storage (see `dyno::poly_ref`)
+// can borrow the object held by a `dyno::poly` using any other storage. With
+// the same concept and vtable policy, the vtable is simply copied, so calling
+// a function through the borrowed object is exactly as fast as through the
+// original `dyno::poly`.
+//
 // TODO:
 // - How to combine the storage of the object with that of the vtable?
 //   For example, how would we allow storing the vtable inside the rest
@@ -66,13 +241,25 @@ template <
 >
 struct poly {
 private:
-  using ActualConcept = decltype(dyno::requires_(
-    Concept{},
-    dyno::Destructible{},
-    dyno::Storable{}
-  ));
+  using ActualConcept = detail::poly_concept<Concept>;
   using VTable = typename VTablePolicy::template apply<ActualConcept>;
 
+  template <typename T>
+  static constexpr bool can_hold() {
+    if constexpr (detail::has_extern_vtable<Concept, T, VTablePolicy>)
+      return true; // checked in the translation unit instantiating the vtable
+    else
+      return dyno::models<ActualConcept, T>;
+  }
+
+  template <typename T>
+  static VTable model_vtable() {
+    if constexpr (detail::has_extern_vtable<Concept, T, VTablePolicy>)
+      return dyno::extern_vtable<Concept, T, VTablePolicy>::get();
+    else
+      return VTable{dyno::complete_concept_map<ActualConcept, T>(dyno::concept_map<ActualConcept, T>)};
+  }
+
 public:
   template <typename T, typename RawT = std::decay_t<T>, typename ConceptMap>
   poly(T&& t, ConceptMap map)
@@ -80,14 +267,90 @@ public:
     , storage_{std::forward<T>(t)}
   { }
 
+  // Creates a `dyno::poly` holding an object whose type is only known through
+  // `vtable`, such as a vtable exported by a plugin (see `dyno::abi_vtable`).
+  // The object is created by calling `construct` with a `void*` to storage
+  // for it, which requires a storage supporting this (e.g. `dyno::remote_storage`).
+  template <typename Construct>
+  poly(dyno::construct_with_vtable_t, VTable const& vtable, Construct&& construct)
+    : vtable_{vtable}
+    , storage_{dyno::construct_with_vtable_t{}, vtable_, std::forward<Construct>(construct)}
+  { }
+
+  // `dyno::poly`s of refining concepts are handled by the converting
+  // constructors below. They are excluded here before checking
+  // `dyno::models`, which would otherwise instantiate generic concept maps
+  // with a `dyno::poly`. Other `dyno::poly`s are held like any other object.
+  //
+  // When the vtable of the object's type is instantiated in another
+  // translation unit (see `DYNO_EXTERN_VTABLE`), it is obtained from there.
   template <typename T, typename RawT = std::decay_t<T>,
-    typename = std::enable_if_t<!std::is_same<RawT, poly>::value>,
-    typename = std::enable_if_t<dyno::models<ActualConcept, RawT>>
+    typename = std::enable_if_t<!detail::is_refining_poly<Concept, RawT>::value>,
+    typename = std::enable_if_t<poly::can_hold<RawT>()>
   >
   poly(T&& t)
-    : poly{std::forward<T>(t), dyno::concept_map<ActualConcept, RawT>}
+    : vtable_{poly::model_vtable<RawT>()}
+    , storage_{std::forward<T>(t)}
   { }
 
+  template <typename OtherConcept, typename OtherVTablePolicy,
+    typename Other = poly<OtherConcept, Storage, OtherVTablePolicy>,
+    typename = std::enable_if_t<!std::is_same<Other, poly>::value>,
+    typename = std::enable_if_t<detail::is_subconcept<Concept, OtherConcept>::value>
+  >
+  poly(poly<OtherConcept, Storage, OtherVTablePolicy> const& other)
+    : vtable_{dyno::from_vtable_t{}, other.vtable_}
+    , storage_{other.storage_, other.vtable_}
+  { }
+
+  template <typename OtherConcept, typename OtherVTablePolicy,
+    typename Other = poly<OtherConcept, Storage, OtherVTablePolicy>,
+    typename = std::enable_if_t<!std::is_same<Other, poly>::value>,
+    typename = std::enable_if_t<detail::is_subconcept<Concept, OtherConcept>::value>
+  >
+  poly(poly<OtherConcept, Storage, OtherVTablePolicy>& other)
+    : poly{static_cast<Other const&>(other)}
+  { }
+
+  template <typename OtherConcept, typename OtherVTablePolicy,
+    typename Other = poly<OtherConcept, Storage, OtherVTablePolicy>,
+    typename = std::enable_if_t<!std::is_same<Other, poly>::value>,
+    typename = std::enable_if_t<detail::is_subconcept<Concept, OtherConcept>::value>
+  >
+  poly(poly<OtherConcept, Storage, OtherVTablePolicy>&& other)
+    : vtable_{dyno::from_vtable_t{}, other.vtable_}
+    , storage_{std::move(other.storage_), other.vtable_}
+  { }
+
+  template <typename OtherConcept, typename OtherStorage, typename OtherVTablePolicy,
+    typename = std::enable_if_t<!std::is_same<OtherStorage, Storage>::value>,
+    typename = std::enable_if_t<std::is_constructible<Storage, dyno::from_storage_t, OtherStorage&>::value>,
+    typename = std::enable_if_t<detail::is_subconcept<Concept, OtherConcept>::value>
+  >
+  poly(poly<OtherConcept, OtherStorage, OtherVTablePolicy>& other)
+    : vtable_{dyno::from_vtable_t{}, other.vtable_}
+    , storage_{dyno::from_storage_t{}, other.storage_}
+  { }
+
+  template <typename OtherConcept, typename OtherStorage, typename OtherVTablePolicy,
+    typename = std::enable_if_t<!std::is_same<OtherStorage, Storage>::value>,
+    typename = std::enable_if_t<std::is_constructible<Storage, dyno::from_storage_t, OtherStorage const&>::value>,
+    typename = std::enable_if_t<detail::is_subconcept<Concept, OtherConcept>::value>
+  >
+  poly(poly<OtherConcept, OtherStorage, OtherVTablePolicy> const& other)
+    : vtable_{dyno::from_vtable_t{}, other.vtable_}
+    , storage_{dyno::from_storage_t{}, other.storage_}
+  { }
+
+  // Borrowing the object held by a temporary would leave us with a dangling
+  // reference.
+  template <typename OtherConcept, typename OtherStorage, typename OtherVTablePolicy,
+    typename = std::enable_if_t<!std::is_same<OtherStorage, Storage>::value>,
+    typename = std::enable_if_t<std::is_constructible<Storage, dyno::from_storage_t, OtherStorage const&>::value>,
+    typename = std::enable_if_t<detail::is_subconcept<Concept, OtherConcept>::value>
+  >
+  poly(poly<OtherConcept, OtherStorage, OtherVTablePolicy>&& other) = delete;
+
   poly(poly const& other)
     : vtable_{other.vtable_}
     , storage_{other.storage_, vtable_}
@@ -137,32 +400,29 @@ public:
   }
 
   template <typename Function,
-    bool HasClause = decltype(boost::hana::contains(dyno::clause_names(Concept{}), Function{})){},
+    bool HasClause = detail::has_clause<Concept, Function>,
     std::enable_if_t<HasClause>* = nullptr
   >
   constexpr decltype(auto) virtual_(Function name) const& {
-    auto clauses = boost::hana::to_map(dyno::clauses(Concept{}));
-    return virtual_impl(clauses[name], name);
+    return virtual_impl(Concept{}.get_signature(name), name);
   }
   template <typename Function,
-    bool HasClause = decltype(boost::hana::contains(dyno::clause_names(Concept{}), Function{})){},
+    bool HasClause = detail::has_clause<Concept, Function>,
     std::enable_if_t<HasClause>* = nullptr
   >
   constexpr decltype(auto) virtual_(Function name) & {
-    auto clauses = boost::hana::to_map(dyno::clauses(Concept{}));
-    return virtual_impl(clauses[name], name);
+    return virtual_impl(Concept{}.get_signature(name), name);
   }
   template <typename Function,
-    bool HasClause = decltype(boost::hana::contains(dyno::clause_names(Concept{}), Function{})){},
+    bool HasClause = detail::has_clause<Concept, Function>,
     std::enable_if_t<HasClause>* = nullptr
   >
   constexpr decltype(auto) virtual_(Function name) && {
-    auto clauses = boost::hana::to_map(dyno::clauses(Concept{}));
-    return std::move(*this).virtual_impl(clauses[name], name);
+    return std::move(*this).virtual_impl(Concept{}.get_signature(name), name);
   }
 
   template <typename Function,
-    bool HasClause = decltype(boost::hana::contains(dyno::clause_names(Concept{}), Function{})){},
+    bool HasClause = detail::has_clause<Concept, Function>,
     std::enable_if_t<!HasClause>* = nullptr
   >
   constexpr decltype(auto) virtual_(Function) const {
@@ -170,6 +430,30 @@ public:
                              "that is not part of the Concept");
   }
 
+  // Calls the function of the concept named `name` at runtime, with the
+  // `count` arguments pointed to by `args`, and returns its result (or an
+  // empty `std::any` if it returns `void`).
+  //
+  // This is meant for bridging to dynamic languages. The function is found
+  // with a perfect hash of the names of the functions that can be called this
+  // way, computed at compile-time, followed by a single comparison to reject
+  // unknown names. Methods can be called this way, and so can functions whose
+  // first parameter is the object itself, if the rest of their parameters are
+  // not placeholders and they don't return a non-copyable type. Only const
+  // methods can be called on a const `dyno::poly`.
+  //
+  // Arguments are passed by value, except for non-const lvalue references,
+  // which must be passed as a `std::reference_wrapper`. A `dyno::bad_dynamic_call`
+  // is thrown if there is no such function or if the number of arguments is
+  // wrong, and a `std::bad_any_cast` if an argument has the wrong type.
+  std::any invoke_dynamic(std::string_view name, std::any* args, std::size_t count) {
+    return detail::dynamic_dispatch<poly&, Concept>::invoke(*this, name, args, count);
+  }
+
+  std::any invoke_dynamic(std::string_view name, std::any* args, std::size_t count) const {
+    return detail::dynamic_dispatch<poly const&, Concept>::invoke(*this, name, args, count);
+  }
+
   // Returns a pointer to the underlying storage.
   //
   // The pointer is potentially invalidated whenever the poly is modified;
@@ -177,68 +461,189 @@ public:
   // to the underlying storage are invalidated.
   //
   // The behavior is undefined if the requested type is not cv-qualified `void`
-  // and the underlying storage is not of the requested type.
+  // and the underlying storage is not of the requested type. If the storage
+  // only provides const access to the object (e.g. `dyno::poly_cref`), a
+  // pointer to const is returned.
   template <typename T>
-  T* unsafe_get() { return storage_.template get<T>(); }
+  auto* unsafe_get() { return storage_.template get<T>(); }
 
   template <typename T>
   T const* unsafe_get() const { return storage_.template get<T>(); }
 
+  // Returns a pointer to the underlying object if it is of type `T`, and a
+  // null pointer otherwise.
+  //
+  // This is done by comparing the vtable of the `dyno::poly` with the vtable
+  // that would be created for `T`, which is a single pointer comparison. This
+  // makes it possible to special-case common types cheaply, for example to
+  // avoid dispatching through the vtable:
+  // ```
+  // if (auto* circle = shape.try_get<Circle>())
+  //   circle->draw(out); // statically dispatched, can be inlined
+  // else
+  //   shape.virtual_("draw"_s)(out);
+  // ```
+  //
+  // Since this is meant as a fast path, it is allowed to miss: a null pointer
+  // is returned when the object was stored using a custom concept map (see
+  // the constructor taking a concept map), or when the `dyno::poly` was
+  // created in another translation unit and the concept map of `T` is not
+  // `inline` (see `dyno::concept_map`). A non-null pointer is always
+  // correct, though.
+  //
+  // The vtable policy must store at least one function remotely, since local
+  // vtables can't identify the concept map they were created from. If the
+  // storage only provides const access to the object, a pointer to const is
+  // returned.
+  template <typename T>
+  auto* try_get() {
+    using Result = decltype(storage_.template get<T>());
+    return this->is_a<T>() ? storage_.template get<T>() : static_cast<Result>(nullptr);
+  }
+
+  template <typename T>
+  T const* try_get() const {
+    return this->is_a<T>() ? storage_.template get<T>() : nullptr;
+  }
+
 private:
+  template <typename, typename, typename>
+  friend struct poly;
+
+  template <typename, typename>
+  friend struct detail::poly_hash;
+
   VTable vtable_;
   Storage storage_;
 
+  template <typename T>
+  bool is_a() const {
+    if constexpr (detail::has_extern_vtable<Concept, T, VTablePolicy>) {
+      return dyno::extern_vtable<Concept, T, VTablePolicy>::created(vtable_);
+    } else if constexpr (!dyno::models<ActualConcept, T>) {
+      return false; // can only have been stored with a custom concept map
+    } else {
+      return this->is_a_impl<T>();
+    }
+  }
+
+  template <typename T>
+  bool is_a_impl() const {
+    using ConceptMap = decltype(dyno::complete_concept_map<ActualConcept, T>(
+      dyno::concept_map<ActualConcept, T>
+    ));
+    constexpr bool can_identify = detail::can_identify_concept_map<VTable, ConceptMap>::value;
+    static_assert(can_identify,
+      "dyno::poly::try_get: The vtable of this poly can't identify the type of "
+      "the object it holds. This happens when all the functions are stored in "
+      "a local vtable; make sure at least one function is stored remotely "
+      "(e.g. using `dyno::remote<dyno::everything_else>`).");
+    if constexpr (can_identify)
+      return vtable_.created_from(ConceptMap{});
+    else
+      return false;
+  }
+
   // Handle dyno::function
-  template <typename R, typename ...T, typename Function>
-  constexpr decltype(auto) virtual_impl(dyno::function_t<R(T...)>, Function name) const {
+  template <typename R, typename ...T, typename ...Attributes, typename Function>
+  constexpr decltype(auto) virtual_impl(dyno::function_t<R(T...), Attributes...>, Function name) const {
     auto fptr = vtable_[name];
     return [fptr](auto&& ...args) -> decltype(auto) {
-      return fptr(poly::unerase_poly<T>(static_cast<decltype(args)&&>(args))...);
+      return detail::attributed_call<Attributes...>(fptr,
+        poly::unerase_poly<T>(static_cast<decltype(args)&&>(args))...);
     };
   }
 
-  // Handle dyno::method
+  // Handle dyno::multimethod
   template <typename R, typename ...T, typename Function>
-  constexpr decltype(auto) virtual_impl(dyno::method_t<R(T...)>, Function name) & {
+  constexpr decltype(auto) virtual_impl(dyno::multimethod_t<R(T...)>, Function name) const {
+    return [name](auto&& ...args) -> decltype(auto) {
+      constexpr bool same_polys = (poly::is_multimethod_arg<T, decltype(args)>() && ...);
+      if constexpr (!same_polys) {
+        static_assert(same_polys,
+          "dyno::poly::virtual_: The arguments passed for the placeholders of a "
+          "multimethod must be of the same dyno::poly type as the one the "
+          "multimethod is called on (or pointers to it). Convert the other "
+          "arguments to that type first.");
+      } else {
+        using Table = detail::multimethod_table<
+          detail::declaring_concept_t<ActualConcept, Function>, Function, R(T...)
+        >;
+        auto indices = std::tuple_cat(poly::multimethod_index<T>(args, name)...);
+        auto fptr = Table::instance().lookup(std::get<0>(indices), std::get<1>(indices));
+        return fptr(poly::unerase_poly<T>(static_cast<decltype(args)&&>(args))...);
+      }
+    };
+  }
+
+  // Handle dyno::method
+  template <typename R, typename ...T, typename ...Attributes, typename Function>
+  constexpr decltype(auto) virtual_impl(dyno::method_t<R(T...), Attributes...>, Function name) & {
     auto fptr = vtable_[name];
     return [fptr, this](auto&& ...args) -> decltype(auto) {
-      return fptr(poly::unerase_poly<dyno::T&>(*this),
-                  poly::unerase_poly<T>(static_cast<decltype(args)&&>(args))...);
+      return detail::attributed_call<Attributes...>(fptr,
+        poly::unerase_poly<dyno::T&>(*this),
+        poly::unerase_poly<T>(static_cast<decltype(args)&&>(args))...);
     };
   }
-  template <typename R, typename ...T, typename Function>
-  constexpr decltype(auto) virtual_impl(dyno::method_t<R(T...)&>, Function name) & {
+  template <typename R, typename ...T, typename ...Attributes, typename Function>
+  constexpr decltype(auto) virtual_impl(dyno::method_t<R(T...)&, Attributes...>, Function name) & {
     auto fptr = vtable_[name];
     return [fptr, this](auto&& ...args) -> decltype(auto) {
-      return fptr(poly::unerase_poly<dyno::T&>(*this),
-                  poly::unerase_poly<T>(static_cast<decltype(args)&&>(args))...);
+      return detail::attributed_call<Attributes...>(fptr,
+        poly::unerase_poly<dyno::T&>(*this),
+        poly::unerase_poly<T>(static_cast<decltype(args)&&>(args))...);
     };
   }
-  template <typename R, typename ...T, typename Function>
-  constexpr decltype(auto) virtual_impl(dyno::method_t<R(T...)&&>, Function name) && {
+  template <typename R, typename ...T, typename ...Attributes, typename Function>
+  constexpr decltype(auto) virtual_impl(dyno::method_t<R(T...)&&, Attributes...>, Function name) && {
     auto fptr = vtable_[name];
     return [fptr, this](auto&& ...args) -> decltype(auto) {
-      return fptr(poly::unerase_poly<dyno::T&&>(*this),
-                  poly::unerase_poly<T>(static_cast<decltype(args)&&>(args))...);
+      return detail::attributed_call<Attributes...>(fptr,
+        poly::unerase_poly<dyno::T&&>(*this),
+        poly::unerase_poly<T>(static_cast<decltype(args)&&>(args))...);
     };
   }
-  template <typename R, typename ...T, typename Function>
-  constexpr decltype(auto) virtual_impl(dyno::method_t<R(T...) const>, Function name) const {
+  template <typename R, typename ...T, typename ...Attributes, typename Function>
+  constexpr decltype(auto) virtual_impl(dyno::method_t<R(T...) const, Attributes...>, Function name) const {
     auto fptr = vtable_[name];
     return [fptr, this](auto&& ...args) -> decltype(auto) {
-      return fptr(poly::unerase_poly<dyno::T const&>(*this),
-                  poly::unerase_poly<T>(static_cast<decltype(args)&&>(args))...);
+      return detail::attributed_call<Attributes...>(fptr,
+        poly::unerase_poly<dyno::T const&>(*this),
+        poly::unerase_poly<T>(static_cast<decltype(args)&&>(args))...);
     };
   }
-  template <typename R, typename ...T, typename Function>
-  constexpr decltype(auto) virtual_impl(dyno::method_t<R(T...) const&>, Function name) const {
+  template <typename R, typename ...T, typename ...Attributes, typename Function>
+  constexpr decltype(auto) virtual_impl(dyno::method_t<R(T...) const&, Attributes...>, Function name) const {
     auto fptr = vtable_[name];
     return [fptr, this](auto&& ...args) -> decltype(auto) {
-      return fptr(poly::unerase_poly<dyno::T const&>(*this),
-                  poly::unerase_poly<T>(static_cast<decltype(args)&&>(args))...);
+      return detail::attributed_call<Attributes...>(fptr,
+        poly::unerase_poly<dyno::T const&>(*this),
+        poly::unerase_poly<T>(static_cast<decltype(args)&&>(args))...);
     };
   }
 
+  // Returns whether `Arg` can be passed for a parameter of type `T` of a
+  // multimethod, i.e. whether it is this poly type when `T` is a placeholder.
+  template <typename T, typename Arg>
+  static constexpr bool is_multimethod_arg() {
+    using RawArg = std::remove_cv_t<std::remove_pointer_t<std::remove_reference_t<Arg>>>;
+    return !detail::is_placeholder<T>::value || std::is_same<RawArg, poly>::value;
+  }
+
+  // multimethod_index helper
+  template <typename T, typename Arg, typename Name, std::enable_if_t<!detail::is_placeholder<T>::value, int> = 0>
+  static constexpr auto multimethod_index(Arg const&, Name)
+  { return std::tuple<>{}; }
+
+  template <typename T, typename Arg, typename Name, std::enable_if_t<detail::is_placeholder<T>::value, int> = 0>
+  static constexpr auto multimethod_index(Arg const& arg, Name name) {
+    if constexpr (std::is_pointer<Arg>::value)
+      return std::make_tuple(arg->vtable_[name]());
+    else
+      return std::make_tuple(arg.vtable_[name]());
+  }
+
   // unerase_poly helper
   template <typename T, typename Arg, std::enable_if_t<!detail::is_placeholder<T>::value, int> = 0>
   static constexpr decltype(auto) unerase_poly(Arg&& arg)
@@ -251,7 +656,10 @@ private:
     static_assert(is_poly,
       "dyno::poly::virtual_: Passing a non-poly object as an argument to a virtual "
       "function that specified a placeholder for that parameter.");
-    return static_cast<Arg&&>(arg).storage_.get();
+    if constexpr (detail::is_const_placeholder<T>::value)
+      return std::as_const(arg.storage_).get();
+    else
+      return static_cast<Arg&&>(arg).storage_.get();
   }
   template <typename T, typename Arg, std::enable_if_t<detail::is_placeholder<T>::value, int> = 0>
   static constexpr decltype(auto) unerase_poly(Arg* arg) {
@@ -260,10 +668,48 @@ private:
     static_assert(is_poly,
       "dyno::poly::virtual_: Passing a non-poly object as an argument to a virtual "
       "function that specified a placeholder for that parameter.");
-    return arg->storage_.get();
+    if constexpr (detail::is_const_placeholder<T>::value)
+      return std::as_const(arg->storage_).get();
+    else
+      return arg->storage_.get();
   }
 };
 
+// A non-owning reference to a polymorphic object satisfying `Concept`.
+//
+// A `dyno::poly_ref` can be created from any object modeling `Concept`, or
+// from any `dyno::poly` of a concept refining `Concept`, in which case it
+// refers to the object held inside that `dyno::poly`. In all cases, the
+// referenced object must outlive the `dyno::poly_ref`. This is the type-erased
+// equivalent of a reference: it can be passed down call stacks to avoid
+// copying (and hence potentially allocating) polymorphic objects.
+template <
+  typename Concept,
+  typename VTablePolicy = dyno::vtable<dyno::remote<dyno::everything>>
+>
+using poly_ref = dyno::poly<Concept, dyno::non_owning_storage, VTablePolicy>;
+
+// A non-owning reference to a const polymorphic object satisfying `Concept`.
+//
+// This is like `dyno::poly_ref`, except it can refer to const objects, and
+// only const methods can be called through it.
+template <
+  typename Concept,
+  typename VTablePolicy = dyno::vtable<dyno::remote<dyno::everything>>
+>
+using poly_cref = dyno::poly<Concept, dyno::non_owning_const_storage, VTablePolicy>;
+
 } // end namespace dyno
 
+// Polymorphic objects whose concept contains `dyno::Hashable` can be hashed,
+// and hence used as keys in unordered containers. The hash is the one of the
+// object held inside the `dyno::poly`. When the storage of the `dyno::poly`
+// caches the hash (e.g. `dyno::cached_hash_storage`), the cached hash is used.
+namespace std {
+  template <typename Concept, typename Storage, typename VTablePolicy>
+  struct hash<dyno::poly<Concept, Storage, VTablePolicy>>
+    : dyno::detail::poly_hash<dyno::poly<Concept, Storage, VTablePolicy>>
+  { };
+} // end namespace std
+
 #endif // DYNO_POLY_HPP
@@ -0,0 +1,302 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_STATIC_POLY_HPP
+#define DYNO_STATIC_POLY_HPP
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/detail/dsl.hpp>
+#include <dyno/detail/is_placeholder.hpp>
+#include <dyno/multimethod.hpp>
+
+#include <boost/hana/unpack.hpp>
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+
+namespace dyno {
+
+namespace detail {
+  // Returns whether constructing a `Self` from `Args` is a copy or a move.
+  template <typename Self, typename ...Args>
+  struct is_copy_or_move : std::false_type { };
+
+  template <typename Self, typename Arg>
+  struct is_copy_or_move<Self, Arg>
+    : std::is_same<std::remove_cv_t<std::remove_reference_t<Arg>>, Self>
+  { };
+} // end namespace detail
+
+// A `dyno::static_poly` holds an object of a type `T` known at compile-time,
+// and provides the same interface as a `dyno::poly<Concept>` to access it.
+//
+// Instead of being dispatched through a vtable, the functions called through
+// `virtual_` are resolved directly in the concept map of `T`, at compile-time.
+// Hence, they can be inlined. This makes it possible to write generic code
+// against the interface of `dyno::poly` once, and to instantiate it either
+// with a `dyno::poly` when the type of the object is only known at runtime,
+// or with a `dyno::static_poly` when it is known at compile-time:
+// ```
+// template <typename Shape>
+// void draw_twice(Shape const& shape, std::ostream& out) {
+//   shape.virtual_("draw"_s)(out);
+//   shape.virtual_("draw"_s)(out);
+// }
+//
+// draw_twice(dyno::poly<Drawable>{Square{}}, std::cout);        // dispatched
+// draw_twice(dyno::static_poly<Drawable, Square>{Square{}}, std::cout); // inlined
+// ```
+//
+// Like for `dyno::poly`, the object held by a `dyno::static_poly` must be
+// passed explicitly to the functions whose parameters are placeholders, and
+// it must then be a `dyno::static_poly` (of the same concept). Multimethods
+// are supported; since their implementation is only known at runtime, they
+// are still looked up in their dispatch table, but without going through a
+// vtable to find the index of the models.
+//
+// Unlike `dyno::poly`, a `dyno::static_poly` is exactly as big as `T`, and it
+// is copyable, movable and swappable exactly when `T` is.
+template <typename Concept, typename T>
+struct static_poly {
+private:
+  using ConceptMap = decltype(dyno::complete_concept_map<Concept, T>(
+    dyno::concept_map<Concept, T>
+  ));
+
+public:
+  // Creates the held object from the given arguments. This never handles
+  // copies and moves of a `dyno::static_poly`, which are handled by the
+  // copy and move constructors.
+  template <typename ...Args, typename = std::enable_if_t<
+    !detail::is_copy_or_move<static_poly, Args...>::value &&
+    std::is_constructible<T, Args&&...>::value
+  >>
+  constexpr explicit static_poly(Args&& ...args)
+    : value_(std::forward<Args>(args)...)
+  { }
+
+  static_poly(static_poly const&) = default;
+  static_poly(static_poly&&) = default;
+  static_poly& operator=(static_poly const&) = default;
+  static_poly& operator=(static_poly&&) = default;
+
+  void swap(static_poly& other) {
+    using std::swap;
+    swap(value_, other.value_);
+  }
+
+  friend void swap(static_poly& a, static_poly& b) { a.swap(b); }
+
+  template <typename Name, typename ...Args>
+  decltype(auto) operator->*(dyno::detail::delayed_call<Name, Args...>&& delayed) {
+    auto f = virtual_(Name{});
+    auto injected = [f, this](auto&& ...args) -> decltype(auto) {
+      return f(*this, static_cast<decltype(args)&&>(args)...);
+    };
+    return boost::hana::unpack(std::move(delayed.args), injected);
+  }
+
+  template <typename Name, typename ...Args>
+  decltype(auto) operator->*(dyno::detail::delayed_call<Name, Args...>&& delayed) const {
+    auto f = virtual_(Name{});
+    auto injected = [f, this](auto&& ...args) -> decltype(auto) {
+      return f(*this, static_cast<decltype(args)&&>(args)...);
+    };
+    return boost::hana::unpack(std::move(delayed.args), injected);
+  }
+
+  template <typename Function,
+    bool HasClause = detail::has_clause<Concept, Function>,
+    std::enable_if_t<HasClause>* = nullptr
+  >
+  constexpr decltype(auto) virtual_(Function name) const& {
+    return virtual_impl(Concept{}.get_signature(name), name);
+  }
+  template <typename Function,
+    bool HasClause = detail::has_clause<Concept, Function>,
+    std::enable_if_t<HasClause>* = nullptr
+  >
+  constexpr decltype(auto) virtual_(Function name) & {
+    return virtual_impl(Concept{}.get_signature(name), name);
+  }
+  template <typename Function,
+    bool HasClause = detail::has_clause<Concept, Function>,
+    std::enable_if_t<HasClause>* = nullptr
+  >
+  constexpr decltype(auto) virtual_(Function name) && {
+    return std::move(*this).virtual_impl(Concept{}.get_signature(name), name);
+  }
+
+  template <typename Function,
+    bool HasClause = detail::has_clause<Concept, Function>,
+    std::enable_if_t<!HasClause>* = nullptr
+  >
+  constexpr decltype(auto) virtual_(Function) const {
+    static_assert(HasClause, "dyno::static_poly::virtual_: Trying to access a "
+                             "function that is not part of the Concept");
+  }
+
+  // Returns a pointer to the underlying object, like `dyno::poly::unsafe_get`.
+  // Since the type of the object is known, this is only valid when `U` is `T`
+  // or cv-qualified `void`.
+  template <typename U>
+  auto* unsafe_get() { return this->get_as<U>(std::addressof(value_)); }
+
+  template <typename U>
+  U const* unsafe_get() const { return this->get_as<U const>(std::addressof(value_)); }
+
+  // Returns a pointer to the underlying object if it is of type `U`, and a
+  // null pointer otherwise, like `dyno::poly::try_get`. This never misses.
+  template <typename U>
+  U* try_get() {
+    if constexpr (std::is_same<U, T>::value)
+      return std::addressof(value_);
+    else
+      return nullptr;
+  }
+
+  template <typename U>
+  U const* try_get() const {
+    if constexpr (std::is_same<U, T>::value)
+      return std::addressof(value_);
+    else
+      return nullptr;
+  }
+
+private:
+  template <typename, typename>
+  friend struct static_poly;
+
+  T value_;
+
+  template <typename U, typename Pointer>
+  static constexpr U* get_as(Pointer p) {
+    static_assert(std::is_void<U>::value || std::is_same<std::remove_cv_t<U>, T>::value,
+      "dyno::static_poly::unsafe_get: The requested type is not the type of the "
+      "object held in the static_poly.");
+    return p;
+  }
+
+  // Handle dyno::function
+  template <typename R, typename ...Args, typename ...Attributes, typename Function>
+  constexpr decltype(auto) virtual_impl(dyno::function_t<R(Args...), Attributes...>, Function name) const {
+    auto f = ConceptMap{}[name];
+    return [f](auto&& ...args) -> decltype(auto) {
+      return f(static_poly::unerase_poly<Args>(static_cast<decltype(args)&&>(args))...);
+    };
+  }
+
+  // Handle dyno::multimethod
+  template <typename R, typename ...Args, typename Function>
+  constexpr decltype(auto) virtual_impl(dyno::multimethod_t<R(Args...)>, Function) const {
+    return [](auto&& ...args) -> decltype(auto) {
+      using Table = detail::multimethod_table<
+        detail::declaring_concept_t<Concept, Function>, Function, R(Args...)
+      >;
+      auto indices = std::tuple_cat(static_poly::multimethod_index<Args, Table>(args)...);
+      auto fptr = Table::instance().lookup(std::get<0>(indices), std::get<1>(indices));
+      return fptr(static_poly::erase_poly<Args>(static_cast<decltype(args)&&>(args))...);
+    };
+  }
+
+  // Handle dyno::method
+  template <typename R, typename ...Args, typename ...Attributes, typename Function>
+  constexpr decltype(auto) virtual_impl(dyno::method_t<R(Args...), Attributes...>, Function name) & {
+    auto f = ConceptMap{}[name];
+    return [f, this](auto&& ...args) -> decltype(auto) {
+      return f(value_, static_poly::unerase_poly<Args>(static_cast<decltype(args)&&>(args))...);
+    };
+  }
+  template <typename R, typename ...Args, typename ...Attributes, typename Function>
+  constexpr decltype(auto) virtual_impl(dyno::method_t<R(Args...)&, Attributes...>, Function name) & {
+    auto f = ConceptMap{}[name];
+    return [f, this](auto&& ...args) -> decltype(auto) {
+      return f(value_, static_poly::unerase_poly<Args>(static_cast<decltype(args)&&>(args))...);
+    };
+  }
+  template <typename R, typename ...Args, typename ...Attributes, typename Function>
+  constexpr decltype(auto) virtual_impl(dyno::method_t<R(Args...)&&, Attributes...>, Function name) && {
+    auto f = ConceptMap{}[name];
+    return [f, this](auto&& ...args) -> decltype(auto) {
+      return f(std::move(value_), static_poly::unerase_poly<Args>(static_cast<decltype(args)&&>(args))...);
+    };
+  }
+  template <typename R, typename ...Args, typename ...Attributes, typename Function>
+  constexpr decltype(auto) virtual_impl(dyno::method_t<R(Args...) const, Attributes...>, Function name) const {
+    auto f = ConceptMap{}[name];
+    return [f, this](auto&& ...args) -> decltype(auto) {
+      return f(value_, static_poly::unerase_poly<Args>(static_cast<decltype(args)&&>(args))...);
+    };
+  }
+  template <typename R, typename ...Args, typename ...Attributes, typename Function>
+  constexpr decltype(auto) virtual_impl(dyno::method_t<R(Args...) const&, Attributes...>, Function name) const {
+    auto f = ConceptMap{}[name];
+    return [f, this](auto&& ...args) -> decltype(auto) {
+      return f(value_, static_poly::unerase_poly<Args>(static_cast<decltype(args)&&>(args))...);
+    };
+  }
+
+  // unerase_poly helper
+  template <typename Arg, typename Actual, std::enable_if_t<!detail::is_placeholder<Arg>::value, int> = 0>
+  static constexpr decltype(auto) unerase_poly(Actual&& arg)
+  { return static_cast<Actual&&>(arg); }
+
+  template <typename Arg, typename Actual, std::enable_if_t<detail::is_placeholder<Arg>::value, int> = 0>
+  static constexpr decltype(auto) unerase_poly(Actual&& arg) {
+    using RawActual = std::remove_cv_t<std::remove_reference_t<Actual>>;
+    constexpr bool is_static_poly = std::is_same<static_poly, RawActual>::value;
+    static_assert(is_static_poly,
+      "dyno::static_poly::virtual_: Passing an object that is not a static_poly "
+      "of the same concept and type as an argument to a function that specified "
+      "a placeholder for that parameter.");
+    return (static_cast<Actual&&>(arg).value_);
+  }
+  template <typename Arg, typename Actual, std::enable_if_t<detail::is_placeholder<Arg>::value, int> = 0>
+  static constexpr decltype(auto) unerase_poly(Actual* arg) {
+    using RawActual = std::remove_cv_t<Actual>;
+    constexpr bool is_static_poly = std::is_same<static_poly, RawActual>::value;
+    static_assert(is_static_poly,
+      "dyno::static_poly::virtual_: Passing an object that is not a static_poly "
+      "of the same concept and type as an argument to a function that specified "
+      "a placeholder for that parameter.");
+    return std::addressof(arg->value_);
+  }
+
+  // Helpers for multimethods, whose arguments may be `dyno::static_poly`s
+  // holding objects of different types.
+  template <typename U>
+  static U& value_of(static_poly<Concept, U>& p) { return p.value_; }
+  template <typename U>
+  static U const& value_of(static_poly<Concept, U> const& p) { return p.value_; }
+
+  template <typename Arg, typename Table, typename Actual>
+  static constexpr auto multimethod_index(Actual const& arg) {
+    if constexpr (!detail::is_placeholder<Arg>::value) {
+      return std::tuple<>{};
+    } else if constexpr (std::is_pointer<Actual>::value) {
+      using U = std::remove_cv_t<std::remove_reference_t<decltype(value_of(*arg))>>;
+      return std::make_tuple(Table::template index<U>());
+    } else {
+      using U = std::remove_cv_t<std::remove_reference_t<decltype(value_of(arg))>>;
+      return std::make_tuple(Table::template index<U>());
+    }
+  }
+
+  template <typename Arg, typename Actual>
+  static constexpr decltype(auto) erase_poly(Actual&& arg) {
+    if constexpr (!detail::is_placeholder<Arg>::value)
+      return static_cast<Actual&&>(arg);
+    else if constexpr (std::is_pointer<std::remove_reference_t<Actual>>::value)
+      return std::addressof(value_of(*arg));
+    else
+      return std::addressof(value_of(arg));
+  }
+};
+
+} // end namespace dyno
+
+#endif // DYNO_STATIC_POLY_HPP
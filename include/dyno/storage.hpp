@@ -8,6 +8,7 @@
 #include <dyno/builtin.hpp>
 #include <dyno/detail/dsl.hpp>
 
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdlib>
@@ -78,6 +79,8 @@ namespace dyno {
 //  Semantics: Return a pointer of type `T` to the object inside the polymorphic
 //             storage. If `T` is not the actual type of the object stored
 //             inside the polymorphic storage, the behavior is undefined.
+//             `dyno::poly` only uses this function when the object may be
+//             modified, and uses the const version otherwise.
 //
 // template <typename T = void> T const* get() const;
 //  Semantics: Return a pointer of type `T` to the object inside the polymorphic
@@ -87,6 +90,41 @@ namespace dyno {
 // static constexpr bool can_store(dyno::storage_info);
 //  Semantics: Return whether the polymorphic storage can store an object with
 //             the specified type information.
+//
+// Furthermore, storage classes that do not own the object they hold may
+// provide the following constructor:
+//
+// template <typename OtherStorage> Storage(dyno::from_storage_t, OtherStorage&);
+//  Semantics: Refer to the object held inside another polymorphic storage,
+//             without taking ownership of it. This is what makes it possible
+//             to borrow the object held by an owning `dyno::poly`.
+
+// Storage classes that allocate the object they hold may also provide the
+// following constructor, which makes it possible to create an object whose
+// type is only known through a vtable (e.g. a vtable exported by a plugin):
+//
+// template <typename VTable, typename Construct>
+// Storage(dyno::construct_with_vtable_t, VTable const&, Construct&&);
+//  Semantics: Allocate storage for an object described by the `"storage_info"`
+//             function of the provided vtable, and create the object by
+//             calling `construct` with a `void*` to that storage.
+//
+// Finally, storage classes may cache the hash of the object they hold by
+// providing the following member function, which `std::hash<dyno::poly>`
+// uses instead of calling the `"hash"` function of the vtable directly:
+//
+// template <typename VTable> std::size_t hash(VTable const&) const;
+//  Semantics: Return the hash of the object held inside the polymorphic
+//             storage, assuming that object can be hashed using the
+//             provided vtable.
+//
+// Tag used to construct a non-owning storage referring to the object held
+// inside another polymorphic storage.
+struct from_storage_t { };
+
+// Tag used to construct an owning storage holding an object whose type is
+// only known through a vtable.
+struct construct_with_vtable_t { };
 
 // Class implementing the small buffer optimization (SBO).
 //
@@ -267,6 +305,21 @@ struct remote_storage {
     new (ptr_) RawT(std::forward<T>(t));
   }
 
+  template <typename VTable, typename Construct>
+  remote_storage(dyno::construct_with_vtable_t, VTable const& vtable, Construct&& construct)
+    : ptr_{std::malloc(vtable["storage_info"_s]().size)}
+  {
+    // TODO: That's not a really nice way to handle this
+    assert(ptr_ != nullptr && "std::malloc failed, we're doomed");
+
+    try {
+      std::forward<Construct>(construct)(ptr_);
+    } catch (...) {
+      std::free(ptr_);
+      throw;
+    }
+  }
+
   template <typename VTable>
   remote_storage(remote_storage const& other, VTable const& vtable)
     : ptr_{std::malloc(vtable["storage_info"_s]().size)}
@@ -469,6 +522,20 @@ public:
   }
 };
 
+namespace detail {
+  // Returns a pointer to the object held by a storage, for a non-owning
+  // storage that keeps referring to it. Storages that need to know that
+  // their object may be modified without going through them provide a
+  // `borrow()` function, which is used instead of `get()`.
+  template <typename Storage>
+  auto borrow(Storage& storage, int) -> decltype(storage.borrow())
+  { return storage.borrow(); }
+
+  template <typename Storage>
+  auto borrow(Storage& storage, long) -> decltype(storage.get())
+  { return storage.get(); }
+} // end namespace detail
+
 // Class implementing a non-owning polymorphic reference. Unlike the other
 // storage classes, this one does not own the object it holds, and hence it
 // does not construct or destruct it. The referenced object must outlive the
@@ -485,6 +552,13 @@ struct non_owning_storage {
     : ptr_{&t}
   { }
 
+  template <typename OtherStorage, typename = std::enable_if_t<
+    std::is_convertible<decltype(std::declval<OtherStorage&>().get()), void*>::value
+  >>
+  non_owning_storage(dyno::from_storage_t, OtherStorage& other)
+    : ptr_{detail::borrow(other, 0)}
+  { }
+
   template <typename VTable>
   non_owning_storage(non_owning_storage const& other, VTable const&)
     : ptr_{other.ptr_}
@@ -521,6 +595,63 @@ private:
   void* ptr_;
 };
 
+// Class implementing a non-owning polymorphic reference to a const object.
+//
+// This is like `dyno::non_owning_storage`, except the referenced object is
+// only ever accessed through a pointer to const. Hence, this storage can
+// reference const objects, but non-const methods can't be called on them.
+struct non_owning_const_storage {
+  non_owning_const_storage() = delete;
+  non_owning_const_storage(non_owning_const_storage const&) = delete;
+  non_owning_const_storage(non_owning_const_storage&&) = delete;
+  non_owning_const_storage& operator=(non_owning_const_storage&&) = delete;
+  non_owning_const_storage& operator=(non_owning_const_storage const&) = delete;
+
+  template <typename T>
+  explicit non_owning_const_storage(T const& t)
+    : ptr_{&t}
+  { }
+
+  // Referencing a temporary would leave us with a dangling pointer.
+  template <typename T>
+  explicit non_owning_const_storage(T const&&) = delete;
+
+  template <typename OtherStorage>
+  non_owning_const_storage(dyno::from_storage_t, OtherStorage const& other)
+    : ptr_{other.get()}
+  { }
+
+  template <typename VTable>
+  non_owning_const_storage(non_owning_const_storage const& other, VTable const&)
+    : ptr_{other.ptr_}
+  { }
+
+  template <typename VTable>
+  non_owning_const_storage(non_owning_const_storage&& other, VTable const&)
+    : ptr_{other.ptr_}
+  { }
+
+  template <typename MyVTable, typename OtherVTable>
+  void swap(MyVTable const&, non_owning_const_storage& other, OtherVTable const&) {
+    std::swap(this->ptr_, other.ptr_);
+  }
+
+  template <typename VTable>
+  void destruct(VTable const&) { }
+
+  template <typename T = void>
+  T const* get() const {
+    return static_cast<T const*>(ptr_);
+  }
+
+  static constexpr bool can_store(dyno::storage_info) {
+    return true;
+  }
+
+private:
+  void const* ptr_;
+};
+
 // Class implementing polymorphic storage with a primary storage and a
 // fallback one.
 //
@@ -657,6 +788,114 @@ public:
   }
 };
 
+// Class decorating another polymorphic storage with a cache for the hash of
+// the object it holds.
+//
+// The hash is computed the first time it is requested, and it is reused
+// afterwards. This is useful for objects that are expensive to hash and that
+// are not modified while they are used as keys (like the keys of an unordered
+// container), since rehashing the container does not require calling through
+// the vtable anymore. The cache is dropped whenever the object is accessed
+// through a non-const path, i.e. when a function that may modify the object
+// is called on the `dyno::poly`. Calling a const method (or a function taking
+// `dyno::T const&`) keeps the cache.
+//
+// Once a mutable reference to the object has been created (e.g. a
+// `dyno::poly_ref` to the `dyno::poly`), the object can be modified without
+// going through this storage. Hence, the hash is not cached anymore for the
+// rest of the lifetime of the object, including after it is moved, and it is
+// computed each time it is requested. References to const (e.g. a
+// `dyno::poly_cref`) don't have this effect. Note that pointers obtained with
+// `unsafe_get` on a non-const `dyno::poly` must not be used to modify the
+// object after its hash has been requested.
+//
+// The cache is a single word, where a hash of `std::size_t(-1)` means that
+// no hash is cached; an object whose hash is that value is simply rehashed
+// each time. Requesting the hash concurrently from several threads is safe,
+// as long as no thread accesses the object through a non-const path at the
+// same time.
+template <typename Storage>
+class cached_hash_storage {
+  static constexpr std::size_t no_hash = static_cast<std::size_t>(-1);
+
+  Storage storage_;
+  mutable std::atomic<std::size_t> hash_;
+  bool borrowed_;
+
+public:
+  cached_hash_storage() = delete;
+  cached_hash_storage(cached_hash_storage const&) = delete;
+  cached_hash_storage(cached_hash_storage&&) = delete;
+  cached_hash_storage& operator=(cached_hash_storage&&) = delete;
+  cached_hash_storage& operator=(cached_hash_storage const&) = delete;
+
+  template <typename T>
+  explicit cached_hash_storage(T&& t)
+    : storage_{std::forward<T>(t)}, hash_{no_hash}, borrowed_{false}
+  { }
+
+  template <typename VTable>
+  cached_hash_storage(cached_hash_storage const& other, VTable const& vtable)
+    : storage_{other.storage_, vtable}
+    , hash_{other.hash_.load(std::memory_order_relaxed)}
+    , borrowed_{false}
+  { }
+
+  // References to the moved-from object may now refer to this one (e.g. with
+  // a remote storage), so the object is still considered borrowed.
+  template <typename VTable>
+  cached_hash_storage(cached_hash_storage&& other, VTable const& vtable)
+    : storage_{std::move(other.storage_), vtable}
+    , hash_{other.hash_.load(std::memory_order_relaxed)}
+    , borrowed_{other.borrowed_}
+  { }
+
+  template <typename MyVTable, typename OtherVTable>
+  void swap(MyVTable const& this_vtable, cached_hash_storage& other, OtherVTable const& other_vtable) {
+    storage_.swap(this_vtable, other.storage_, other_vtable);
+    std::size_t hash = hash_.load(std::memory_order_relaxed);
+    hash_.store(other.hash_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    other.hash_.store(hash, std::memory_order_relaxed);
+    std::swap(borrowed_, other.borrowed_);
+  }
+
+  template <typename VTable>
+  void destruct(VTable const& vtable) {
+    storage_.destruct(vtable);
+  }
+
+  template <typename T = void>
+  T* get() {
+    hash_.store(no_hash, std::memory_order_relaxed);
+    return storage_.template get<T>();
+  }
+
+  template <typename T = void>
+  T const* get() const {
+    return storage_.template get<T>();
+  }
+
+  void* borrow() {
+    borrowed_ = true;
+    return this->get();
+  }
+
+  template <typename VTable>
+  std::size_t hash(VTable const& vtable) const {
+    std::size_t hash = hash_.load(std::memory_order_relaxed);
+    if (hash == no_hash) {
+      hash = vtable["hash"_s](storage_.get());
+      if (!borrowed_)
+        hash_.store(hash, std::memory_order_relaxed);
+    }
+    return hash;
+  }
+
+  static constexpr bool can_store(dyno::storage_info info) {
+    return Storage::can_store(info);
+  }
+};
+
 } // end namespace dyno
 
 #endif // DYNO_STORAGE_HPP
@@ -0,0 +1,255 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_TASK_HPP
+#define DYNO_TASK_HPP
+
+// Coroutines require C++20; this header is empty otherwise.
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <dyno/detail/dsl.hpp>
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+
+namespace dyno {
+
+template <typename R = void>
+class task;
+
+namespace detail {
+  // Per-thread cache of coroutine frames, segregated by size.
+  //
+  // Coroutine frames of a given coroutine always have the same size, so a
+  // program that calls the same asynchronous functions over and over keeps
+  // reusing the same few blocks. Frames larger than the largest size class
+  // are not cached. A frame may be destroyed on a different thread than the
+  // one that created it, in which case it goes to the cache of the thread
+  // destroying it.
+  class frame_allocator {
+    static constexpr std::size_t granularity = 64;
+    static constexpr std::size_t size_classes = 16; // up to 1024 bytes
+    static constexpr std::size_t max_cached = 64;   // per size class
+
+    struct block { block* next; };
+    block* free_[size_classes] = {};
+    std::size_t cached_[size_classes] = {};
+
+    frame_allocator() = default;
+
+    static std::size_t size_class(std::size_t n)
+    { return (n + granularity - 1) / granularity - 1; }
+
+  public:
+    frame_allocator(frame_allocator const&) = delete;
+    frame_allocator& operator=(frame_allocator const&) = delete;
+
+    ~frame_allocator() {
+      for (block* b : free_) {
+        while (b != nullptr)
+          ::operator delete(std::exchange(b, b->next));
+      }
+    }
+
+    static frame_allocator& local() {
+      static thread_local frame_allocator allocator;
+      return allocator;
+    }
+
+    void* allocate(std::size_t n) {
+      std::size_t c = size_class(n);
+      if (c >= size_classes)
+        return ::operator new(n);
+      if (free_[c] == nullptr)
+        return ::operator new((c + 1) * granularity);
+      --cached_[c];
+      return std::exchange(free_[c], free_[c]->next);
+    }
+
+    void deallocate(void* p, std::size_t n) {
+      std::size_t c = size_class(n);
+      if (c >= size_classes || cached_[c] == max_cached) {
+        ::operator delete(p);
+      } else {
+        free_[c] = new (p) block{free_[c]};
+        ++cached_[c];
+      }
+    }
+  };
+
+  // Parts of the promise of a `dyno::task` that don't depend on its result.
+  struct task_promise_base {
+    static void* operator new(std::size_t n)
+    { return frame_allocator::local().allocate(n); }
+
+    static void operator delete(void* p, std::size_t n)
+    { frame_allocator::local().deallocate(p, n); }
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // When the task completes, resume the coroutine awaiting it, if any.
+    struct final_awaiter {
+      bool await_ready() noexcept { return false; }
+
+      template <typename Promise>
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> self) noexcept
+      { return self.promise().continuation; }
+
+      void await_resume() noexcept { }
+    };
+
+    final_awaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() { error = std::current_exception(); }
+
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+  };
+
+  template <typename R>
+  struct task_promise : task_promise_base {
+    template <typename U, typename = std::enable_if_t<std::is_convertible<U&&, R>::value>>
+    void return_value(U&& u) { value.emplace(std::forward<U>(u)); }
+
+    R result() {
+      if (error)
+        std::rethrow_exception(error);
+      return std::move(*value);
+    }
+
+    std::optional<R> value;
+  };
+
+  template <>
+  struct task_promise<void> : task_promise_base {
+    void return_void() { }
+
+    void result() {
+      if (error)
+        std::rethrow_exception(error);
+    }
+  };
+
+  template <typename Signature>
+  struct async_signature;
+
+  template <typename R, typename ...Args>
+  struct async_signature<R(Args...)> { using type = dyno::task<R>(Args...); };
+  template <typename R, typename ...Args>
+  struct async_signature<R(Args...) &> { using type = dyno::task<R>(Args...) &; };
+  template <typename R, typename ...Args>
+  struct async_signature<R(Args...) &&> { using type = dyno::task<R>(Args...) &&; };
+  template <typename R, typename ...Args>
+  struct async_signature<R(Args...) const> { using type = dyno::task<R>(Args...) const; };
+  template <typename R, typename ...Args>
+  struct async_signature<R(Args...) const&> { using type = dyno::task<R>(Args...) const&; };
+} // end namespace detail
+
+// Lazily started coroutine producing a value of type `R`.
+//
+// A `dyno::task` starts running when it is awaited with `co_await`, and the
+// awaiting coroutine is resumed as soon as the task completes (without going
+// through any scheduler). Exceptions escaping the task are rethrown in the
+// awaiting coroutine. Outside of a coroutine, a task can be started with
+// `start()`, and its result retrieved with `get()` once it is `done()`.
+//
+// The frames of the coroutines returning a `dyno::task` are recycled through
+// a per-thread cache, so calling the same coroutines repeatedly does not
+// allocate after the first few calls.
+template <typename R>
+class task {
+  static_assert(!std::is_reference<R>::value,
+    "dyno::task: Tasks returning references are not supported; return a "
+    "pointer or a std::reference_wrapper instead.");
+
+public:
+  struct promise_type : detail::task_promise<R> {
+    task get_return_object()
+    { return task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+  };
+
+  task(task&& other) noexcept
+    : handle_{std::exchange(other.handle_, nullptr)}
+  { }
+
+  task& operator=(task&& other) noexcept {
+    task(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  task(task const&) = delete;
+  task& operator=(task const&) = delete;
+
+  ~task() {
+    if (handle_)
+      handle_.destroy();
+  }
+
+  void swap(task& other) noexcept { std::swap(handle_, other.handle_); }
+  friend void swap(task& a, task& b) noexcept { a.swap(b); }
+
+  // Runs the task until it completes or suspends for the first time. This
+  // must be called at most once, and only on a task that is not awaited.
+  void start() { handle_.resume(); }
+
+  // Returns whether the task has completed.
+  bool done() const { return handle_.done(); }
+
+  // Returns the result of a completed task, or rethrows the exception that
+  // escaped it.
+  R get() { return handle_.promise().result(); }
+
+  auto operator co_await() && noexcept {
+    struct awaiter {
+      std::coroutine_handle<promise_type> handle;
+
+      bool await_ready() noexcept { return false; }
+
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+
+      R await_resume() { return handle.promise().result(); }
+    };
+    return awaiter{handle_};
+  }
+
+private:
+  explicit task(std::coroutine_handle<promise_type> handle) : handle_{handle} { }
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+// Right-hand-side of a clause in a concept that signifies an asynchronous
+// method with the given signature. This is a `dyno::method` returning a
+// `dyno::task<R>` instead of `R`, so the concept map must return such a task,
+// typically by being a coroutine itself or by calling one. For example:
+// ```
+// struct Handler : decltype(dyno::requires_(
+//   "handle"_s = dyno::async_method<Response (Request const&)>
+// )) { };
+//
+// template <typename T>
+// auto const dyno::default_concept_map<Handler, T> = dyno::make_concept_map(
+//   "handle"_s = [](T& self, Request const& r) { return self.handle(r); }
+// );
+//
+// dyno::poly<Handler> handler{...};
+// Response response = co_await handler.virtual_("handle"_s)(request);
+// ```
+template <typename Signature>
+constexpr dyno::method_t<typename detail::async_signature<Signature>::type> async_method{};
+
+} // end namespace dyno
+
+#endif // __cpp_impl_coroutine
+
+#endif // DYNO_TASK_HPP
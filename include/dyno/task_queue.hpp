@@ -0,0 +1,196 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_TASK_QUEUE_HPP
+#define DYNO_TASK_QUEUE_HPP
+
+#include <dyno/poly.hpp>
+#include <dyno/storage.hpp>
+#include <dyno/vtable.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+
+namespace dyno {
+
+// Bounded queue of polymorphic objects satisfying `Concept`, which can be
+// pushed concurrently by any number of threads, and popped by a single thread.
+//
+// The queue is a ring of slots, each of which holds a
+// `dyno::poly<Concept, dyno::local_storage<SlotSize>, VTablePolicy>`. Objects
+// are constructed directly inside a slot by the producer, and the consumer
+// uses them and destroys them in place. Hence, pushing and popping never
+// allocate, and objects don't need to be movable. Objects that don't fit in
+// `SlotSize` bytes are rejected at compile-time.
+//
+// Pushing and popping are lock-free; they only take a compare-and-swap (for
+// producers) and a few atomic loads and stores. This is the bounded queue of
+// Dmitry Vyukov, where each slot carries a sequence number telling whether
+// it's ready to be written or read. For example:
+// ```
+// struct Task : decltype(dyno::requires_(
+//   "run"_s = dyno::method<void ()>
+// )) { };
+//
+// dyno::task_queue<Task, 64> queue{1024};
+// queue.push(MyTask{...});     // from any thread
+// queue.try_pop([](auto& task) { // from the consumer thread only
+//   task.virtual_("run"_s)();
+// });
+// ```
+template <
+  typename Concept,
+  std::size_t SlotSize,
+  typename VTablePolicy = dyno::vtable<dyno::remote<dyno::everything>>
+>
+class task_queue {
+public:
+  using value_type = dyno::poly<Concept, dyno::local_storage<SlotSize>, VTablePolicy>;
+
+  // Creates a queue able to hold at least `capacity` objects. The capacity
+  // is rounded up to a power of two.
+  explicit task_queue(std::size_t capacity)
+    : mask_{round_up_to_power_of_two(capacity) - 1}
+    , slots_{new slot[mask_ + 1]}
+  {
+    for (std::size_t i = 0; i != mask_ + 1; ++i)
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  task_queue(task_queue const&) = delete;
+  task_queue& operator=(task_queue const&) = delete;
+
+  // Destroys the objects remaining in the queue, without using them.
+  ~task_queue() {
+    while (try_pop([](value_type&) { }))
+      ;
+  }
+
+  std::size_t capacity() const { return mask_ + 1; }
+
+  // Constructs an object of type `std::decay_t<T>` from `t` at the back of
+  // the queue, and returns whether there was room for it. This can be called
+  // from any thread.
+  //
+  // If the constructor of the object throws, the exception is propagated and
+  // nothing is pushed.
+  template <typename T>
+  bool try_push(T&& t) {
+    std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    slot* s;
+    while (true) {
+      s = &slots_[pos & mask_];
+      std::size_t seq = s->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return false; // the queue is full
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+
+    // The slot is ours, but it must be published even if the constructor
+    // throws, otherwise the consumer would wait for it forever.
+    struct publish {
+      slot* s;
+      std::size_t seq;
+      ~publish() { s->sequence.store(seq, std::memory_order_release); }
+    } publish_on_exit{s, pos + 1};
+    s->has_value = false;
+    new (&s->storage) value_type{std::forward<T>(t)};
+    s->has_value = true;
+    return true;
+  }
+
+  // Like `try_push`, but waits for room in the queue when it is full.
+  template <typename T>
+  void push(T&& t) {
+    while (!try_push(std::forward<T>(t)))
+      std::this_thread::yield();
+  }
+
+  // If the queue is not empty, calls `f` with the object at the front of the
+  // queue (as a `value_type&`), destroys that object and returns true.
+  // Otherwise, returns false. This must only be called by a single thread at
+  // a time.
+  //
+  // The object is destroyed even if `f` throws.
+  template <typename F>
+  bool try_pop(F&& f) {
+    while (true) {
+      slot& s = slots_[dequeue_pos_ & mask_];
+      std::size_t seq = s.sequence.load(std::memory_order_acquire);
+      if (seq != dequeue_pos_ + 1)
+        return false; // the queue is empty, or the producer isn't done yet
+
+      struct release {
+        task_queue* self;
+        slot& s;
+        ~release() {
+          s.sequence.store(self->dequeue_pos_ + self->mask_ + 1, std::memory_order_release);
+          ++self->dequeue_pos_;
+        }
+      } release_on_exit{this, s};
+
+      if (!s.has_value)
+        continue; // the constructor of this object threw; skip it
+
+      value_type* value = std::launder(reinterpret_cast<value_type*>(&s.storage));
+      struct destroy {
+        value_type* value;
+        ~destroy() { value->~value_type(); }
+      } destroy_on_exit{value};
+      std::forward<F>(f)(*value);
+      return true;
+    }
+  }
+
+  // Pops and uses all the objects in the queue, as if by calling `try_pop`
+  // until it returns false. Returns the number of objects popped.
+  template <typename F>
+  std::size_t consume_all(F&& f) {
+    std::size_t n = 0;
+    while (try_pop(f))
+      ++n;
+    return n;
+  }
+
+private:
+  // Keep each slot on its own cache line when it's small enough, so that
+  // producers writing adjacent slots don't contend.
+  static constexpr std::size_t cache_line = 64;
+
+  struct alignas(cache_line) slot {
+    std::atomic<std::size_t> sequence;
+    bool has_value;
+    std::aligned_storage_t<sizeof(value_type), alignof(value_type)> storage;
+  };
+
+  static std::size_t round_up_to_power_of_two(std::size_t n) {
+    std::size_t p = 2;
+    while (p < n)
+      p *= 2;
+    return p;
+  }
+
+  std::size_t const mask_;
+  std::unique_ptr<slot[]> const slots_;
+  alignas(cache_line) std::atomic<std::size_t> enqueue_pos_{0};
+  alignas(cache_line) std::size_t dequeue_pos_{0};
+};
+
+} // end namespace dyno
+
+#endif // DYNO_TASK_QUEUE_HPP
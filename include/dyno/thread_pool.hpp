@@ -0,0 +1,529 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_THREAD_POOL_HPP
+#define DYNO_THREAD_POOL_HPP
+
+#include <dyno/builtin.hpp>
+#include <dyno/function.hpp>
+#include <dyno/storage.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace dyno {
+
+namespace detail {
+  // Double-ended queue of pointers, where the owner thread pushes and pops
+  // at the bottom, and other threads steal from the top.
+  //
+  // This is the Chase-Lev deque, as formulated for the C11 memory model by
+  // Lê, Pop, Cohen and Zappa Nardelli. The memory fences of the original are
+  // folded into sequentially consistent operations on `top_` and `bottom_`.
+  // Arrays replaced when growing are kept alive until the deque is destroyed,
+  // since a thief might still be reading from them.
+  template <typename T>
+  class work_stealing_deque {
+    struct array {
+      explicit array(std::size_t n) : mask{n - 1}, items{new std::atomic<T*>[n]} { }
+      T* get(std::int64_t i) const { return items[static_cast<std::size_t>(i) & mask].load(std::memory_order_relaxed); }
+      void put(std::int64_t i, T* x) { items[static_cast<std::size_t>(i) & mask].store(x, std::memory_order_relaxed); }
+
+      std::size_t mask;
+      std::unique_ptr<std::atomic<T*>[]> items;
+    };
+
+    std::atomic<std::int64_t> top_{0};
+    std::atomic<std::int64_t> bottom_{0};
+    std::atomic<array*> array_;
+    std::vector<std::unique_ptr<array>> arrays_; // owned by the owner thread
+
+  public:
+    explicit work_stealing_deque(std::size_t capacity = 256) {
+      arrays_.push_back(std::make_unique<array>(capacity));
+      array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+
+    // Returns an estimate of the number of elements in the deque.
+    std::int64_t size() const {
+      std::int64_t b = bottom_.load(std::memory_order_seq_cst);
+      std::int64_t t = top_.load(std::memory_order_seq_cst);
+      return b - t;
+    }
+
+    // Owner only.
+    void push(T* x) {
+      std::int64_t b = bottom_.load(std::memory_order_relaxed);
+      std::int64_t t = top_.load(std::memory_order_acquire);
+      array* a = array_.load(std::memory_order_relaxed);
+      if (b - t > static_cast<std::int64_t>(a->mask)) {
+        auto bigger = std::make_unique<array>(2 * (a->mask + 1));
+        for (std::int64_t i = t; i != b; ++i)
+          bigger->put(i, a->get(i));
+        a = bigger.get();
+        arrays_.push_back(std::move(bigger));
+        array_.store(a, std::memory_order_release);
+      }
+      a->put(b, x);
+      bottom_.store(b + 1, std::memory_order_seq_cst);
+    }
+
+    // Owner only. Returns a null pointer if the deque is empty.
+    T* pop() {
+      std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+      array* a = array_.load(std::memory_order_relaxed);
+      bottom_.store(b, std::memory_order_seq_cst);
+      std::int64_t t = top_.load(std::memory_order_seq_cst);
+      if (t > b) { // empty
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+      }
+      T* x = a->get(b);
+      if (t == b) { // last element; race against thieves
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed))
+          x = nullptr;
+        bottom_.store(b + 1, std::memory_order_relaxed);
+      }
+      return x;
+    }
+
+    // Any thread. Returns a null pointer if the deque is empty, or if another
+    // thread took the element first.
+    T* steal() {
+      std::int64_t t = top_.load(std::memory_order_seq_cst);
+      std::int64_t b = bottom_.load(std::memory_order_seq_cst);
+      if (t >= b)
+        return nullptr;
+      array* a = array_.load(std::memory_order_acquire);
+      T* x = a->get(t);
+      if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                  std::memory_order_relaxed))
+        return nullptr;
+      return x;
+    }
+  };
+
+  template <typename Node>
+  class node_cache;
+
+  // Memory holding a task of a `dyno::thread_pool`, which is a move-only
+  // function wrapper like `dyno::unique_function<void()>`, but with a small
+  // buffer of `SmallBufferSize` bytes.
+  template <std::size_t SmallBufferSize>
+  struct task_node {
+    using task_type = dyno::basic_function<
+      dyno::MoveConstructible, dyno::sbo_storage<SmallBufferSize>, void()
+    >;
+
+    task_type& task() { return *std::launder(reinterpret_cast<task_type*>(&storage)); }
+
+    std::aligned_storage_t<sizeof(task_type), alignof(task_type)> storage;
+    task_node* next;
+    node_cache<task_node>* owner;
+  };
+
+  // Cache of nodes owned by a thread, so that submitting a task doesn't
+  // allocate once the program has warmed up.
+  //
+  // A node remembers the cache it was allocated from, and goes back to that
+  // cache once its task has run: directly when the task ran on the owner
+  // thread, and through a lock-free list otherwise, which the owner takes
+  // over when it runs out of nodes. Hence, a thread submitting tasks that
+  // are run by other threads (like the thread calling `parallel_for_each`)
+  // gets its nodes back, and a cache holds at most as many nodes as its
+  // thread had tasks in flight at once.
+  //
+  // A cache outlives its thread as long as some of its nodes are in use; it
+  // is destroyed by whichever thread returns the last of them.
+  template <typename Node>
+  class node_cache {
+    Node* free_ = nullptr; // owner thread only
+    std::atomic<Node*> returned_{nullptr};
+    std::atomic<std::size_t> users_{1}; // the owner thread, and nodes in use
+
+    struct holder {
+      node_cache* cache = nullptr;
+      ~holder() {
+        if (cache != nullptr)
+          cache->release();
+      }
+    };
+
+    static holder& this_thread() {
+      static thread_local holder h;
+      return h;
+    }
+
+    node_cache() = default;
+
+    ~node_cache() {
+      while (free_ != nullptr)
+        delete std::exchange(free_, free_->next);
+      Node* returned = returned_.load(std::memory_order_acquire);
+      while (returned != nullptr)
+        delete std::exchange(returned, returned->next);
+    }
+
+    void release() {
+      if (users_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+    }
+
+  public:
+    node_cache(node_cache const&) = delete;
+    node_cache& operator=(node_cache const&) = delete;
+
+    static node_cache& local() {
+      holder& h = this_thread();
+      if (h.cache == nullptr)
+        h.cache = new node_cache;
+      return *h.cache;
+    }
+
+    // Owner thread only.
+    Node* allocate() {
+      if (free_ == nullptr)
+        free_ = returned_.exchange(nullptr, std::memory_order_acquire);
+      Node* node = free_ != nullptr ? std::exchange(free_, free_->next) : new Node;
+      node->owner = this;
+      users_.fetch_add(1, std::memory_order_relaxed);
+      return node;
+    }
+
+    // Any thread.
+    static void deallocate(Node* node) {
+      node_cache* owner = node->owner;
+      if (owner == this_thread().cache) {
+        node->next = std::exchange(owner->free_, node);
+        owner->users_.fetch_sub(1, std::memory_order_relaxed);
+      } else {
+        node->next = owner->returned_.load(std::memory_order_relaxed);
+        while (!owner->returned_.compare_exchange_weak(node->next, node,
+                                                       std::memory_order_release,
+                                                       std::memory_order_relaxed))
+          ;
+        owner->release();
+      }
+    }
+  };
+
+  // Queue of nodes, linked through their `next` pointer, so that pushing a
+  // node never allocates. This is not synchronized.
+  template <typename Node>
+  class intrusive_queue {
+    Node* head_ = nullptr;
+    Node* tail_ = nullptr;
+
+  public:
+    bool empty() const { return head_ == nullptr; }
+
+    void push(Node* node) {
+      node->next = nullptr;
+      if (tail_ == nullptr)
+        head_ = node;
+      else
+        tail_->next = node;
+      tail_ = node;
+    }
+
+    Node* pop() {
+      Node* node = head_;
+      head_ = node->next;
+      if (head_ == nullptr)
+        tail_ = nullptr;
+      return node;
+    }
+  };
+} // end namespace detail
+
+// Pool of threads running tasks submitted to it, balanced by work-stealing.
+//
+// Each worker thread has its own deque of tasks. Tasks submitted from a worker
+// go to the deque of that worker, which runs them in LIFO order; idle workers
+// steal tasks from the other end of the deques of other workers. Tasks
+// submitted from outside of the pool go to a shared queue.
+//
+// Tasks are nullary function objects, held in a move-only function wrapper
+// (see `dyno::basic_function`) with a small buffer of `SmallBufferSize`
+// bytes. The memory for that wrapper is recycled through a cache owned by
+// the submitting thread, and the queues link the tasks in place, so
+// submitting a task whose state fits in the small buffer doesn't allocate
+// once the program has warmed up, whether it's submitted from a worker or
+// from another thread. Larger tasks allocate their state on the heap (see
+// `dyno::sbo_storage`).
+//
+// If a task throws an exception, the first such exception is rethrown by the
+// next call to `wait()`.
+template <std::size_t SmallBufferSize = 48>
+class thread_pool {
+  using node = detail::task_node<SmallBufferSize>;
+  using task_type = typename node::task_type;
+  using cache = detail::node_cache<node>;
+
+  struct worker {
+    detail::work_stealing_deque<node> deque;
+    std::thread thread;
+  };
+
+public:
+  explicit thread_pool(std::size_t threads = std::max(1u, std::thread::hardware_concurrency())) {
+    workers_.reserve(threads);
+    for (std::size_t i = 0; i != threads; ++i)
+      workers_.push_back(std::make_unique<worker>());
+    for (std::size_t i = 0; i != threads; ++i)
+      workers_[i]->thread = std::thread{[this, i] { this->work(i); }};
+  }
+
+  thread_pool(thread_pool const&) = delete;
+  thread_pool& operator=(thread_pool const&) = delete;
+
+  // Waits for all the tasks to complete, and joins the worker threads.
+  // Exceptions thrown by the tasks are ignored at this point.
+  ~thread_pool() {
+    this->run_until([this] { return pending_.load(std::memory_order_acquire) == 0; });
+    {
+      std::lock_guard<std::mutex> lock{sleep_mutex_};
+      stop_.store(true, std::memory_order_seq_cst);
+    }
+    sleep_cv_.notify_all();
+    for (auto& w : workers_)
+      w->thread.join();
+  }
+
+  std::size_t size() const { return workers_.size(); }
+
+  // Submits a task to the pool; `f` must be callable without arguments.
+  template <typename F>
+  void submit(F&& f) {
+    node* n = cache::local().allocate();
+    try {
+      new (&n->storage) task_type{std::forward<F>(f)};
+    } catch (...) {
+      cache::deallocate(n);
+      throw;
+    }
+
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    if (worker* w = this->current_worker()) {
+      w->deque.push(n);
+    } else {
+      std::lock_guard<std::mutex> lock{injection_mutex_};
+      injection_.push(n);
+      injected_.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) != 0) {
+      std::lock_guard<std::mutex> lock{sleep_mutex_};
+      sleep_cv_.notify_one();
+    }
+  }
+
+  // Waits until all the tasks submitted so far (and the tasks they submit)
+  // have completed. The calling thread runs tasks while it's waiting. If a
+  // task threw an exception, the first such exception is rethrown.
+  void wait() {
+    this->run_until([this] { return pending_.load(std::memory_order_acquire) == 0; });
+    std::exception_ptr error;
+    {
+      std::lock_guard<std::mutex> lock{error_mutex_};
+      error = std::exchange(error_, nullptr);
+    }
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  // Runs tasks on the calling thread until `done()` returns true. This is
+  // used to wait for a subset of the tasks without blocking a worker.
+  template <typename Predicate>
+  void run_until(Predicate done) {
+    worker* self = this->current_worker();
+    while (!done()) {
+      if (node* n = this->find_task(self))
+        this->run(n);
+      else
+        std::this_thread::yield();
+    }
+  }
+
+private:
+  std::vector<std::unique_ptr<worker>> workers_;
+
+  std::mutex injection_mutex_;
+  detail::intrusive_queue<node> injection_;
+  std::atomic<std::size_t> injected_{0};
+
+  std::atomic<std::size_t> pending_{0};
+  std::atomic<bool> stop_{false};
+
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cv_;
+  std::atomic<std::size_t> sleepers_{0};
+
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+
+  struct current {
+    thread_pool* pool;
+    worker* self;
+  };
+
+  static current& current_thread() {
+    static thread_local current c{nullptr, nullptr};
+    return c;
+  }
+
+  worker* current_worker() {
+    current& c = current_thread();
+    return c.pool == this ? c.self : nullptr;
+  }
+
+  void work(std::size_t index) {
+    worker* self = workers_[index].get();
+    current_thread() = current{this, self};
+    while (true) {
+      if (node* n = this->find_task(self)) {
+        this->run(n);
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock{sleep_mutex_};
+      sleepers_.fetch_add(1, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (!this->has_work() && !stop_.load(std::memory_order_seq_cst))
+        sleep_cv_.wait(lock);
+      sleepers_.fetch_sub(1, std::memory_order_relaxed);
+      if (stop_.load(std::memory_order_seq_cst) && !this->has_work())
+        return;
+    }
+  }
+
+  bool has_work() const {
+    if (injected_.load(std::memory_order_seq_cst) != 0)
+      return true;
+    for (auto const& w : workers_)
+      if (w->deque.size() > 0)
+        return true;
+    return false;
+  }
+
+  node* find_task(worker* self) {
+    if (self != nullptr)
+      if (node* n = self->deque.pop())
+        return n;
+
+    if (injected_.load(std::memory_order_relaxed) != 0) {
+      std::lock_guard<std::mutex> lock{injection_mutex_};
+      if (!injection_.empty()) {
+        node* n = injection_.pop();
+        injected_.fetch_sub(1, std::memory_order_relaxed);
+        return n;
+      }
+    }
+
+    // Start stealing from a different victim on each thread, so that thieves
+    // don't all contend on the same deque.
+    std::size_t const n_workers = workers_.size();
+    std::size_t const start = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    for (std::size_t i = 0; i != n_workers; ++i) {
+      worker* victim = workers_[(start + i) % n_workers].get();
+      if (victim != self)
+        if (node* n = victim->deque.steal())
+          return n;
+    }
+    return nullptr;
+  }
+
+  void run(node* n) {
+    auto& task = n->task();
+    try {
+      task();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock{error_mutex_};
+      if (!error_)
+        error_ = std::current_exception();
+    }
+    task.~task_type();
+    cache::deallocate(n);
+    pending_.fetch_sub(1, std::memory_order_release);
+  }
+};
+
+// Calls `f` on each element of the random-access range `[first, last)`, in
+// parallel on the threads of `pool`, and waits for all the calls to complete.
+// The calling thread runs tasks while it waits.
+//
+// This is typically used over a vector of `dyno::poly`s, to dispatch a
+// virtual function on heterogeneous objects in parallel:
+// ```
+// std::vector<dyno::poly<Shape>> shapes = ...;
+// dyno::parallel_for_each(pool, shapes.begin(), shapes.end(), [](auto& shape) {
+//   shape.virtual_("update"_s)(shape);
+// });
+// ```
+//
+// The range is divided into blocks of `grain` elements, each of which is run
+// as a single task. By default, there are about 8 blocks per thread. If some
+// call to `f` throws, the first exception thrown is rethrown once all the
+// blocks have completed.
+template <std::size_t SmallBufferSize, typename Iterator, typename F>
+void parallel_for_each(thread_pool<SmallBufferSize>& pool, Iterator first, Iterator last,
+                       F f, std::size_t grain = 0)
+{
+  static_assert(std::is_base_of<std::random_access_iterator_tag,
+                  typename std::iterator_traits<Iterator>::iterator_category>::value,
+    "dyno::parallel_for_each: The range must be a random-access range.");
+
+  auto const size = static_cast<std::size_t>(last - first);
+  if (size == 0)
+    return;
+  if (grain == 0)
+    grain = std::max<std::size_t>(1, size / (8 * pool.size()));
+
+  struct state {
+    std::atomic<std::size_t> remaining;
+    std::mutex error_mutex;
+    std::exception_ptr error;
+  } s;
+  s.remaining.store((size + grain - 1) / grain, std::memory_order_relaxed);
+
+  for (std::size_t begin = 0; begin < size; begin += grain) {
+    Iterator block_first = first + static_cast<std::ptrdiff_t>(begin);
+    Iterator block_last = first + static_cast<std::ptrdiff_t>(std::min(size, begin + grain));
+    pool.submit([block_first, block_last, &f, &s] {
+      try {
+        for (Iterator it = block_first; it != block_last; ++it)
+          f(*it);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock{s.error_mutex};
+        if (!s.error)
+          s.error = std::current_exception();
+      }
+      s.remaining.fetch_sub(1, std::memory_order_release);
+    });
+  }
+
+  pool.run_until([&s] { return s.remaining.load(std::memory_order_acquire) == 0; });
+  if (s.error)
+    std::rethrow_exception(s.error);
+}
+
+} // end namespace dyno
+
+#endif // DYNO_THREAD_POOL_HPP
@@ -8,26 +8,30 @@
 #include <dyno/concept.hpp>
 #include <dyno/detail/erase_function.hpp>
 #include <dyno/detail/erase_signature.hpp>
+#include <dyno/detail/index_of.hpp>
 
-#include <boost/hana/at_key.hpp>
 #include <boost/hana/basic_tuple.hpp>
 #include <boost/hana/bool.hpp>
+#include <boost/hana/concat.hpp>
 #include <boost/hana/contains.hpp>
 #include <boost/hana/core/to.hpp>
-#include <boost/hana/difference.hpp>
+#include <boost/hana/drop_front.hpp>
+#include <boost/hana/filter.hpp>
 #include <boost/hana/first.hpp>
+#include <boost/hana/flatten.hpp>
 #include <boost/hana/fold_left.hpp>
-#include <boost/hana/for_each.hpp>
-#include <boost/hana/is_subset.hpp>
 #include <boost/hana/length.hpp>
-#include <boost/hana/map.hpp>
 #include <boost/hana/or.hpp>
 #include <boost/hana/pair.hpp>
 #include <boost/hana/second.hpp>
-#include <boost/hana/set.hpp>
+#include <boost/hana/take_front.hpp>
+#include <boost/hana/tuple.hpp>
 #include <boost/hana/type.hpp>
 #include <boost/hana/unpack.hpp>
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <type_traits>
 #include <utility>
 
@@ -63,11 +67,64 @@ namespace dyno {
 //             is one. The behavior when no such function exists in the vtable
 //             is implementation defined (in most cases that's a compile-time
 //             error).
+//
+// template <typename OtherVTable> Table(dyno::from_vtable_t, OtherVTable const&);
+//  Semantics: Construct a vtable holding the same functions as the ones found
+//             under the same names in another vtable, which must contain at
+//             least all the functions of the vtable being constructed. This
+//             is used to view a `dyno::poly` as a `dyno::poly` of a less
+//             refined concept. This constructor is optional; vtables that
+//             can't support it must make it a compile-time error.
+//
+// template <typename ConceptMap> bool created_from(ConceptMap) const;
+//  Semantics: Return whether the vtable was constructed from a concept map
+//             of type `ConceptMap`. This must be cheap (ideally a single
+//             comparison), since it is used to check the dynamic type of a
+//             `dyno::poly`. This function is optional; vtables that can't
+//             identify the concept map they were created from must not
+//             provide it. A vtable must never return `true` when it was not
+//             created from `ConceptMap`; returning `false` in some cases
+//             where it was is allowed.
+
+// Tag used to construct a vtable from another vtable containing (at least)
+// the functions of the vtable being constructed.
+struct from_vtable_t { };
 
 
 //////////////////////////////////////////////////////////////////////////////
 // Vtable implementations
 
+namespace detail {
+  // A single function pointer of a `local_vtable`, stored at index `I`.
+  template <std::size_t I, typename Function>
+  struct vtable_slot {
+    Function function;
+  };
+
+  // The function pointers of a `local_vtable`, laid out in order. Slots are
+  // accessed by index through `detail::get_slot`, which only requires
+  // deducing a base class, instead of going through a `boost::hana::map`.
+  template <typename Indices, typename ...Functions>
+  struct vtable_slots;
+
+  template <std::size_t ...I, typename ...Functions>
+  struct vtable_slots<std::index_sequence<I...>, Functions...>
+    : detail::vtable_slot<I, Functions>...
+  {
+    constexpr explicit vtable_slots(Functions ...f)
+      : detail::vtable_slot<I, Functions>{f}...
+    { }
+  };
+
+  template <std::size_t I, typename Function>
+  constexpr Function& get_slot(detail::vtable_slot<I, Function>& slot)
+  { return slot.function; }
+
+  template <std::size_t I, typename Function>
+  constexpr Function const& get_slot(detail::vtable_slot<I, Function> const& slot)
+  { return slot.function; }
+} // end namespace detail
+
 // Class implementing a local vtable, i.e. a vtable whose storage is held
 // right where the `local_vtable` is instantiated.
 template <typename ...Mappings>
@@ -77,23 +134,28 @@ template <typename ...Name, typename ...Clause>
 struct local_vtable<boost::hana::pair<Name, Clause>...> {
   template <typename ConceptMap>
   constexpr explicit local_vtable(ConceptMap map)
-    : vtbl_{boost::hana::make_map(
-      boost::hana::make_pair(Name{}, detail::erase_function<typename Clause::type>(map[Name{}]))...
-    )} {
+    : vtbl_{detail::erase_function<typename Clause::type>(map[Name{}])...} {
     // suppress "unused" warnings for empty parameter packs
     (void) map;
   }
 
+  template <typename OtherVTable>
+  constexpr local_vtable(dyno::from_vtable_t, OtherVTable const& other)
+    : vtbl_{local_vtable::convert_entry<Name, Clause>(other)...} {
+    // suppress "unused" warnings for empty parameter packs
+    (void) other;
+  }
+
   template <typename Name_>
-  constexpr auto contains(Name_ name) const {
-    return boost::hana::contains(vtbl_, name);
+  constexpr auto contains(Name_) const {
+    return boost::hana::bool_c<(std::is_same<Name_, Name>::value || ...)>;
   }
 
   template <typename Name_>
   constexpr auto operator[](Name_ name) const {
     constexpr bool contains_function = decltype(contains(name))::value;
     if constexpr (contains_function) {
-      return vtbl_[name];
+      return detail::get_slot<detail::index_of<Name_, Name...>()>(vtbl_);
     } else {
       static_assert(contains_function,
         "dyno::local_vtable::operator[]: Request for a virtual function that is "
@@ -106,40 +168,192 @@ struct local_vtable<boost::hana::pair<Name, Clause>...> {
   }
 
   friend void swap(local_vtable& a, local_vtable& b) {
-    boost::hana::for_each(boost::hana::keys(a.vtbl_), [&](auto key) {
-      using std::swap;
-      swap(a.vtbl_[key], b.vtbl_[key]);
-    });
+    using std::swap;
+    swap(a.vtbl_, b.vtbl_);
   }
 
 private:
-  boost::hana::map<
-    boost::hana::pair<Name, typename detail::erase_signature<typename Clause::type>::type*>...
+  detail::vtable_slots<
+    std::index_sequence_for<Name...>,
+    typename detail::erase_signature<typename Clause::type>::type*...
   > vtbl_;
+
+  template <typename Name_, typename Clause_, typename OtherVTable>
+  static constexpr auto convert_entry(OtherVTable const& other) {
+    using Expected = typename detail::erase_signature<typename Clause_::type>::type*;
+    using Actual = decltype(other[Name_{}]);
+    static_assert(std::is_same<Expected, Actual>::value,
+      "dyno::local_vtable: Trying to construct a vtable from another vtable "
+      "holding a function with the same name but a different signature. "
+      "Make sure the concept used to create the source vtable refines the "
+      "concept used to create the destination vtable.");
+    return other[Name_{}];
+  }
 };
 
 namespace detail {
+  // Node of the list of vtables created from a static vtable, when
+  // converting a `dyno::remote_vtable` to a remote vtable of another type.
+  // `key` identifies the type of the vtable held by the node.
+  struct sub_vtable_node_base {
+    void const* key;
+    sub_vtable_node_base const* next;
+  };
+
+  template <typename VTable>
+  inline constexpr char sub_vtable_key = 0;
+
+  // Static vtable pointed to by a `dyno::remote_vtable`.
+  //
+  // Along with the vtable itself, this holds the static vtables of other
+  // types holding (a subset of) the same functions, which are created the
+  // first time a remote vtable pointing here is converted to a remote vtable
+  // of another type, and live until the end of the program. The list only
+  // ever grows, and it has one entry per type of vtable converted to, not
+  // per model, so it is expected to have one or two entries.
+  template <typename VTable>
+  struct remote_vtable_data {
+    template <typename ConceptMap>
+    constexpr explicit remote_vtable_data(ConceptMap map)
+      : vtable{map}
+    { }
+
+    template <typename OtherVTable>
+    remote_vtable_data(dyno::from_vtable_t tag, OtherVTable const& other)
+      : vtable{tag, other}
+    { }
+
+    VTable vtable;
+    mutable std::atomic<sub_vtable_node_base const*> sub_vtables{nullptr};
+  };
+
+  template <typename VTable>
+  struct sub_vtable_node : sub_vtable_node_base {
+    template <typename OtherVTable>
+    sub_vtable_node(sub_vtable_node_base const* next, OtherVTable const& other)
+      : sub_vtable_node_base{&sub_vtable_key<VTable>, next}
+      , data{dyno::from_vtable_t{}, other}
+    { }
+
+    remote_vtable_data<VTable> data;
+  };
+
+  // Whether some of the functions of `ConceptMap` can only be erased at
+  // runtime, in which case its vtables can't be initialized at compile-time.
+  // This is specialized in `<dyno/multiversion.hpp>`.
+  template <typename ConceptMap>
+  struct is_erased_at_runtime : std::false_type { };
+
+  template <typename VTable, typename ConceptMap>
+  inline remote_vtable_data<VTable> const static_vtable{ConceptMap{}};
+
+  template <typename VTable, typename ConceptMap>
+  remote_vtable_data<VTable> const* dynamic_static_vtable() {
+    static remote_vtable_data<VTable> const vtable{ConceptMap{}};
+    return &vtable;
+  }
+
+  // Returns the static vtable of `VTable` for the given concept map.
+  //
+  // When the vtable can't be initialized at compile-time, it is created the
+  // first time it is requested instead of during the dynamic initialization
+  // of the program, so that a `dyno::poly` can always be used during the
+  // dynamic initialization of another translation unit.
+  template <typename VTable, typename ConceptMap>
+  constexpr remote_vtable_data<VTable> const* get_static_vtable() {
+    if constexpr (detail::is_erased_at_runtime<ConceptMap>::value)
+      return detail::dynamic_static_vtable<VTable, ConceptMap>();
+    else
+      return &detail::static_vtable<VTable, ConceptMap>;
+  }
+
+  // Returns whether `VTable` provides the optional `created_from` function
+  // of the `VTable` concept.
+  template <typename VTable, typename ConceptMap, typename = void>
+  struct can_identify_concept_map : std::false_type { };
+
   template <typename VTable, typename ConceptMap>
-  static VTable const static_vtable{ConceptMap{}};
+  struct can_identify_concept_map<VTable, ConceptMap, decltype((void)
+    std::declval<VTable const&>().created_from(std::declval<ConceptMap>())
+  )> : std::true_type { };
+
+  inline sub_vtable_node_base const*
+  find_sub_vtable(sub_vtable_node_base const* begin,
+                  sub_vtable_node_base const* end,
+                  void const* key) {
+    for (sub_vtable_node_base const* n = begin; n != end; n = n->next)
+      if (n->key == key)
+        return n;
+    return nullptr;
+  }
+
+  // Returns the static vtable of type `VTable` created from the static
+  // vtable `from`, creating it if this is the first time it is requested.
+  template <typename VTable, typename OtherVTable>
+  remote_vtable_data<VTable> const*
+  sub_vtable(remote_vtable_data<OtherVTable> const* from) {
+    using Node = sub_vtable_node<VTable>;
+    void const* key = &sub_vtable_key<VTable>;
+    auto& head = from->sub_vtables;
+    sub_vtable_node_base const* first = head.load(std::memory_order_acquire);
+    if (auto found = detail::find_sub_vtable(first, nullptr, key))
+      return &static_cast<Node const*>(found)->data;
+
+    Node* created = new Node{first, from->vtable};
+    while (!head.compare_exchange_weak(created->next, created,
+                                       std::memory_order_release,
+                                       std::memory_order_acquire)) {
+      // Another thread added nodes in the meantime; only those need to be
+      // searched again.
+      if (auto found = detail::find_sub_vtable(created->next, first, key)) {
+        delete created;
+        return &static_cast<Node const*>(found)->data;
+      }
+      first = created->next;
+    }
+    return &created->data;
+  }
+
+  template <typename VTable>
+  struct is_remote_vtable : std::false_type { };
 }
 
 // Class implementing a vtable whose storage is held remotely. This is
 // basically a pointer to a static instance of the specified `VTable`.
 template <typename VTable>
 struct remote_vtable {
+  using vtable_type = VTable;
+
   template <typename ConceptMap>
   constexpr explicit remote_vtable(ConceptMap)
-    : vptr_{&detail::static_vtable<VTable, ConceptMap>}
+    : vptr_{detail::get_static_vtable<VTable, ConceptMap>()}
+  { }
+
+  template <typename OtherVTable>
+  remote_vtable(dyno::from_vtable_t, OtherVTable const& other)
+    : vptr_{remote_vtable::convert_vptr(other)}
   { }
 
   template <typename Name>
   constexpr auto operator[](Name name) const {
-    return (*vptr_)[name];
+    return vptr_->vtable[name];
   }
 
   template <typename Name>
   constexpr auto contains(Name name) const {
-    return vptr_->contains(name);
+    return vptr_->vtable.contains(name);
+  }
+
+  // There is one static vtable per concept map, so comparing the address of
+  // the static vtable we point to is enough to identify the concept map.
+  //
+  // The static vtables are `inline`, so this also holds across translation
+  // units, as long as the concept map itself is the same in all of them.
+  // Concept maps that are not `inline` have a different type in each
+  // translation unit, in which case this returns `false`.
+  template <typename ConceptMap>
+  bool created_from(ConceptMap) const {
+    return vptr_ == detail::get_static_vtable<VTable, ConceptMap>();
   }
 
   friend void swap(remote_vtable& a, remote_vtable& b) {
@@ -148,9 +362,40 @@ struct remote_vtable {
   }
 
 private:
-  VTable const* vptr_;
+  detail::remote_vtable_data<VTable> const* vptr_;
+
+  template <typename>
+  friend struct remote_vtable;
+
+  // A remote vtable points to a static vtable instantiated for a specific
+  // concept map, which is not known anymore once the vtable has been
+  // created. Hence, when converting from a remote vtable of another type,
+  // the static vtable holding the functions of this vtable is created from
+  // the other static vtable the first time it is needed, and kept alongside
+  // it for later conversions (see `detail::remote_vtable_data`).
+  template <typename OtherVTable>
+  static detail::remote_vtable_data<VTable> const* convert_vptr(OtherVTable const& other) {
+    constexpr bool is_remote = detail::is_remote_vtable<OtherVTable>::value;
+    static_assert(is_remote,
+      "dyno::remote_vtable: Trying to construct a remote vtable from a vtable "
+      "that is not remote. Since remote vtables are created statically for "
+      "each concept map, this is not supported. Consider storing the functions "
+      "of the destination vtable locally instead (e.g. using "
+      "`dyno::vtable<dyno::local<dyno::everything>>`).");
+    if constexpr (std::is_same<OtherVTable, remote_vtable>::value)
+      return other.vptr_;
+    else if constexpr (is_remote)
+      return detail::sub_vtable<VTable>(other.vptr_);
+    else
+      return nullptr;
+  }
 };
 
+namespace detail {
+  template <typename VTable>
+  struct is_remote_vtable<dyno::remote_vtable<VTable>> : std::true_type { };
+}
+
 // Class implementing a vtable that joins two other vtables.
 //
 // A function is first looked up in the first vtable, and in the second
@@ -164,11 +409,37 @@ struct joined_vtable {
     : first_{map}, second_{map}
   { }
 
+  template <typename OtherVTable>
+  constexpr joined_vtable(dyno::from_vtable_t tag, OtherVTable const& other)
+    : first_{tag, other}, second_{tag, other}
+  { }
+
+  // When the other vtable has the same layout, copy each half directly. This
+  // is required when one of the halves is remote, since remote vtables can
+  // only be obtained from other remote vtables.
+  constexpr joined_vtable(dyno::from_vtable_t, joined_vtable const& other)
+    : first_{other.first_}, second_{other.second_}
+  { }
+
   template <typename Name>
   constexpr auto contains(Name name) const {
     return first_.contains(name) || second_.contains(name);
   }
 
+  // Note that local vtables can't identify the concept map they were created
+  // from, since different concept maps could have the same functions. Hence,
+  // this is only available when one of the joined vtables is remote.
+  template <typename ConceptMap, typename = std::enable_if_t<
+    detail::can_identify_concept_map<First, ConceptMap>::value ||
+    detail::can_identify_concept_map<Second, ConceptMap>::value
+  >>
+  bool created_from(ConceptMap map) const {
+    if constexpr (detail::can_identify_concept_map<First, ConceptMap>::value)
+      return first_.created_from(map);
+    else
+      return second_.created_from(map);
+  }
+
   template <typename Name>
   constexpr auto operator[](Name name) const {
     auto first_contains_function = first_.contains(name);
@@ -208,16 +479,56 @@ private:
 
 //////////////////////////////////////////////////////////////////////////////
 // Selectors
+//
+// A selector is called with a `boost::hana::basic_tuple` of the names of the
+// functions that are still available, and returns a pair of such tuples: the
+// functions that remain available to the next policies, and the functions
+// that are selected for the current policy.
+namespace detail {
+  // Returns the names in `all` that are among `Names...` when `Selected` is
+  // true, and the ones that are not among `Names...` otherwise.
+  template <bool Selected, typename ...Names, typename All>
+  constexpr auto select_names(All all) {
+    return boost::hana::unpack(all, [](auto ...name) {
+      return boost::hana::flatten(boost::hana::make_basic_tuple(
+        std::conditional_t<
+          (detail::index_of<decltype(name), Names...>() != sizeof...(Names)) == Selected,
+          boost::hana::basic_tuple<decltype(name)>,
+          boost::hana::basic_tuple<>
+        >{}...
+      ));
+    });
+  }
+
+  // Returns the given names without duplicates, in the order in which they
+  // first appear. This is used instead of a `boost::hana::set`, which is
+  // much more expensive to compile.
+  template <typename ...Name, std::size_t ...I>
+  constexpr auto unique_names(std::index_sequence<I...>) {
+    return boost::hana::flatten(boost::hana::make_basic_tuple(
+      std::conditional_t<detail::index_of<Name, Name...>() == I,
+        boost::hana::basic_tuple<Name>,
+        boost::hana::basic_tuple<>
+      >{}...
+    ));
+  }
+
+  template <typename ...Name>
+  constexpr auto unique_names(boost::hana::basic_tuple<Name...> const&) {
+    return detail::unique_names<Name...>(std::index_sequence_for<Name...>{});
+  }
+} // end namespace detail
+
 template <typename ...Functions>
 struct only {
   template <typename All>
   constexpr auto operator()(All all) const {
-    auto matched = boost::hana::make_set(Functions{}...);
-    static_assert(decltype(boost::hana::is_subset(matched, all))::value,
+    boost::hana::basic_tuple<Functions...> matched;
+    static_assert(decltype(detail::contains_names(matched, all))::value,
       "dyno::only: Some functions specified in this selector are not part of "
       "the concept to which the selector was applied.");
     return boost::hana::make_pair(
-      boost::hana::difference(all, matched),
+      detail::select_names<false, Functions...>(all),
       matched
     );
   }
@@ -227,13 +538,13 @@ template <typename ...Functions>
 struct except {
   template <typename All>
   constexpr auto operator()(All all) const {
-    auto not_matched = boost::hana::make_set(Functions{}...);
-    static_assert(decltype(boost::hana::is_subset(not_matched, all))::value,
+    boost::hana::basic_tuple<Functions...> not_matched;
+    static_assert(decltype(detail::contains_names(not_matched, all))::value,
       "dyno::except: Some functions specified in this selector are not part of "
       "the concept to which the selector was applied.");
     return boost::hana::make_pair(
       not_matched,
-      boost::hana::difference(all, not_matched)
+      detail::select_names<false, Functions...>(all)
     );
   }
 };
@@ -241,12 +552,48 @@ struct except {
 struct everything {
   template <typename All>
   constexpr auto operator()(All all) const {
-    return boost::hana::make_pair(boost::hana::make_set(), all);
+    return boost::hana::make_pair(boost::hana::make_basic_tuple(), all);
   }
 };
 
 using everything_else = everything;
 
+// Profile data describing how often each function of a concept is called,
+// as generated by `dyno::write_profile`.
+//
+// Each entry is a `dyno::profile_entry`, and entries must be sorted by
+// decreasing number of calls.
+template <typename Name, std::uint64_t Calls>
+struct profile_entry {
+  using name = Name;
+  static constexpr std::uint64_t calls = Calls;
+};
+
+template <typename ...Entries>
+struct profile {
+  using names = boost::hana::tuple<typename Entries::name...>;
+};
+
+template <typename Profile, std::size_t N>
+struct profiled {
+  template <typename All>
+  constexpr auto operator()(All all) const {
+    auto in_concept = boost::hana::filter(typename Profile::names{}, [=](auto name) {
+      return boost::hana::contains(all, name);
+    });
+    auto hottest = boost::hana::take_front(in_concept, boost::hana::size_c<N>);
+    auto colder = boost::hana::drop_front(in_concept, boost::hana::size_c<N>);
+    auto unknown = boost::hana::unpack(in_concept, [=](auto ...name) {
+      return detail::select_names<false, decltype(name)...>(all);
+    });
+    return boost::hana::make_pair(
+      boost::hana::unpack(boost::hana::concat(colder, boost::hana::to_tuple(unknown)),
+                          boost::hana::make_basic_tuple),
+      boost::hana::unpack(hottest, boost::hana::make_basic_tuple)
+    );
+  }
+};
+
 namespace detail {
   template <typename T>
   struct is_valid_selector : boost::hana::false_ { };
@@ -265,6 +612,11 @@ namespace detail {
   struct is_valid_selector<dyno::everything>
     : boost::hana::true_
   { };
+
+  template <typename Profile, std::size_t N>
+  struct is_valid_selector<dyno::profiled<Profile, N>>
+    : boost::hana::true_
+  { };
 } // end namespace detail
 
 //////////////////////////////////////////////////////////////////////////////
@@ -274,7 +626,8 @@ struct local {
   static_assert(detail::is_valid_selector<Selector>::value,
     "dyno::local: Provided invalid selector. Valid selectors are "
     "'dyno::only<METHODS...>', 'dyno::except<METHODS...>', "
-    "'dyno::everything', and 'dyno::everything_else'.");
+    "'dyno::profiled<PROFILE, N>', 'dyno::everything', and "
+    "'dyno::everything_else'.");
 
   template <typename Concept, typename Functions>
   static constexpr auto create(Concept, Functions functions) {
@@ -294,7 +647,8 @@ struct remote {
   static_assert(detail::is_valid_selector<Selector>::value,
     "dyno::remote: Provided invalid selector. Valid selectors are "
     "'dyno::only<METHODS...>', 'dyno::except<METHODS...>', "
-    "'dyno::everything', and 'dyno::everything_else'.");
+    "'dyno::profiled<PROFILE, N>', 'dyno::everything', and "
+    "'dyno::everything_else'.");
 
   template <typename Concept, typename Functions>
   static constexpr auto create(Concept, Functions functions) {
@@ -318,7 +672,7 @@ namespace detail {
 
 template <typename Concept, typename Policies>
 constexpr auto generate_vtable(Policies policies) {
-  auto functions = boost::hana::to_set(dyno::clause_names(Concept{}));
+  auto functions = detail::unique_names(dyno::clause_names(Concept{}));
   auto state = boost::hana::make_pair(functions, boost::hana::basic_type<dyno::local_vtable<>>{});
   auto result = boost::hana::fold_left(policies, state, [](auto state, auto policy) {
     auto functions = boost::hana::first(state);
@@ -396,6 +750,22 @@ constexpr auto generate_vtable(Policies policies) {
 //    Picks all but the specified functions from a concept. `functions` must
 //    be compile-time strings, such as `dyno::except<decltype("foo"_s), decltype("bar"_s)>`.
 //
+//  dyno::profiled<Profile, N>
+//    Picks the `N` functions of a concept that are called the most according
+//    to `Profile`, which is a `dyno::profile` usually generated from a
+//    profiling run by `dyno::write_profile`. The picked functions are laid
+//    out by decreasing frequency, and so are the functions left to later
+//    policies (followed by the functions that do not appear in the profile).
+//    This makes it possible to tune the layout of vtables without listing
+//    functions by hand:
+//    ```
+//    #include "profiles.hpp" // generated by dyno::write_profile
+//    using VTable = dyno::vtable<
+//      dyno::local<dyno::profiled<IteratorProfile, 2>>,
+//      dyno::remote<dyno::everything_else>
+//    >;
+//    ```
+//
 //  dyno::everything
 //    Picks all the functions from a concept.
 //
@@ -410,6 +780,46 @@ struct vtable {
   )::type;
 };
 
+namespace detail {
+  template <typename Concept, std::size_t Budget>
+  constexpr auto generate_auto_vtable() {
+    constexpr std::size_t max_local = Budget / sizeof(void (*)());
+    auto hot = boost::hana::to_tuple(dyno::hot_clause_names(Concept{}));
+    auto local = boost::hana::take_front(hot, boost::hana::size_c<max_local>);
+    return boost::hana::unpack(local, [](auto ...name) {
+      using Policy = dyno::vtable<
+        dyno::local<dyno::only<decltype(name)...>>,
+        dyno::remote<dyno::everything_else>
+      >;
+      return boost::hana::basic_type<typename Policy::template apply<Concept>>{};
+    });
+  }
+} // end namespace detail
+
+// Vtable policy placing functions automatically based on the `dyno::hot`
+// annotations of the concept.
+//
+// Hot functions are stored in a local vtable, and all the other functions
+// are stored remotely. This is equivalent to
+// ```
+// dyno::vtable<
+//   dyno::local<dyno::only<HOT FUNCTIONS...>>,
+//   dyno::remote<dyno::everything_else>
+// >
+// ```
+// except the hot functions don't have to be repeated everywhere the vtable
+// policy is spelled. At most `Budget` bytes are used to store hot functions
+// locally; when the concept contains more hot functions than that, the ones
+// that come first in the concept (see `dyno::hot_clause_names`) are stored
+// locally, and the others are stored remotely. The default budget is three
+// function pointers, which together with the pointer to the remote vtable
+// makes the vtable the size of half a cache line on common platforms.
+template <std::size_t Budget = 3 * sizeof(void (*)())>
+struct auto_vtable {
+  template <typename Concept>
+  using apply = typename decltype(detail::generate_auto_vtable<Concept, Budget>())::type;
+};
+
 } // end namespace dyno
 
 #endif // DYNO_VTABLE_HPP
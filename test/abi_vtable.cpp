@@ -0,0 +1,103 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "abi_vtable/widget.hpp"
+#include "testing.hpp"
+
+#include <dyno/abi_vtable.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/storage.hpp>
+
+#include <dlfcn.h>
+
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+using namespace dyno::literals;
+
+
+// Path of the plugin, which is defined by the build system.
+#ifndef DYNO_TEST_PLUGIN
+#  error "DYNO_TEST_PLUGIN must be defined to the path of the plugin"
+#endif
+
+using AnyWidget = dyno::poly<Widget, dyno::remote_storage, dyno::abi_vtable_policy>;
+
+struct circle {
+  double radius;
+  double area() const { return 3 * radius * radius; }
+  void scale(double factor) { radius *= factor; }
+  std::string name() const { return "circle"; }
+};
+
+template <typename F>
+static F* load(void* plugin, char const* name) {
+  void* symbol = ::dlsym(plugin, name);
+  DYNO_CHECK(symbol != nullptr);
+  return reinterpret_cast<F*>(symbol);
+}
+
+int main() {
+  void* plugin = ::dlopen(DYNO_TEST_PLUGIN, RTLD_NOW | RTLD_LOCAL);
+  if (plugin == nullptr)
+    std::printf("%s\n", ::dlerror());
+  DYNO_CHECK(plugin != nullptr);
+
+  auto square_vtable = load<widget_vtable_fn>(plugin, "square_vtable");
+  auto old_square_vtable = load<widget_vtable_fn>(plugin, "old_square_vtable");
+  auto make_square = load<make_widget_fn>(plugin, "make_square");
+
+  {
+    std::vector<AnyWidget> widgets;
+    widgets.emplace_back(circle{1.0});
+    widgets.emplace_back(dyno::construct_with_vtable_t{}, square_vtable(),
+                         [&](void* where) { make_square(where, 2.0); });
+
+    // Calls go through the functions of the plugin.
+    DYNO_CHECK(widgets[0].virtual_("area"_s)() == 3.0);
+    DYNO_CHECK(widgets[1].virtual_("area"_s)() == 4.0);
+    DYNO_CHECK(widgets[1].virtual_("name"_s)(widgets[1]) == "square");
+    widgets[1].virtual_("scale"_s)(1.5);
+    DYNO_CHECK(widgets[1].virtual_("area"_s)() == 9.0);
+
+    // Copying and destroying also go through the plugin.
+    AnyWidget copy = widgets[1];
+    copy.virtual_("scale"_s)(2.0);
+    DYNO_CHECK(copy.virtual_("area"_s)() == 36.0);
+    DYNO_CHECK(widgets[1].virtual_("area"_s)() == 9.0);
+
+    // The host and the plugin use the same layout.
+    DYNO_CHECK(square_vtable()->size == dyno::export_vtable<Widget, circle>()->size);
+    DYNO_CHECK(square_vtable()->layout == dyno::export_vtable<Widget, circle>()->layout);
+    DYNO_CHECK(widgets[0].try_get<circle>() != nullptr);
+    DYNO_CHECK(widgets[1].try_get<circle>() == nullptr);
+  }
+
+  // A vtable created for another version of the concept is rejected.
+  {
+    bool thrown = false;
+    try {
+      AnyWidget w{dyno::construct_with_vtable_t{}, old_square_vtable(),
+                  [&](void* where) { make_square(where, 1.0); }};
+    } catch (std::runtime_error const&) {
+      thrown = true;
+    }
+    DYNO_CHECK(thrown);
+
+    dyno::abi_vtable_header header = *square_vtable();
+    header.version += 1;
+    thrown = false;
+    try {
+      AnyWidget w{dyno::construct_with_vtable_t{}, &header,
+                  [&](void* where) { make_square(where, 1.0); }};
+    } catch (std::runtime_error const&) {
+      thrown = true;
+    }
+    DYNO_CHECK(thrown);
+  }
+
+  ::dlclose(plugin);
+}
@@ -0,0 +1,35 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+// Plugin loaded by `test/abi_vtable.cpp`, providing a model of `Widget` that
+// the host knows nothing about.
+
+#include "widget.hpp"
+
+#include <dyno/abi_vtable.hpp>
+
+#include <new>
+#include <string>
+
+
+namespace {
+  struct square {
+    double side;
+    double area() const { return side * side; }
+    void scale(double factor) { side *= factor; }
+    std::string name() const { return "square"; }
+  };
+}
+
+extern "C" dyno::abi_vtable_header const* square_vtable() {
+  return dyno::export_vtable<Widget, square>();
+}
+
+extern "C" dyno::abi_vtable_header const* old_square_vtable() {
+  return dyno::export_vtable<OldWidget, square>();
+}
+
+extern "C" void make_square(void* where, double side) {
+  new (where) square{side};
+}
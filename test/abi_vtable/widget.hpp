@@ -0,0 +1,52 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_TEST_ABI_VTABLE_WIDGET_HPP
+#define DYNO_TEST_ABI_VTABLE_WIDGET_HPP
+
+#include <dyno/abi_vtable.hpp>
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+
+#include <string>
+using namespace dyno::literals;
+
+
+// Concept shared by the host and the plugin.
+struct Widget : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "area"_s = dyno::method<double () const>,
+  "scale"_s = dyno::method<void (double)>,
+  "name"_s = dyno::function<std::string (dyno::T const&)>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<Widget, T> = dyno::make_concept_map(
+  "area"_s = [](T const& self) { return self.area(); },
+  "scale"_s = [](T& self, double factor) { self.scale(factor); },
+  "name"_s = [](T const& self) { return self.name(); }
+);
+
+// An older version of the concept, where `area` returned an `int`.
+struct OldWidget : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "area"_s = dyno::method<int () const>,
+  "scale"_s = dyno::method<void (double)>,
+  "name"_s = dyno::function<std::string (dyno::T const&)>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<OldWidget, T> = dyno::make_concept_map(
+  "area"_s = [](T const& self) { return static_cast<int>(self.area()); },
+  "scale"_s = [](T& self, double factor) { self.scale(factor); },
+  "name"_s = [](T const& self) { return self.name(); }
+);
+
+extern "C" {
+  using widget_vtable_fn = dyno::abi_vtable_header const* ();
+  using make_widget_fn = void (void* where, double size);
+}
+
+#endif // DYNO_TEST_ABI_VTABLE_WIDGET_HPP
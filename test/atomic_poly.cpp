@@ -0,0 +1,122 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/atomic_poly.hpp>
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+using namespace dyno::literals;
+
+
+struct Rule : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "apply"_s = dyno::method<int (int) const>,
+  "consistent"_s = dyno::method<bool () const>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<Rule, T> = dyno::make_concept_map(
+  "apply"_s = [](T const& self, int x) { return self.apply(x); },
+  "consistent"_s = [](T const& self) { return self.consistent(); }
+);
+
+static std::atomic<int> live{0};
+
+struct Scale {
+  int factor, twice;
+  explicit Scale(int f) : factor{f}, twice{2 * f} { ++live; }
+  Scale(Scale const& other) : factor{other.factor}, twice{other.twice} { ++live; }
+  ~Scale() { factor = twice = -1; --live; }
+  int apply(int x) const { return x * factor; }
+  bool consistent() const { return factor >= 0 && twice == 2 * factor; }
+};
+
+struct Offset {
+  int offset;
+  int apply(int x) const { return x + offset; }
+  bool consistent() const { return true; }
+};
+
+int main() {
+  // Basic loads and stores; old objects are destroyed by `store`.
+  {
+    dyno::atomic_poly<Rule> rule{Scale{3}};
+    DYNO_CHECK(live == 1);
+    {
+      auto r = rule.load();
+      DYNO_CHECK(r->virtual_("apply"_s)(5) == 15);
+      DYNO_CHECK((*r).virtual_("apply"_s)(2) == 6);
+    }
+
+    rule.store(Offset{10});
+    DYNO_CHECK(live == 0);
+    DYNO_CHECK(rule.load()->virtual_("apply"_s)(5) == 15);
+
+    rule.store(Scale{4});
+    DYNO_CHECK(live == 1);
+    auto r = rule.load();
+    DYNO_CHECK(r.get().virtual_("apply"_s)(5) == 20);
+
+    // A guard can be moved around, e.g. returned from a function.
+    auto moved = std::move(r);
+    DYNO_CHECK(moved->virtual_("apply"_s)(1) == 4);
+  }
+  DYNO_CHECK(live == 0);
+
+  // A `dyno::poly` can be stored directly.
+  {
+    dyno::atomic_poly<Rule>::value_type p{Scale{2}};
+    dyno::atomic_poly<Rule> rule{p};
+    DYNO_CHECK(live == 2);
+    rule.store(std::move(p));
+    DYNO_CHECK(live == 1);
+    DYNO_CHECK(rule.load()->virtual_("apply"_s)(3) == 6);
+  }
+  DYNO_CHECK(live == 0);
+
+  // Readers never see a destroyed object while writers replace it.
+  {
+    dyno::atomic_poly<Rule> rule{Scale{1}};
+    std::atomic<bool> done{false};
+    std::atomic<bool> all_consistent{true};
+    std::vector<std::thread> readers;
+    for (int t = 0; t != 4; ++t) {
+      readers.emplace_back([&] {
+        while (!done.load(std::memory_order_relaxed)) {
+          auto r = rule.load();
+          if (!r->virtual_("consistent"_s)())
+            all_consistent = false;
+        }
+      });
+    }
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t != 2; ++t) {
+      writers.emplace_back([&rule, t] {
+        for (int i = 0; i != 500; ++i) {
+          if (i % 2 == 0)
+            rule.store(Scale{t * 1000 + i});
+          else
+            rule.store(Offset{i});
+        }
+      });
+    }
+    for (auto& w : writers)
+      w.join();
+    done = true;
+    for (auto& r : readers)
+      r.join();
+
+    DYNO_CHECK(all_consistent);
+    DYNO_CHECK(live <= 1);
+  }
+  DYNO_CHECK(live == 0);
+}
@@ -16,6 +16,7 @@ struct non_copy_constructible { non_copy_constructible(non_copy_constructible co
 struct non_move_assignable { non_move_assignable& operator=(non_move_assignable&&) = delete; };
 struct non_copy_assignable { non_copy_assignable& operator=(non_copy_assignable const&) = delete; };
 struct non_equality_comparable { friend bool operator==(non_equality_comparable const&, non_equality_comparable const&) = delete; };
+struct non_hashable { };
 struct non_destructible { ~non_destructible() = delete; };
 
 static_assert(!dyno::models<dyno::DefaultConstructible, non_default_constructible>, "");
@@ -24,6 +25,7 @@ static_assert(!dyno::models<dyno::CopyConstructible, non_copy_constructible>, ""
 static_assert(dyno::models<dyno::MoveAssignable, non_move_assignable>, "");
 static_assert(dyno::models<dyno::CopyAssignable, non_copy_assignable>, "");
 static_assert(!dyno::models<dyno::EqualityComparable, non_equality_comparable>, "");
+static_assert(!dyno::models<dyno::Hashable, non_hashable>, "");
 static_assert(!dyno::models<dyno::Destructible, non_destructible>, "");
 
 int main() { }
@@ -0,0 +1,104 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/vtable.hpp>
+
+#include <string>
+#include <utility>
+using namespace dyno::literals;
+
+
+//
+// This test makes sure that models of the builtin concepts whose functions
+// only depend on their size share the same functions in their vtables, and
+// that these functions behave properly.
+//
+
+struct Concept : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  dyno::Destructible{},
+  dyno::Storable{}
+)) { };
+
+struct point { int x, y; };
+struct extent { int width, height; };
+struct scalar { int value; };
+struct named { std::string name; };
+
+template <typename T>
+auto vtable_for() {
+  auto complete = dyno::complete_concept_map<Concept, T>(dyno::concept_map<Concept, T>);
+  return dyno::vtable<dyno::local<dyno::everything>>::apply<Concept>{complete};
+}
+
+int main() {
+  auto point_vtable = vtable_for<point>();
+  auto extent_vtable = vtable_for<extent>();
+  auto scalar_vtable = vtable_for<scalar>();
+  auto named_vtable = vtable_for<named>();
+
+  // Trivial models with the same size share all their functions.
+  DYNO_CHECK(point_vtable["copy-construct"_s] == extent_vtable["copy-construct"_s]);
+  DYNO_CHECK(point_vtable["move-construct"_s] == extent_vtable["move-construct"_s]);
+  DYNO_CHECK(point_vtable["destruct"_s] == extent_vtable["destruct"_s]);
+  DYNO_CHECK(point_vtable["storage_info"_s] == extent_vtable["storage_info"_s]);
+
+  // Trivial models with different sizes only share their destructor.
+  DYNO_CHECK(point_vtable["copy-construct"_s] != scalar_vtable["copy-construct"_s]);
+  DYNO_CHECK(point_vtable["move-construct"_s] != scalar_vtable["move-construct"_s]);
+  DYNO_CHECK(point_vtable["destruct"_s] == scalar_vtable["destruct"_s]);
+  DYNO_CHECK(point_vtable["storage_info"_s] != scalar_vtable["storage_info"_s]);
+
+  // Non-trivial models get their own functions, except for `storage_info`.
+  DYNO_CHECK(named_vtable["copy-construct"_s] != point_vtable["copy-construct"_s]);
+  DYNO_CHECK(named_vtable["move-construct"_s] != point_vtable["move-construct"_s]);
+  DYNO_CHECK(named_vtable["destruct"_s] != point_vtable["destruct"_s]);
+  if (sizeof(named) == sizeof(point) && alignof(named) == alignof(point))
+    DYNO_CHECK(named_vtable["storage_info"_s] == point_vtable["storage_info"_s]);
+
+  // The shared functions behave like the ones of the models.
+  {
+    dyno::storage_info info = point_vtable["storage_info"_s]();
+    DYNO_CHECK(info.size == sizeof(point));
+    DYNO_CHECK(info.alignment == alignof(point));
+  }
+  {
+    point p{1, 2};
+    alignas(point) unsigned char copy[sizeof(point)];
+    point_vtable["copy-construct"_s](copy, &p);
+    DYNO_CHECK(reinterpret_cast<point*>(copy)->x == 1);
+    DYNO_CHECK(reinterpret_cast<point*>(copy)->y == 2);
+    point_vtable["destruct"_s](copy);
+  }
+  {
+    dyno::poly<Concept> a{extent{3, 4}};
+    dyno::poly<Concept> b{a};
+    dyno::poly<Concept> c{std::move(b)};
+    DYNO_CHECK(a.unsafe_get<extent>()->width == 3);
+    DYNO_CHECK(c.unsafe_get<extent>()->width == 3);
+    DYNO_CHECK(c.unsafe_get<extent>()->height == 4);
+  }
+  {
+    dyno::poly<Concept, dyno::local_storage<64>> a{named{"hello"}};
+    dyno::poly<Concept, dyno::local_storage<64>> b{a};
+    dyno::poly<Concept, dyno::local_storage<64>> c{std::move(b)};
+    DYNO_CHECK(a.unsafe_get<named>()->name == "hello");
+    DYNO_CHECK(c.unsafe_get<named>()->name == "hello");
+  }
+
+  // Calling the functions directly still calls the functions of the model.
+  {
+    auto complete = dyno::complete_concept_map<Concept, point>(dyno::concept_map<Concept, point>);
+    point p{5, 6};
+    alignas(point) unsigned char copy[sizeof(point)];
+    complete["copy-construct"_s](copy, p);
+    DYNO_CHECK(reinterpret_cast<point*>(copy)->y == 6);
+  }
+}
@@ -0,0 +1,52 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno/concept.hpp>
+
+#include <boost/hana/core/to.hpp>
+#include <boost/hana/equal.hpp>
+#include <boost/hana/set.hpp>
+#include <boost/hana/tuple.hpp>
+#include <boost/hana/type.hpp>
+using namespace dyno::literals;
+namespace hana = boost::hana;
+
+
+// This test makes sure that hot clauses are equivalent to the clauses they
+// wrap, and that we can retrieve the names of the hot clauses in order.
+
+struct A : decltype(dyno::requires_(
+  "f"_s = dyno::hot(dyno::function<void (dyno::T&)>),
+  "g"_s = dyno::function<int (dyno::T&)>
+)) { };
+
+struct B : decltype(dyno::requires_(
+  A{},
+  "h"_s = dyno::function<double (dyno::T&, int)>,
+  "i"_s = dyno::hot(dyno::method<void () const>)
+)) { };
+
+struct C : decltype(dyno::requires_(
+  B{}
+)) { };
+
+static_assert(hana::to_set(dyno::clause_names(B{})) ==
+              hana::make_set("f"_s, "g"_s, "h"_s, "i"_s), "");
+
+static_assert(hana::to_tuple(dyno::hot_clause_names(A{})) ==
+              hana::make_tuple("f"_s), "");
+
+static_assert(hana::to_tuple(dyno::hot_clause_names(B{})) ==
+              hana::make_tuple("f"_s, "i"_s), "");
+
+static_assert(hana::to_tuple(dyno::hot_clause_names(C{})) ==
+              hana::make_tuple("f"_s, "i"_s), "");
+
+static_assert(hana::typeid_(C{}.get_signature("f"_s)) ==
+              hana::type_c<dyno::function_t<void (dyno::T&)>>, "");
+
+static_assert(hana::typeid_(C{}.get_signature("i"_s)) ==
+              hana::type_c<dyno::method_t<void () const>>, "");
+
+int main() { }
@@ -0,0 +1,67 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_TEST_EVENT_LOOP_HPP
+#define DYNO_TEST_EVENT_LOOP_HPP
+
+#include <dyno/task.hpp>
+
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+
+// Minimal single-threaded event loop for testing coroutines.
+//
+// Coroutines suspend on the loop with `co_await loop.yield()`, which puts
+// them at the back of the queue of ready coroutines. `run` starts tasks and
+// resumes ready coroutines in order until there are none left, which makes
+// the interleaving of tasks deterministic.
+class event_loop {
+public:
+  auto yield() {
+    struct awaiter {
+      event_loop* loop;
+      bool await_ready() noexcept { return false; }
+      void await_suspend(std::coroutine_handle<> h) { loop->ready_.push_back(h); }
+      void await_resume() noexcept { }
+    };
+    return awaiter{this};
+  }
+
+  // Runs `t` (and everything else on the loop) to completion, and returns
+  // its result.
+  template <typename R>
+  R run(dyno::task<R> t) {
+    t.start();
+    this->drain();
+    return t.get();
+  }
+
+  // Runs all the tasks concurrently on the loop, until all of them complete.
+  template <typename R>
+  void run_all(std::vector<dyno::task<R>>& tasks) {
+    for (auto& t : tasks)
+      t.start();
+    this->drain();
+  }
+
+  std::size_t resumptions() const { return resumptions_; }
+
+private:
+  void drain() {
+    while (!ready_.empty()) {
+      std::coroutine_handle<> h = ready_.front();
+      ready_.pop_front();
+      ++resumptions_;
+      h.resume();
+    }
+  }
+
+  std::deque<std::coroutine_handle<>> ready_;
+  std::size_t resumptions_ = 0;
+};
+
+#endif // DYNO_TEST_EVENT_LOOP_HPP
@@ -0,0 +1,65 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "extern_vtable/shape.hpp"
+#include "testing.hpp"
+
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/storage.hpp>
+
+#include <utility>
+using namespace dyno::literals;
+
+
+// The vtables of `square` are instantiated in `extern_vtable/instantiate.cpp`,
+// and its concept map is not even visible here. `rectangle` is a regular
+// model, whose vtable is instantiated in this translation unit.
+struct rectangle {
+  int width, height;
+};
+
+template <>
+auto const dyno::concept_map<Shape, rectangle> = dyno::make_concept_map(
+  "area"_s = [](rectangle const& self) { return self.width * self.height; },
+  "scale"_s = [](rectangle& self, int factor) { self.width *= factor; self.height *= factor; }
+);
+
+template <typename VTablePolicy>
+static void check() {
+  using AnyShape = dyno::poly<Shape, dyno::remote_storage, VTablePolicy>;
+
+  AnyShape s{square{3}};
+  DYNO_CHECK(s.virtual_("area"_s)() == 9);
+  s.virtual_("scale"_s)(2);
+  DYNO_CHECK(s.virtual_("area"_s)() == 36);
+
+  AnyShape copy{s};
+  DYNO_CHECK(copy.virtual_("area"_s)() == 36);
+
+  AnyShape r{rectangle{2, 3}};
+  DYNO_CHECK(r.virtual_("area"_s)() == 6);
+
+  using std::swap;
+  swap(r, copy);
+  DYNO_CHECK(r.virtual_("area"_s)() == 36);
+  DYNO_CHECK(copy.virtual_("area"_s)() == 6);
+}
+
+int main() {
+  check<dyno::vtable<dyno::remote<dyno::everything>>>();
+  check<LocalVTable>();
+
+  // The dynamic type of a poly holding a model with an extern vtable can
+  // still be checked.
+  {
+    dyno::poly<Shape> s{square{3}};
+    dyno::poly<Shape> r{rectangle{2, 3}};
+    DYNO_CHECK(s.try_get<square>() != nullptr);
+    DYNO_CHECK(s.try_get<square>()->side == 3);
+    DYNO_CHECK(s.try_get<rectangle>() == nullptr);
+    DYNO_CHECK(r.try_get<square>() == nullptr);
+    DYNO_CHECK(r.try_get<rectangle>() != nullptr);
+  }
+}
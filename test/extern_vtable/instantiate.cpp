@@ -0,0 +1,19 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "shape.hpp"
+
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+using namespace dyno::literals;
+
+
+template <>
+auto const dyno::concept_map<Shape, square> = dyno::make_concept_map(
+  "area"_s = [](square const& self) { return self.side * self.side; },
+  "scale"_s = [](square& self, int factor) { self.side *= factor; }
+);
+
+DYNO_INSTANTIATE_VTABLE(Shape, square);
+DYNO_INSTANTIATE_VTABLE(Shape, square, LocalVTable);
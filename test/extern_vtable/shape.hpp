@@ -0,0 +1,32 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_TEST_EXTERN_VTABLE_SHAPE_HPP
+#define DYNO_TEST_EXTERN_VTABLE_SHAPE_HPP
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/vtable.hpp>
+using namespace dyno::literals;
+
+
+struct Shape : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "area"_s = dyno::method<int () const>,
+  "scale"_s = dyno::method<void (int)>
+)) { };
+
+struct square {
+  int side;
+};
+
+using LocalVTable = dyno::vtable<dyno::local<dyno::everything>>;
+
+// The concept maps of `square` are only defined in `instantiate.cpp`, so
+// the other translation units can't instantiate its vtables by accident.
+DYNO_EXTERN_VTABLE(Shape, square);
+DYNO_EXTERN_VTABLE(Shape, square, LocalVTable);
+
+#endif // DYNO_TEST_EXTERN_VTABLE_SHAPE_HPP
@@ -0,0 +1,165 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/flat_poly_vector.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+using namespace dyno::literals;
+
+
+struct Rule : decltype(dyno::requires_(
+  "matches"_s = dyno::method<bool (int) const>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<Rule, T> = dyno::make_concept_map(
+  "matches"_s = [](T const& self, int x) { return self.matches(x); }
+);
+
+struct Threshold {
+  int min;
+  bool matches(int x) const { return x >= min; }
+};
+
+struct Range {
+  std::int64_t low, high;
+  bool matches(int x) const { return low <= x && x < high; }
+};
+
+struct Never {
+  bool matches(int) const { return false; }
+};
+
+struct alignas(16) Wide {
+  double factor;
+  bool matches(int x) const { return x * factor > 100.0; }
+};
+
+using Rules = dyno::model_registry<Threshold, Range, Never, Wide>;
+using OtherRules = dyno::model_registry<Threshold, Range>;
+
+static std::vector<bool> evaluate(dyno::flat_poly_vector<Rule, Rules> const& rules, int x) {
+  std::vector<bool> results;
+  for (auto rule : rules)
+    results.push_back(rule.virtual_("matches"_s)(x));
+  return results;
+}
+
+template <typename Container>
+static std::vector<bool> evaluate_indexed(Container const& rules, int x) {
+  std::vector<bool> results;
+  for (std::size_t i = 0; i != rules.size(); ++i)
+    results.push_back(rules[i].virtual_("matches"_s)(x));
+  return results;
+}
+
+int main() {
+  static_assert(Rules::index_of<Threshold>() == 0);
+  static_assert(Rules::index_of<Wide>() == 3);
+  static_assert(Rules::fingerprint() != OtherRules::fingerprint());
+
+  dyno::flat_poly_vector<Rule, Rules> rules;
+  DYNO_CHECK(rules.empty());
+  rules.push_back(Threshold{10});
+  rules.push_back(Never{});
+  rules.push_back(Range{2, 5});
+  rules.push_back(Wide{20.0});
+  rules.push_back(Threshold{-1});
+  DYNO_CHECK(rules.size() == 5);
+
+  // Objects are stored at properly aligned addresses.
+  DYNO_CHECK(reinterpret_cast<std::uintptr_t>(rules[3].unsafe_get<void>()) % 16 == 0);
+  DYNO_CHECK(rules[2].unsafe_get<Range>()->high == 5);
+
+  DYNO_CHECK((evaluate(rules, 3) == std::vector<bool>{false, false, true, false, true}));
+  DYNO_CHECK((evaluate(rules, 12) == std::vector<bool>{true, false, false, true, true}));
+  DYNO_CHECK(evaluate_indexed(rules, 3) == evaluate(rules, 3));
+
+  std::string const path = "test.flat_poly_vector.bin";
+  {
+    std::ofstream out{path, std::ios::binary};
+    rules.write(out);
+  }
+
+  // The mapped container gives the same results.
+  {
+    dyno::mapped_poly_vector<Rule, Rules> mapped{path.c_str()};
+    DYNO_CHECK(mapped.size() == 5);
+    DYNO_CHECK(evaluate_indexed(mapped, 3) == evaluate(rules, 3));
+    DYNO_CHECK(evaluate_indexed(mapped, 12) == evaluate(rules, 12));
+    DYNO_CHECK(mapped[2].unsafe_get<Range>()->low == 2);
+
+    auto moved = std::move(mapped);
+    DYNO_CHECK(mapped.size() == 0);
+    std::size_t count = 0;
+    for (auto rule : moved)
+      count += rule.virtual_("matches"_s)(12);
+    DYNO_CHECK(count == 3);
+  }
+
+  // Loading with a different registry fails.
+  {
+    bool thrown = false;
+    try {
+      dyno::mapped_poly_vector<Rule, OtherRules> mapped{path.c_str()};
+    } catch (std::runtime_error const&) {
+      thrown = true;
+    }
+    DYNO_CHECK(thrown);
+  }
+
+  // Loading a truncated file fails.
+  {
+    std::string const truncated = "test.flat_poly_vector.truncated.bin";
+    {
+      std::ifstream in{path, std::ios::binary};
+      std::string contents{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+      std::ofstream out{truncated, std::ios::binary};
+      out.write(contents.data(), static_cast<std::streamsize>(contents.size() - 80));
+    }
+    bool thrown = false;
+    try {
+      dyno::mapped_poly_vector<Rule, Rules> mapped{truncated.c_str()};
+    } catch (std::runtime_error const&) {
+      thrown = true;
+    }
+    DYNO_CHECK(thrown);
+    std::remove(truncated.c_str());
+  }
+
+  // Loading a file that doesn't exist fails.
+  {
+    bool thrown = false;
+    try {
+      dyno::mapped_poly_vector<Rule, Rules> mapped{"does-not-exist.bin"};
+    } catch (std::system_error const&) {
+      thrown = true;
+    }
+    DYNO_CHECK(thrown);
+  }
+
+  // An empty container can be written and loaded.
+  {
+    dyno::flat_poly_vector<Rule, Rules> empty;
+    {
+      std::ofstream out{path, std::ios::binary};
+      empty.write(out);
+    }
+    dyno::mapped_poly_vector<Rule, Rules> mapped{path.c_str()};
+    DYNO_CHECK(mapped.empty());
+    DYNO_CHECK(mapped.begin() == mapped.end());
+  }
+
+  std::remove(path.c_str());
+}
@@ -0,0 +1,31 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/flat_poly_vector.hpp>
+using namespace dyno::literals;
+
+
+// This test makes sure that we can't push an object whose type is not in the
+// model registry of a `dyno::flat_poly_vector`, since it could not be found
+// again when loading the container.
+
+struct Concept : decltype(dyno::requires_(
+  "f"_s = dyno::method<int () const>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<Concept, T> = dyno::make_concept_map(
+  "f"_s = [](T const&) { return 111; }
+);
+
+struct Foo { };
+struct Bar { };
+
+int main() {
+  dyno::flat_poly_vector<Concept, dyno::model_registry<Foo>> v;
+  // MESSAGE[dyno::flat_poly_vector::push_back: The type of the object must be in the model registry]
+  v.push_back(Bar{});
+}
@@ -0,0 +1,144 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/function.hpp>
+
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+
+struct ToStringAdd {
+  ToStringAdd(int num) : num_(num) { }
+  std::string to_string_add(int i) const { return std::to_string(num_ + i); }
+  int num_;
+};
+
+struct ToString {
+  std::string operator()(int i) const { return std::to_string(i); }
+};
+
+template <template <typename ...> class Function>
+void test() {
+  // store a free function
+  {
+    Function<std::string(int)> tostring = std::to_string;
+    DYNO_CHECK(tostring(1) == "1");
+    DYNO_CHECK(tostring(-10) == "-10");
+  }
+
+  // store a lambda
+  {
+    auto lambda = [](std::string const& s) { return s.size(); };
+    Function<int(std::string const&)> size = lambda;
+    DYNO_CHECK(size("") == 0);
+    DYNO_CHECK(size("abc") == 3);
+  }
+
+  // store a lambda too large for the small buffer
+  {
+    std::array<int, 32> big{};
+    big[31] = 3;
+    Function<int(int)> f = [big](int i) { return big[31] + i; };
+    DYNO_CHECK(f(1) == 4);
+  }
+
+  // store a mutable lambda
+  {
+    Function<int()> counter = [n = 0]() mutable { return ++n; };
+    DYNO_CHECK(counter() == 1);
+    DYNO_CHECK(counter() == 2);
+  }
+
+  // store a call to a member function and object
+  {
+    ToStringAdd const adder{314159};
+    auto bind = std::bind(&ToStringAdd::to_string_add, adder, std::placeholders::_1);
+    Function<std::string(int)> f = bind;
+    DYNO_CHECK(f(1) == "314160");
+  }
+
+  // store a pointer to member function
+  {
+    ToStringAdd const adder{10};
+    Function<std::string(ToStringAdd const&, int)> f = &ToStringAdd::to_string_add;
+    DYNO_CHECK(f(adder, 1) == "11");
+  }
+
+  // store a function object and call it through a const wrapper
+  {
+    Function<std::string(int) const> const tostring = ToString{};
+    DYNO_CHECK(tostring(18) == "18");
+  }
+
+  // discard the result of the function object
+  {
+    int calls = 0;
+    Function<void()> f = [&calls] { ++calls; return calls; };
+    f();
+    DYNO_CHECK(calls == 1);
+  }
+
+  // move construction and assignment
+  {
+    Function<int(int)> f = [](int i) { return i + 1; };
+    Function<int(int)> g = std::move(f);
+    DYNO_CHECK(g(1) == 2);
+
+    Function<int(int)> h = [](int i) { return i * 2; };
+    h = std::move(g);
+    DYNO_CHECK(h(3) == 4);
+
+    h = [](int i) { return i - 1; };
+    DYNO_CHECK(h(3) == 2);
+  }
+
+  // swap
+  {
+    Function<int()> f = [] { return 1; };
+    Function<int()> g = [] { return 2; };
+    swap(f, g);
+    DYNO_CHECK(f() == 2);
+    DYNO_CHECK(g() == 1);
+  }
+}
+
+int main() {
+  test<dyno::any_function>();
+  test<dyno::unique_function>();
+
+  // copies of an any_function are independent
+  {
+    dyno::any_function<int()> f = [n = 0]() mutable { return ++n; };
+    DYNO_CHECK(f() == 1);
+    dyno::any_function<int()> g = f;
+    DYNO_CHECK(g() == 2);
+    DYNO_CHECK(f() == 2);
+    g = f;
+    DYNO_CHECK(g() == 3);
+  }
+
+  // a unique_function can hold move-only function objects, but is not copyable
+  {
+    auto move_only = [p = std::make_unique<int>(42)] { return *p; };
+    dyno::unique_function<int()> f = std::move(move_only);
+    DYNO_CHECK(f() == 42);
+    static_assert(!std::is_copy_constructible<dyno::unique_function<int()>>{});
+    static_assert(!std::is_copy_assignable<dyno::unique_function<int()>>{});
+    static_assert(!std::is_constructible<dyno::any_function<int()>, decltype(move_only)>{});
+  }
+
+  // an inplace_function stores its function object inline
+  {
+    dyno::inplace_function<32, int(int)> f = [a = 1, b = 2](int i) { return a + b + i; };
+    DYNO_CHECK(f(3) == 6);
+    dyno::inplace_function<32, int(int)> g = f;
+    DYNO_CHECK(g(4) == 7);
+  }
+}
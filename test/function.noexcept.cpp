@@ -0,0 +1,34 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/function.hpp>
+
+#include <type_traits>
+#include <utility>
+
+
+// This test makes sure that `noexcept` signatures produce `noexcept` call
+// operators, and that they can only hold function objects that can't throw.
+
+int main() {
+  using Function = dyno::any_function<int(int) noexcept, int(int, int) const noexcept>;
+
+  auto nothrow = [](auto ...i) noexcept { return (0 + ... + i); };
+  auto may_throw = [](auto ...i) { return (0 + ... + i); };
+
+  static_assert(std::is_constructible<Function, decltype(nothrow)>{});
+  static_assert(!std::is_constructible<Function, decltype(may_throw)>{});
+
+  Function f = nothrow;
+  static_assert(noexcept(f(1)));
+  static_assert(noexcept(std::as_const(f)(1, 2)));
+  DYNO_CHECK(f(1) == 1);
+  DYNO_CHECK(std::as_const(f)(1, 2) == 3);
+
+  dyno::any_function<int(int)> g = nothrow;
+  static_assert(!noexcept(g(1)));
+  DYNO_CHECK(g(4) == 4);
+}
@@ -0,0 +1,91 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/function.hpp>
+
+#include <functional>
+#include <string>
+#include <utility>
+
+
+struct Foo {
+  int get() const { return 3; }
+};
+
+int twice(int i) { return i * 2; }
+
+template <template <typename ...> class Function>
+void test() {
+  // default construction yields the null state
+  {
+    Function<int(int)> f;
+    DYNO_CHECK(!f);
+    DYNO_CHECK(f == nullptr);
+    DYNO_CHECK(nullptr == f);
+
+    bool thrown = false;
+    try { f(1); } catch (std::bad_function_call const&) { thrown = true; }
+    DYNO_CHECK(thrown);
+  }
+
+  // construction from nullptr yields the null state
+  {
+    Function<int(int)> f = nullptr;
+    DYNO_CHECK(!f);
+  }
+
+  // construction from a null function pointer yields the null state
+  {
+    int (*fptr)(int) = nullptr;
+    Function<int(int)> f = fptr;
+    DYNO_CHECK(!f);
+
+    fptr = &twice;
+    Function<int(int)> g = fptr;
+    DYNO_CHECK(g);
+    DYNO_CHECK(g(2) == 4);
+  }
+
+  // construction from a null pointer to member yields the null state
+  {
+    int (Foo::*mptr)() const = nullptr;
+    Function<int(Foo const&)> f = mptr;
+    DYNO_CHECK(!f);
+
+    mptr = &Foo::get;
+    Function<int(Foo const&)> g = mptr;
+    DYNO_CHECK(g != nullptr);
+    DYNO_CHECK(g(Foo{}) == 3);
+  }
+
+  // assigning nullptr resets to the null state
+  {
+    Function<int(int)> f = [](int i) { return i; };
+    DYNO_CHECK(f);
+    f = nullptr;
+    DYNO_CHECK(!f);
+    f = [](int i) { return i + 1; };
+    DYNO_CHECK(f);
+    DYNO_CHECK(f(1) == 2);
+  }
+
+  // the null state can be moved and swapped
+  {
+    Function<int(int)> f;
+    Function<int(int)> g = std::move(f);
+    DYNO_CHECK(!g);
+
+    Function<int(int)> h = [](int i) { return i; };
+    swap(g, h);
+    DYNO_CHECK(g);
+    DYNO_CHECK(!h);
+  }
+}
+
+int main() {
+  test<dyno::any_function>();
+  test<dyno::unique_function>();
+}
@@ -0,0 +1,57 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/function.hpp>
+
+#include <string>
+#include <type_traits>
+
+
+// This test makes sure that function wrappers with several signatures
+// dispatch each call to the right overload of the function object.
+
+struct Overloaded {
+  std::string operator()(int) { return "int"; }
+  std::string operator()(std::string const&) { return "string"; }
+  std::string operator()(int) const { return "int const"; }
+  std::string operator()(int, int) const { return "int, int const"; }
+};
+
+struct OnlyInt {
+  std::string operator()(int) { return "int"; }
+};
+
+int main() {
+  using Function = dyno::any_function<
+    std::string(int),
+    std::string(std::string const&),
+    std::string(int) const,
+    std::string(int, int) const
+  >;
+
+  Function f = Overloaded{};
+  DYNO_CHECK(f(1) == "int");
+  DYNO_CHECK(f(std::string{"abc"}) == "string");
+  DYNO_CHECK(f(1, 2) == "int, int const");
+
+  Function const& cf = f;
+  DYNO_CHECK(cf(1) == "int const");
+  DYNO_CHECK(cf(1, 2) == "int, int const");
+
+  // The function object must support all the signatures.
+  static_assert(!std::is_constructible<Function, OnlyInt>{});
+  static_assert(std::is_constructible<dyno::any_function<std::string(int)>, OnlyInt>{});
+
+  // More than 10 signatures
+  using Many = dyno::unique_function<
+    int(char), int(signed char), int(unsigned char), int(short), int(unsigned short),
+    int(int), int(unsigned), int(long), int(unsigned long), int(long long),
+    int(unsigned long long)
+  >;
+  Many many = [](auto x) { return static_cast<int>(sizeof(x)); };
+  DYNO_CHECK(many(static_cast<unsigned long long>(0)) == sizeof(unsigned long long));
+  DYNO_CHECK(many('c') == 1);
+}
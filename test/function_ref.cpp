@@ -0,0 +1,73 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/function.hpp>
+
+#include <string>
+#include <type_traits>
+
+
+struct Counter {
+  int operator()() { return ++count; }
+  int operator()() const { return -1; }
+  int count = 0;
+};
+
+int apply(dyno::function_ref<int(int)> f, int i) { return f(i); }
+
+// A function_ref is a pointer to the function object, plus one function
+// pointer per signature.
+static_assert(sizeof(dyno::function_ref<int()>) == 2 * sizeof(void*));
+static_assert(sizeof(dyno::function_ref<int(), void(int) const>) == 3 * sizeof(void*));
+
+int main() {
+  // a function_ref refers to the function object, it does not copy it
+  {
+    Counter c;
+    dyno::function_ref<int()> f = c;
+    DYNO_CHECK(f() == 1);
+    DYNO_CHECK(f() == 2);
+    DYNO_CHECK(c.count == 2);
+
+    dyno::function_ref<int()> g = f;
+    DYNO_CHECK(g() == 3);
+    DYNO_CHECK(c.count == 3);
+  }
+
+  // a function_ref can refer to a temporary for the duration of a call
+  {
+    DYNO_CHECK(apply([](int i) { return i * 2; }, 4) == 8);
+    int offset = 3;
+    DYNO_CHECK(apply([&](int i) { return i + offset; }, 4) == 7);
+  }
+
+  // a function_ref can refer to a const function object only through const
+  // signatures
+  {
+    Counter const c{};
+    dyno::function_ref<int() const> f = c;
+    DYNO_CHECK(f() == -1);
+    static_assert(!std::is_constructible<dyno::function_ref<int()>, Counter const&>{});
+    static_assert(std::is_constructible<dyno::function_ref<int()>, Counter&>{});
+  }
+
+  // a function_ref can refer to another function wrapper
+  {
+    dyno::any_function<std::string(int)> tostring = [](int i) { return std::to_string(i); };
+    dyno::function_ref<std::string(int)> f = tostring;
+    DYNO_CHECK(f(12) == "12");
+  }
+
+  // a function_ref can be rebound
+  {
+    auto one = [] { return 1; };
+    auto two = [] { return 2; };
+    dyno::function_ref<int() const> f = one;
+    DYNO_CHECK(f() == 1);
+    f = two;
+    DYNO_CHECK(f() == 2);
+  }
+}
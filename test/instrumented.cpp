@@ -0,0 +1,106 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/instrumented.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/vtable.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <typeinfo>
+#include <vector>
+using namespace dyno::literals;
+
+
+struct Concept : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "f"_s = dyno::function<int (dyno::T const&)>,
+  "g"_s = dyno::method<void (int)>
+)) { };
+
+struct Foo { int value; };
+struct Bar { int value; };
+
+template <typename T>
+auto const dyno::default_concept_map<Concept, T, decltype((void)T::value)> = dyno::make_concept_map(
+  "f"_s = [](T const& self) { return self.value; },
+  "g"_s = [](T& self, int value) { self.value = value; }
+);
+
+dyno::call_statistics find(char const* model, char const* function) {
+  for (dyno::call_statistics const& s : dyno::call_statistics_snapshot()) {
+    if (std::strcmp(s.concept_name, typeid(Concept).name()) == 0 &&
+        std::strcmp(s.model_name, model) == 0 &&
+        std::strcmp(s.function_name, function) == 0)
+      return s;
+  }
+  return dyno::call_statistics{};
+}
+
+int main() {
+  using Counting = dyno::instrumented<>;
+  using Sampling = dyno::instrumented<dyno::vtable<dyno::local<dyno::everything>>, 2>;
+
+  {
+    dyno::poly<Concept, dyno::remote_storage, Counting> foo{Foo{1}};
+    dyno::poly<Concept, dyno::remote_storage, Counting> bar{Bar{2}};
+
+    for (int i = 0; i != 10; ++i)
+      DYNO_CHECK(foo.virtual_("f"_s)(foo) == 1);
+    bar.virtual_("g"_s)(3);
+    DYNO_CHECK(bar.virtual_("f"_s)(bar) == 3);
+
+    // Copies share the statistics of the original object.
+    auto copy = foo;
+    copy.virtual_("f"_s)(copy);
+
+    dyno::call_statistics foo_f = find(typeid(Foo).name(), "f");
+    DYNO_CHECK(foo_f.calls == 11);
+    DYNO_CHECK(foo_f.samples == 0);
+    DYNO_CHECK(find(typeid(Foo).name(), "g").calls == 0);
+    DYNO_CHECK(find(typeid(Foo).name(), "copy-construct").calls == 1);
+    DYNO_CHECK(find(typeid(Bar).name(), "f").calls == 1);
+    DYNO_CHECK(find(typeid(Bar).name(), "g").calls == 1);
+
+    // References share the statistics of the referred-to object.
+    dyno::poly_ref<Concept, Counting> ref{foo};
+    ref.virtual_("f"_s)(ref);
+    DYNO_CHECK(find(typeid(Foo).name(), "f").calls == 12);
+  }
+
+  // Destroying the objects doesn't lose the statistics.
+  DYNO_CHECK(find(typeid(Foo).name(), "destruct").calls == 2);
+
+  // Latency is sampled for one call out of `SampleEvery`.
+  {
+    dyno::poly<Concept, dyno::remote_storage, Sampling> foo{Foo{1}};
+    for (int i = 0; i != 10; ++i)
+      foo.virtual_("g"_s)(i);
+
+    // The statistics for a different vtable policy are kept separately.
+    DYNO_CHECK(find(typeid(Foo).name(), "f").calls == 12);
+
+    std::uint64_t g_calls = 0, g_samples = 0;
+    for (dyno::call_statistics const& s : dyno::call_statistics_snapshot()) {
+      if (std::strcmp(s.model_name, typeid(Foo).name()) == 0 &&
+          std::strcmp(s.function_name, "g") == 0) {
+        g_calls += s.calls;
+        g_samples += s.samples;
+      }
+    }
+    DYNO_CHECK(g_calls == 10);
+    DYNO_CHECK(g_samples == 5);
+  }
+
+  std::ostringstream out;
+  dyno::dump_call_statistics(out);
+  DYNO_CHECK(out.str().find(": 12 calls") != std::string::npos);
+  DYNO_CHECK(out.str().find("latency histogram (5 samples)") != std::string::npos);
+}
@@ -0,0 +1,28 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#define DYNO_NO_INSTRUMENTATION
+#include <dyno/concept.hpp>
+#include <dyno/instrumented.hpp>
+#include <dyno/vtable.hpp>
+
+#include <type_traits>
+using namespace dyno::literals;
+
+
+// This test makes sure that instrumentation compiles to nothing when it is
+// disabled.
+
+struct Concept : decltype(dyno::requires_(
+  "f"_s = dyno::function<void (dyno::T const&)>
+)) { };
+
+using Policy = dyno::vtable<dyno::remote<dyno::everything>>;
+
+static_assert(std::is_same<
+  dyno::instrumented<Policy, 10>::apply<Concept>,
+  Policy::apply<Concept>
+>{}, "");
+
+int main() { }
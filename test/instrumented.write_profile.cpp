@@ -0,0 +1,65 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/instrumented.hpp>
+#include <dyno/poly.hpp>
+
+#include <sstream>
+#include <string>
+using namespace dyno::literals;
+
+
+struct Concept : decltype(dyno::requires_(
+  dyno::MoveConstructible{},
+  "ab"_s = dyno::function<int (dyno::T const&)>,
+  "c"_s = dyno::function<int (dyno::T const&)>,
+  "d"_s = dyno::function<int (dyno::T const&)>
+)) { };
+
+struct Other : decltype(dyno::requires_(
+  "c"_s = dyno::function<int (dyno::T const&)>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<Concept, T> = dyno::make_concept_map(
+  "ab"_s = [](T const&) { return 1; },
+  "c"_s = [](T const&) { return 2; },
+  "d"_s = [](T const&) { return 3; }
+);
+
+template <typename T>
+auto const dyno::default_concept_map<Other, T> = dyno::make_concept_map(
+  "c"_s = [](T const&) { return 2; }
+);
+
+int main() {
+  {
+    dyno::poly<Concept, dyno::remote_storage, dyno::instrumented<>> i{1};
+    dyno::poly<Concept, dyno::remote_storage, dyno::instrumented<>> d{2.0};
+    dyno::poly<Other, dyno::remote_storage, dyno::instrumented<>> other{1};
+
+    // Calls are summed over all the models of the concept.
+    for (int n = 0; n != 5; ++n) i.virtual_("c"_s)(i);
+    for (int n = 0; n != 3; ++n) d.virtual_("c"_s)(d);
+    for (int n = 0; n != 4; ++n) d.virtual_("ab"_s)(d);
+
+    // Calls made through other concepts are not part of the profile.
+    for (int n = 0; n != 100; ++n) other.virtual_("c"_s)(other);
+  }
+
+  std::ostringstream out;
+  dyno::write_profile<Concept>(out, "ConceptProfile");
+  DYNO_CHECK(out.str() ==
+    "struct ConceptProfile : dyno::profile<\n"
+    "  dyno::profile_entry<dyno::detail::string<99>, 8>, // c\n"
+    "  dyno::profile_entry<dyno::detail::string<97, 98>, 4>, // ab\n"
+    "  dyno::profile_entry<dyno::detail::string<100, 101, 115, 116, 114, 117, 99, 116>, 2> // destruct\n"
+    "> { };\n"
+  );
+}
@@ -0,0 +1,144 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/multimethod.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/vtable.hpp>
+
+#include <string>
+using namespace dyno::literals;
+
+
+struct Shape : decltype(dyno::requires_(
+  dyno::MoveConstructible{},
+  "collide"_s = dyno::multimethod<std::string (dyno::T const&, dyno::T const&)>,
+  "scaled_collide"_s = dyno::multimethod<int (int, dyno::T const&, dyno::T const&)>
+)) { };
+
+// Multimethods declared in a refined concept are also available.
+struct Solid : decltype(dyno::requires_(
+  Shape{},
+  "name"_s = dyno::method<std::string () const>
+)) { };
+
+// An unrelated concept with a multimethod of the same name and signature,
+// which must not share the dispatch table of `Shape`.
+struct Particle : decltype(dyno::requires_(
+  dyno::MoveConstructible{},
+  "collide"_s = dyno::multimethod<std::string (dyno::T const&, dyno::T const&)>
+)) { };
+
+struct Circle { };
+struct Square { };
+struct Triangle { };
+
+template <typename T>
+auto const dyno::default_concept_map<Solid, T> = dyno::make_concept_map(
+  "name"_s = [](T const&) { return std::string{"solid"}; }
+);
+
+int main() {
+  dyno::define_multimethod<Shape>("collide"_s, [](Circle const&, Circle const&) {
+    return std::string{"circle-circle"};
+  });
+  dyno::define_multimethod<Shape>("collide"_s, [](Circle const&, Square const&) {
+    return std::string{"circle-square"};
+  });
+  dyno::define_multimethod<Shape>("collide"_s, [](Square const&, Circle const&) {
+    return std::string{"square-circle"};
+  });
+
+  dyno::poly<Shape> circle{Circle{}};
+  dyno::poly<Shape> square{Square{}};
+  dyno::poly<Shape> triangle{Triangle{}};
+
+  // Dispatch on the dynamic type of both arguments
+  {
+    DYNO_CHECK(circle.virtual_("collide"_s)(circle, circle) == "circle-circle");
+    DYNO_CHECK(circle.virtual_("collide"_s)(circle, square) == "circle-square");
+    DYNO_CHECK(circle.virtual_("collide"_s)(square, circle) == "square-circle");
+  }
+
+  // Without a fallback, an exception is thrown for missing combinations
+  {
+    bool thrown = false;
+    try {
+      circle.virtual_("collide"_s)(square, square);
+    } catch (dyno::bad_multimethod_call const&) {
+      thrown = true;
+    }
+    DYNO_CHECK(thrown);
+  }
+
+  // With a fallback, it is used for missing combinations
+  {
+    dyno::define_multimethod_fallback<Shape>("collide"_s, [] {
+      return std::string{"fallback"};
+    });
+    DYNO_CHECK(circle.virtual_("collide"_s)(square, square) == "fallback");
+    DYNO_CHECK(circle.virtual_("collide"_s)(circle, triangle) == "fallback");
+    DYNO_CHECK(circle.virtual_("collide"_s)(circle, square) == "circle-square");
+  }
+
+  // Implementations can be added later, including for types never seen before
+  {
+    dyno::define_multimethod<Shape>("collide"_s, [](Triangle const&, Triangle const&) {
+      return std::string{"triangle-triangle"};
+    });
+    DYNO_CHECK(circle.virtual_("collide"_s)(triangle, triangle) == "triangle-triangle");
+    DYNO_CHECK(circle.virtual_("collide"_s)(circle, circle) == "circle-circle");
+    DYNO_CHECK(circle.virtual_("collide"_s)(triangle, circle) == "fallback");
+  }
+
+  // Non-placeholder arguments are forwarded to the implementation and the fallback
+  {
+    dyno::define_multimethod<Shape>("scaled_collide"_s, [](int scale, Circle const&, Square const&) {
+      return scale * 2;
+    });
+    dyno::define_multimethod_fallback<Shape>("scaled_collide"_s, [](int scale) {
+      return -scale;
+    });
+    DYNO_CHECK(circle.virtual_("scaled_collide"_s)(3, circle, square) == 6);
+    DYNO_CHECK(circle.virtual_("scaled_collide"_s)(3, square, circle) == -3);
+  }
+
+  // Multimethods declared in different concepts don't share their dispatch
+  // table, even when they have the same name and signature
+  {
+    dyno::define_multimethod<Particle>("collide"_s, [](Circle const&, Square const&) {
+      return std::string{"particles"};
+    });
+    dyno::poly<Particle> pc{Circle{}};
+    dyno::poly<Particle> ps{Square{}};
+    DYNO_CHECK(pc.virtual_("collide"_s)(pc, ps) == "particles");
+    DYNO_CHECK(circle.virtual_("collide"_s)(circle, square) == "circle-square");
+
+    bool thrown = false;
+    try {
+      pc.virtual_("collide"_s)(ps, pc);
+    } catch (dyno::bad_multimethod_call const&) {
+      thrown = true;
+    }
+    DYNO_CHECK(thrown);
+  }
+
+  // The dispatch table is shared with polys of refined concepts and other
+  // vtable policies
+  {
+    dyno::poly<Solid, dyno::remote_storage, dyno::vtable<dyno::local<dyno::everything>>> c{Circle{}};
+    dyno::poly<Solid, dyno::remote_storage, dyno::vtable<dyno::local<dyno::everything>>> s{Square{}};
+    DYNO_CHECK(c.virtual_("collide"_s)(c, s) == "circle-square");
+    DYNO_CHECK(c.virtual_("name"_s)() == "solid");
+
+    dyno::define_multimethod<Solid>("collide"_s, [](Square const&, Square const&) {
+      return std::string{"square-square"};
+    });
+    DYNO_CHECK(circle.virtual_("collide"_s)(square, square) == "square-square");
+  }
+}
@@ -0,0 +1,98 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/multiversion.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/vtable.hpp>
+
+#include <string>
+using namespace dyno::literals;
+
+
+struct never {
+  static bool supported() { return false; }
+};
+
+struct always {
+  static bool supported() { return true; }
+};
+
+struct Kernel : decltype(dyno::requires_(
+  "run"_s = dyno::method<std::string (int) const>,
+  "reset"_s = dyno::method<void ()>,
+  "level"_s = dyno::function<int ()>
+)) { };
+
+struct kernel {
+  int runs = 0;
+};
+
+// The first supported implementation is used, and the fallback when no
+// instruction set is supported.
+template <>
+auto const dyno::concept_map<Kernel, kernel> = dyno::make_concept_map(
+  "run"_s = dyno::multiversion<never, always>(
+    [](kernel const&, int x) { return "never" + std::to_string(x); },
+    [](kernel const&, int x) { return "always" + std::to_string(x); },
+    [](kernel const&, int x) { return "fallback" + std::to_string(x); }
+  ),
+  "reset"_s = dyno::multiversion<never>(
+    [](kernel& self) { self.runs = -1; },
+    [](kernel& self) { self.runs = 0; }
+  ),
+  "level"_s = dyno::multiversion<dyno::isa::avx512f, dyno::isa::avx2, dyno::isa::sse4_2>(
+    []() { return 3; },
+    []() { return 2; },
+    []() { return 1; },
+    []() { return 0; }
+  )
+);
+
+static int expected_level() {
+#if defined(DYNO_HAS_CPU_SUPPORTS)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return 3;
+  if (__builtin_cpu_supports("avx2"))
+    return 2;
+  if (__builtin_cpu_supports("sse4.2"))
+    return 1;
+#endif
+  return 0;
+}
+
+// Polys used during the dynamic initialization of the program must work,
+// regardless of the order in which the static vtables are initialized.
+static dyno::poly<Kernel, dyno::remote_storage> const global_kernel{kernel{5}};
+static std::string const global_run = global_kernel.virtual_("run"_s)(7);
+static int const global_level = global_kernel.virtual_("level"_s)();
+
+template <typename VTablePolicy>
+static void check() {
+  dyno::poly<Kernel, dyno::remote_storage, VTablePolicy> p{kernel{5}};
+  DYNO_CHECK(p.virtual_("run"_s)(1) == "always1");
+  p.virtual_("reset"_s)();
+  DYNO_CHECK(p.template unsafe_get<kernel>()->runs == 0);
+  DYNO_CHECK(p.virtual_("level"_s)() == expected_level());
+}
+
+int main() {
+  DYNO_CHECK(global_run == "always7");
+  DYNO_CHECK(global_level == expected_level());
+
+  check<dyno::vtable<dyno::remote<dyno::everything>>>();
+  check<dyno::vtable<dyno::local<dyno::everything>>>();
+
+  // Calling the concept map directly gives the same results.
+  auto map = dyno::complete_concept_map<Kernel, kernel>(dyno::concept_map<Kernel, kernel>);
+  kernel k{5};
+  DYNO_CHECK(map["run"_s](k, 2) == "always2");
+  map["reset"_s](k);
+  DYNO_CHECK(k.runs == 0);
+  DYNO_CHECK(map["level"_s]() == expected_level());
+}
@@ -0,0 +1,153 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/storage.hpp>
+#include <dyno/vtable.hpp>
+
+#include <type_traits>
+#include <utility>
+using namespace dyno::literals;
+
+
+// This test makes sure that we can construct a `dyno::poly` from a
+// `dyno::poly` of a refined concept, and that the underlying object is
+// reused (not rebuilt) when moving.
+
+struct Base : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  dyno::MoveConstructible{},
+  "f"_s = dyno::method<int () const>
+)) { };
+
+struct Derived : decltype(dyno::requires_(
+  Base{},
+  "g"_s = dyno::method<int (int) const>
+)) { };
+
+struct Unrelated : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "h"_s = dyno::method<int () const>
+)) { };
+
+struct Foo { int value; };
+struct Bar { int value; };
+
+template <>
+auto const dyno::concept_map<Base, Foo> = dyno::make_concept_map(
+  "f"_s = [](Foo const& foo) { return foo.value; }
+);
+
+template <>
+auto const dyno::concept_map<Derived, Foo> = dyno::make_concept_map(
+  "g"_s = [](Foo const& foo, int i) { return foo.value + i; }
+);
+
+template <>
+auto const dyno::concept_map<Base, Bar> = dyno::make_concept_map(
+  "f"_s = [](Bar const& bar) { return bar.value * 10; }
+);
+
+template <>
+auto const dyno::concept_map<Derived, Bar> = dyno::make_concept_map(
+  "g"_s = [](Bar const& bar, int i) { return bar.value * 10 + i; }
+);
+
+using LocalVTable = dyno::vtable<dyno::local<dyno::everything>>;
+using JoinedVTable = dyno::vtable<
+  dyno::local<dyno::only<decltype("f"_s)>>,
+  dyno::remote<dyno::everything_else>
+>;
+
+template <typename To, typename From>
+void test(bool reuses_storage) {
+  // move: the object is reused when the storage allows it
+  {
+    From derived{Foo{3}};
+    void const* address = derived.template unsafe_get<void>();
+    To base{std::move(derived)};
+    DYNO_CHECK((base.template unsafe_get<void>() == address) == reuses_storage);
+    DYNO_CHECK(base.virtual_("f"_s)() == 3);
+  }
+
+  // copy: both objects are independent
+  {
+    From const derived{Foo{3}};
+    To base{derived};
+    DYNO_CHECK(base.template unsafe_get<void>() != derived.template unsafe_get<void>());
+    DYNO_CHECK(base.virtual_("f"_s)() == 3);
+    DYNO_CHECK(derived.virtual_("f"_s)() == 3);
+    DYNO_CHECK(derived.virtual_("g"_s)(1) == 4);
+  }
+
+  // copy from non-const lvalue
+  {
+    From derived{Foo{3}};
+    To base{derived};
+    DYNO_CHECK(base.virtual_("f"_s)() == 3);
+  }
+
+  // the converted poly can itself be copied
+  {
+    To base{From{Foo{3}}};
+    To copy{base};
+    DYNO_CHECK(copy.virtual_("f"_s)() == 3);
+  }
+
+  // different models get different vtables, and converting the same model
+  // several times works
+  for (int i = 0; i != 3; ++i) {
+    To foo{From{Foo{3}}};
+    To bar{From{Bar{3}}};
+    DYNO_CHECK(foo.virtual_("f"_s)() == 3);
+    DYNO_CHECK(bar.virtual_("f"_s)() == 30);
+  }
+}
+
+int main() {
+  // Remote vtables to remote vtables, which is the default
+  test<dyno::poly<Base>, dyno::poly<Derived>>(true);
+  test<dyno::poly<Base, dyno::remote_storage, JoinedVTable>,
+       dyno::poly<Derived, dyno::remote_storage>>(true);
+
+  test<dyno::poly<Base, dyno::remote_storage, LocalVTable>,
+       dyno::poly<Derived, dyno::remote_storage>>(true);
+  test<dyno::poly<Base, dyno::remote_storage, LocalVTable>,
+       dyno::poly<Derived, dyno::remote_storage, LocalVTable>>(true);
+  test<dyno::poly<Base, dyno::remote_storage, LocalVTable>,
+       dyno::poly<Derived, dyno::remote_storage, JoinedVTable>>(true);
+  test<dyno::poly<Base, dyno::sbo_storage<16>, LocalVTable>,
+       dyno::poly<Derived, dyno::sbo_storage<16>>>(false);
+
+  // A converted poly can be converted again, in which case the vtable is
+  // created from a vtable that was itself created by a conversion
+  for (int i = 0; i != 3; ++i) {
+    dyno::poly<Base> base{dyno::poly<Derived>{Bar{3}}};
+    dyno::poly<Base, dyno::remote_storage, JoinedVTable> joined{std::move(base)};
+    DYNO_CHECK(joined.virtual_("f"_s)() == 30);
+  }
+
+  // Converting between vtable policies of the same concept
+  test<dyno::poly<Derived, dyno::remote_storage, LocalVTable>,
+       dyno::poly<Derived, dyno::remote_storage>>(true);
+
+  // Only refined concepts and identical storage are accepted
+  static_assert(!std::is_constructible<
+    dyno::poly<Unrelated, dyno::remote_storage, LocalVTable>,
+    dyno::poly<Derived, dyno::remote_storage>
+  >{});
+  static_assert(!std::is_constructible<
+    dyno::poly<Derived, dyno::remote_storage, LocalVTable>,
+    dyno::poly<Base, dyno::remote_storage>
+  >{});
+  static_assert(!std::is_constructible<
+    dyno::poly<Base, dyno::sbo_storage<16>, LocalVTable>,
+    dyno::poly<Derived, dyno::remote_storage>
+  >{});
+}
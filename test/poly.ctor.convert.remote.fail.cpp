@@ -0,0 +1,41 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+using namespace dyno::literals;
+
+
+// This test makes sure that we get a nice error message when converting a
+// `dyno::poly` whose vtable is not remote to a `dyno::poly` of a less refined
+// concept with a remote vtable, which can't be done without knowing the
+// concrete type.
+
+struct Base : decltype(dyno::requires_(
+  dyno::MoveConstructible{},
+  "f"_s = dyno::method<int () const>
+)) { };
+
+struct Derived : decltype(dyno::requires_(
+  Base{},
+  "g"_s = dyno::method<int () const>
+)) { };
+
+struct Foo { };
+
+template <>
+auto const dyno::concept_map<Derived, Foo> = dyno::make_concept_map(
+  "f"_s = [](Foo const&) { return 1; },
+  "g"_s = [](Foo const&) { return 2; }
+);
+
+using LocalVTable = dyno::vtable<dyno::local<dyno::everything>>;
+
+int main() {
+  dyno::poly<Derived, dyno::remote_storage, LocalVTable> derived{Foo{}};
+  // MESSAGE[dyno::remote_vtable: Trying to construct a remote vtable from a vtable that is not remote]
+  dyno::poly<Base> base{std::move(derived)};
+}
@@ -0,0 +1,58 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+
+#include <string>
+#include <typeinfo>
+using namespace dyno::literals;
+
+
+// This test makes sure that a `dyno::poly` can hold another `dyno::poly`
+// when the concept of the inner `dyno::poly` does not refine the concept of
+// the outer one, as long as there is a concept map for it.
+
+struct Inner : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "value"_s = dyno::method<int () const>
+)) { };
+
+struct Outer : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  dyno::TypeId{},
+  "describe"_s = dyno::method<std::string () const>
+)) { };
+
+struct Foo { int value; };
+
+template <>
+auto const dyno::concept_map<Inner, Foo> = dyno::make_concept_map(
+  "value"_s = [](Foo const& self) { return self.value; }
+);
+
+template <>
+auto const dyno::concept_map<Outer, dyno::poly<Inner>> = dyno::make_concept_map(
+  "describe"_s = [](dyno::poly<Inner> const& self) {
+    return "inner " + std::to_string(self.virtual_("value"_s)());
+  }
+);
+
+int main() {
+  dyno::poly<Inner> in{Foo{3}};
+
+  dyno::poly<Outer> out{in};
+  DYNO_CHECK(out.virtual_("describe"_s)() == "inner 3");
+  DYNO_CHECK(out.virtual_("typeid"_s)() == typeid(dyno::poly<Inner>));
+
+  dyno::poly<Outer> moved{dyno::poly<Inner>{Foo{4}}};
+  DYNO_CHECK(moved.virtual_("describe"_s)() == "inner 4");
+
+  dyno::poly<Outer> copy = out;
+  DYNO_CHECK(copy.virtual_("describe"_s)() == "inner 3");
+}
@@ -0,0 +1,164 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/storage.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+using namespace dyno::literals;
+
+
+struct Key : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  dyno::Hashable{},
+  "value"_s = dyno::method<int () const>,
+  "twice"_s = dyno::function<int (dyno::T const&)>,
+  "set"_s = dyno::method<void (int)>
+)) { };
+
+int hash_calls = 0;
+
+struct Foo { int value; };
+
+template <>
+auto const dyno::concept_map<Key, Foo> = dyno::make_concept_map(
+  "hash"_s = [](Foo const& foo) -> std::size_t { ++hash_calls; return std::hash<int>{}(foo.value); },
+  "value"_s = [](Foo const& foo) { return foo.value; },
+  "twice"_s = [](Foo const& foo) { return 2 * foo.value; },
+  "set"_s = [](Foo& foo, int value) { foo.value = value; }
+);
+
+struct NotHashable : decltype(dyno::requires_(
+  dyno::CopyConstructible{}
+)) { };
+
+// std::hash is disabled for polys whose concept doesn't contain Hashable.
+static_assert(!std::is_default_constructible<std::hash<dyno::poly<NotHashable>>>{}, "");
+static_assert(std::is_default_constructible<std::hash<dyno::poly<Key>>>{}, "");
+
+struct key_equal {
+  template <typename Poly>
+  bool operator()(Poly const& a, Poly const& b) const {
+    return a.virtual_("value"_s)() == b.virtual_("value"_s)();
+  }
+};
+
+template <typename Storage>
+void test_unordered_set() {
+  using Poly = dyno::poly<Key, Storage>;
+  std::unordered_set<Poly, std::hash<Poly>, key_equal> set;
+  for (int i = 0; i != 100; ++i)
+    set.insert(Poly{Foo{i}});
+  DYNO_CHECK(set.size() == 100);
+  for (int i = 0; i != 100; ++i)
+    DYNO_CHECK(set.count(Poly{Foo{i}}) == 1);
+  DYNO_CHECK(set.count(Poly{Foo{100}}) == 0);
+}
+
+int main() {
+  // The default concept map uses std::hash.
+  {
+    using Poly = dyno::poly<decltype(dyno::requires_(dyno::CopyConstructible{}, dyno::Hashable{}))>;
+    std::string s = "hello world";
+    Poly p{s};
+    DYNO_CHECK(std::hash<Poly>{}(p) == std::hash<std::string>{}(s));
+  }
+
+  // Without caching, the hash is computed every time.
+  {
+    using Poly = dyno::poly<Key, dyno::remote_storage>;
+    Poly p{Foo{3}};
+    hash_calls = 0;
+    DYNO_CHECK(std::hash<Poly>{}(p) == std::hash<int>{}(3));
+    DYNO_CHECK(std::hash<Poly>{}(p) == std::hash<int>{}(3));
+    DYNO_CHECK(hash_calls == 2);
+  }
+
+  // With caching, the hash is computed once, and it survives copies and moves.
+  {
+    using Poly = dyno::poly<Key, dyno::cached_hash_storage<dyno::remote_storage>>;
+    Poly const p{Foo{3}};
+    hash_calls = 0;
+    DYNO_CHECK(std::hash<Poly>{}(p) == std::hash<int>{}(3));
+    DYNO_CHECK(std::hash<Poly>{}(p) == std::hash<int>{}(3));
+    DYNO_CHECK(hash_calls == 1);
+
+    Poly copy{p};
+    Poly moved{std::move(copy)};
+    DYNO_CHECK(std::hash<Poly>{}(moved) == std::hash<int>{}(3));
+    DYNO_CHECK(hash_calls == 1);
+  }
+
+  // Modifying the object invalidates the cached hash, but functions that
+  // can't modify it don't, even when called on a non-const poly.
+  {
+    using Poly = dyno::poly<Key, dyno::cached_hash_storage<dyno::sbo_storage<16>>>;
+    Poly p{Foo{3}};
+    hash_calls = 0;
+    DYNO_CHECK(std::hash<Poly>{}(p) == std::hash<int>{}(3));
+    DYNO_CHECK(p.virtual_("value"_s)() == 3);
+    DYNO_CHECK(p.virtual_("twice"_s)(p) == 6);
+    DYNO_CHECK(std::hash<Poly>{}(p) == std::hash<int>{}(3));
+    DYNO_CHECK(hash_calls == 1);
+    p.virtual_("set"_s)(4);
+    DYNO_CHECK(std::hash<Poly>{}(p) == std::hash<int>{}(4));
+    DYNO_CHECK(hash_calls == 2);
+  }
+
+  // Once the object has been borrowed mutably, it can be modified without
+  // going through the poly, so the hash is not cached anymore. Borrowing it
+  // as const keeps the cache.
+  {
+    using Poly = dyno::poly<Key, dyno::cached_hash_storage<dyno::remote_storage>>;
+    Poly p{Foo{3}};
+    dyno::poly_cref<Key> cr{p};
+    hash_calls = 0;
+    DYNO_CHECK(std::hash<Poly>{}(p) == std::hash<int>{}(3));
+    DYNO_CHECK(std::hash<Poly>{}(p) == std::hash<int>{}(3));
+    DYNO_CHECK(hash_calls == 1);
+
+    dyno::poly_ref<Key> r{p};
+    DYNO_CHECK(std::hash<Poly>{}(p) == std::hash<int>{}(3));
+    r.virtual_("set"_s)(4);
+    DYNO_CHECK(p.virtual_("value"_s)() == 4);
+    DYNO_CHECK(std::hash<Poly>{}(p) == std::hash<int>{}(4));
+
+    Poly moved{std::move(p)};
+    r.virtual_("set"_s)(5);
+    DYNO_CHECK(std::hash<Poly>{}(moved) == std::hash<int>{}(5));
+
+    Poly copy{moved};
+    hash_calls = 0;
+    DYNO_CHECK(std::hash<Poly>{}(copy) == std::hash<int>{}(5));
+    DYNO_CHECK(std::hash<Poly>{}(copy) == std::hash<int>{}(5));
+    DYNO_CHECK(hash_calls == 1);
+  }
+
+  // Swapping swaps the cached hashes.
+  {
+    using Poly = dyno::poly<Key, dyno::cached_hash_storage<dyno::remote_storage>>;
+    Poly a{Foo{1}}, b{Foo{2}};
+    std::hash<Poly>{}(a);
+    std::hash<Poly>{}(b);
+    hash_calls = 0;
+    a.swap(b);
+    DYNO_CHECK(std::hash<Poly>{}(a) == std::hash<int>{}(2));
+    DYNO_CHECK(std::hash<Poly>{}(b) == std::hash<int>{}(1));
+    DYNO_CHECK(hash_calls == 0);
+  }
+
+  test_unordered_set<dyno::remote_storage>();
+  test_unordered_set<dyno::sbo_storage<16>>();
+  test_unordered_set<dyno::cached_hash_storage<dyno::remote_storage>>();
+  test_unordered_set<dyno::cached_hash_storage<dyno::sbo_storage<16>>>();
+}
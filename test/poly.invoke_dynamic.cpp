@@ -0,0 +1,120 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+
+#include <any>
+#include <functional>
+#include <string>
+#include <typeinfo>
+#include <vector>
+using namespace dyno::literals;
+
+
+struct Counter : decltype(dyno::requires_(
+  "add"_s = dyno::method<void (int)>,
+  "get"_s = dyno::method<int () const>,
+  "scale"_s = dyno::method<int (int, double) const>,
+  "name"_s = dyno::function<std::string (dyno::T const&)>,
+  "reset"_s = dyno::function<void (dyno::T&, int)>,
+  "drain"_s = dyno::method<void (std::vector<int>&)>,
+  "merge"_s = dyno::function<void (dyno::T&, dyno::T const&)>
+)) { };
+
+struct counter {
+  int value;
+};
+
+template <>
+auto const dyno::concept_map<Counter, counter> = dyno::make_concept_map(
+  "add"_s = [](counter& self, int x) { self.value += x; },
+  "get"_s = [](counter const& self) { return self.value; },
+  "scale"_s = [](counter const& self, int x, double f) { return static_cast<int>(self.value * x * f); },
+  "name"_s = [](counter const&) { return std::string{"counter"}; },
+  "reset"_s = [](counter& self, int x) { self.value = x; },
+  "drain"_s = [](counter& self, std::vector<int>& out) { out.push_back(self.value); self.value = 0; },
+  "merge"_s = [](counter& self, counter const& other) { self.value += other.value; }
+);
+
+template <typename F>
+static bool throws_bad_dynamic_call(F f) {
+  try {
+    f();
+  } catch (dyno::bad_dynamic_call const&) {
+    return true;
+  }
+  return false;
+}
+
+template <typename F>
+static bool throws_bad_any_cast(F f) {
+  try {
+    f();
+  } catch (std::bad_any_cast const&) {
+    return true;
+  }
+  return false;
+}
+
+int main() {
+  dyno::poly<Counter> p{counter{1}};
+
+  // Methods
+  {
+    std::any args[] = {41};
+    DYNO_CHECK(!p.invoke_dynamic("add", args, 1).has_value());
+    DYNO_CHECK(std::any_cast<int>(p.invoke_dynamic("get", nullptr, 0)) == 42);
+
+    std::any scale_args[] = {2, 0.5};
+    DYNO_CHECK(std::any_cast<int>(p.invoke_dynamic("scale", scale_args, 2)) == 42);
+  }
+
+  // Functions taking the object as their first parameter
+  {
+    DYNO_CHECK(std::any_cast<std::string>(p.invoke_dynamic("name", nullptr, 0)) == "counter");
+    std::any args[] = {3};
+    p.invoke_dynamic("reset", args, 1);
+    DYNO_CHECK(p.virtual_("get"_s)() == 3);
+  }
+
+  // Non-const lvalue references are passed as `std::reference_wrapper`s
+  {
+    std::vector<int> out;
+    std::any args[] = {std::ref(out)};
+    p.invoke_dynamic("drain", args, 1);
+    DYNO_CHECK((out == std::vector<int>{3}));
+    DYNO_CHECK(p.virtual_("get"_s)() == 0);
+  }
+
+  // Only const methods can be called on a const poly
+  {
+    dyno::poly<Counter> const& cp = p;
+    std::any args[] = {1};
+    DYNO_CHECK(std::any_cast<int>(cp.invoke_dynamic("get", nullptr, 0)) == 0);
+    DYNO_CHECK(std::any_cast<std::string>(cp.invoke_dynamic("name", nullptr, 0)) == "counter");
+    DYNO_CHECK(throws_bad_dynamic_call([&] { cp.invoke_dynamic("add", args, 1); }));
+    DYNO_CHECK(throws_bad_dynamic_call([&] { cp.invoke_dynamic("reset", args, 1); }));
+  }
+
+  // Errors
+  {
+    std::any args[] = {1, 2};
+    DYNO_CHECK(throws_bad_dynamic_call([&] { p.invoke_dynamic("unknown", args, 0); }));
+    DYNO_CHECK(throws_bad_dynamic_call([&] { p.invoke_dynamic("", args, 0); }));
+    DYNO_CHECK(throws_bad_dynamic_call([&] { p.invoke_dynamic("ad", args, 1); }));
+    DYNO_CHECK(throws_bad_dynamic_call([&] { p.invoke_dynamic("add", args, 2); }));
+
+    // Functions taking the object in another parameter can't be called.
+    DYNO_CHECK(throws_bad_dynamic_call([&] { p.invoke_dynamic("merge", args, 1); }));
+
+    std::any wrong[] = {std::string{"1"}};
+    DYNO_CHECK(throws_bad_any_cast([&] { p.invoke_dynamic("add", wrong, 1); }));
+    DYNO_CHECK(throws_bad_any_cast([&] { p.invoke_dynamic("drain", wrong, 1); }));
+    DYNO_CHECK(p.virtual_("get"_s)() == 0);
+  }
+}
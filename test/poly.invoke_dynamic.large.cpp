@@ -0,0 +1,63 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/vtable.hpp>
+
+#include <any>
+#include <string>
+using namespace dyno::literals;
+
+
+// This test makes sure that `invoke_dynamic` works with concepts that have
+// a large number of clauses, whose perfect hash table must still be built
+// at compile-time in a reasonable amount of time.
+
+#define CLAUSE(n) "m" #n ""_s = dyno::method<int (int) const>
+#define IMPL(n) "m" #n ""_s = [](counter const& self, int x) { return self.value * x + n; }
+
+#define TEN(X, p) X(p##0), X(p##1), X(p##2), X(p##3), X(p##4), \
+                  X(p##5), X(p##6), X(p##7), X(p##8), X(p##9)
+#define HUNDRED(X)                                                   \
+  X(0), X(1), X(2), X(3), X(4), X(5), X(6), X(7), X(8), X(9),       \
+  TEN(X, 1), TEN(X, 2), TEN(X, 3), TEN(X, 4), TEN(X, 5), TEN(X, 6), \
+  TEN(X, 7), TEN(X, 8), TEN(X, 9)
+
+struct Large : decltype(dyno::requires_(
+  HUNDRED(CLAUSE)
+)) { };
+
+struct counter {
+  int value;
+};
+
+template <>
+auto const dyno::concept_map<Large, counter> = dyno::make_concept_map(
+  HUNDRED(IMPL)
+);
+
+int main() {
+  dyno::poly<Large, dyno::remote_storage, dyno::vtable<dyno::remote<dyno::everything>>> p{counter{10}};
+
+  for (int n = 0; n != 100; ++n) {
+    std::any args[] = {2};
+    std::any result = p.invoke_dynamic("m" + std::to_string(n), args, 1);
+    DYNO_CHECK(std::any_cast<int>(result) == 20 + n);
+  }
+
+  for (char const* name : {"m100", "m", "", "m00", "m1000", "n0"}) {
+    bool thrown = false;
+    try {
+      std::any args[] = {2};
+      p.invoke_dynamic(name, args, 1);
+    } catch (dyno::bad_dynamic_call const&) {
+      thrown = true;
+    }
+    DYNO_CHECK(thrown);
+  }
+}
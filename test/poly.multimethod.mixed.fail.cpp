@@ -0,0 +1,30 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/multimethod.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/storage.hpp>
+using namespace dyno::literals;
+
+
+// This test makes sure that we get a nice error message when calling a
+// multimethod with polys of different types.
+
+struct Shape : decltype(dyno::requires_(
+  dyno::MoveConstructible{},
+  "collide"_s = dyno::multimethod<int (dyno::T const&, dyno::T const&)>
+)) { };
+
+struct Circle { };
+struct Square { };
+
+int main() {
+  dyno::poly<Shape> circle{Circle{}};
+  dyno::poly<Shape, dyno::sbo_storage<16>> square{Square{}};
+  // MESSAGE[dyno::poly::virtual_: The arguments passed for the placeholders of a multimethod must be of the same dyno::poly type]
+  circle.virtual_("collide"_s)(circle, square);
+}
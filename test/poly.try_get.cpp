@@ -0,0 +1,95 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/storage.hpp>
+#include <dyno/vtable.hpp>
+
+#include <string>
+#include <type_traits>
+using namespace dyno::literals;
+
+
+struct Concept : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "get"_s = dyno::method<int () const>
+)) { };
+
+struct Foo { int value; };
+struct Bar { int value; };
+
+template <typename T>
+auto const dyno::default_concept_map<Concept, T, decltype((void)T::value)> = dyno::make_concept_map(
+  "get"_s = [](T const& self) { return self.value; }
+);
+
+template <typename Storage, typename VTablePolicy>
+void test() {
+  using Poly = dyno::poly<Concept, Storage, VTablePolicy>;
+
+  {
+    Poly foo{Foo{1}};
+    Foo* f = foo.template try_get<Foo>();
+    DYNO_CHECK(f != nullptr);
+    DYNO_CHECK(f == foo.template unsafe_get<Foo>());
+    DYNO_CHECK(foo.template try_get<Bar>() == nullptr);
+    DYNO_CHECK(foo.template try_get<std::string>() == nullptr);
+
+    Poly const& cfoo = foo;
+    static_assert(std::is_same<decltype(cfoo.template try_get<Foo>()), Foo const*>{}, "");
+    DYNO_CHECK(cfoo.template try_get<Foo>() == f);
+    DYNO_CHECK(cfoo.template try_get<Bar>() == nullptr);
+  }
+
+  // The type is still recognized after copies, moves and swaps.
+  {
+    Poly foo{Foo{1}};
+    Poly bar{Bar{2}};
+    Poly copy{foo};
+    DYNO_CHECK(copy.template try_get<Foo>() != nullptr);
+    Poly moved{std::move(copy)};
+    DYNO_CHECK(moved.template try_get<Foo>() != nullptr);
+
+    foo.swap(bar);
+    DYNO_CHECK(foo.template try_get<Bar>() != nullptr);
+    DYNO_CHECK(foo.template try_get<Bar>()->value == 2);
+    DYNO_CHECK(bar.template try_get<Foo>() != nullptr);
+    DYNO_CHECK(bar.template try_get<Foo>()->value == 1);
+  }
+
+  // Polys created with a custom concept map are not recognized.
+  {
+    Poly foo{Foo{1}, dyno::make_concept_map(
+      "get"_s = [](Foo const&) { return 42; }
+    )};
+    DYNO_CHECK(foo.template try_get<Foo>() == nullptr);
+  }
+
+  // References to a poly recognize the type of the referred-to object.
+  {
+    Poly foo{Foo{1}};
+    dyno::poly_ref<Concept, VTablePolicy> ref{foo};
+    DYNO_CHECK(ref.template try_get<Foo>() == foo.template try_get<Foo>());
+    dyno::poly_cref<Concept, VTablePolicy> cref{foo};
+    static_assert(std::is_same<decltype(cref.template try_get<Foo>()), Foo const*>{}, "");
+    DYNO_CHECK(cref.template try_get<Foo>() == foo.template try_get<Foo>());
+    DYNO_CHECK(cref.template try_get<Bar>() == nullptr);
+  }
+}
+
+int main() {
+  using Remote = dyno::vtable<dyno::remote<dyno::everything>>;
+  using Joined = dyno::vtable<dyno::local<dyno::only<decltype("get"_s)>>,
+                              dyno::remote<dyno::everything_else>>;
+
+  test<dyno::remote_storage, Remote>();
+  test<dyno::sbo_storage<16>, Remote>();
+  test<dyno::remote_storage, Joined>();
+  test<dyno::sbo_storage<16>, Joined>();
+}
@@ -0,0 +1,29 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/vtable.hpp>
+using namespace dyno::literals;
+
+
+// This test makes sure that we can't use `try_get` when all the functions
+// are stored in a local vtable, since the type can't be identified then.
+
+struct Concept : decltype(dyno::requires_(
+  "get"_s = dyno::method<int () const>
+)) { };
+
+struct Foo { int value; };
+
+template <>
+auto const dyno::concept_map<Concept, Foo> = dyno::make_concept_map(
+  "get"_s = [](Foo const& foo) { return foo.value; }
+);
+
+int main() {
+  dyno::poly<Concept, dyno::remote_storage, dyno::vtable<dyno::local<dyno::everything>>> poly{Foo{0}};
+  poly.try_get<Foo>();
+}
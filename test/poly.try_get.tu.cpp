@@ -0,0 +1,35 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+#include "try_get/shape.hpp"
+
+#include <dyno/poly.hpp>
+
+
+// This test makes sure that `try_get` recognizes objects stored in a
+// `dyno::poly` created in another translation unit. The polys are created
+// in `try_get/make.cpp`.
+
+int main() {
+  {
+    dyno::poly<Shape> s = make_square(3);
+    square* sq = s.try_get<square>();
+    DYNO_CHECK(sq != nullptr);
+    DYNO_CHECK(sq->side == 3);
+    DYNO_CHECK(s.try_get<int>() == nullptr);
+
+    // The static vtable is the same as the one of polys created here.
+    dyno::poly<Shape> local{square{4}};
+    DYNO_CHECK(local.try_get<square>() != nullptr);
+  }
+
+  {
+    auto s = make_joined_square(5);
+    square* sq = s.try_get<square>();
+    DYNO_CHECK(sq != nullptr);
+    DYNO_CHECK(sq->side == 5);
+    DYNO_CHECK(s.virtual_("area"_s)() == 25);
+  }
+}
@@ -0,0 +1,71 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/instrumented.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/vtable.hpp>
+
+#include <cstddef>
+using namespace dyno::literals;
+
+
+struct Container : decltype(dyno::requires_(
+  "size"_s = dyno::method<std::size_t () const, dyno::pure>,
+  "at"_s = dyno::hot(dyno::function<int (dyno::T const&, std::size_t), dyno::pure>),
+  "capacity"_s = dyno::function<std::size_t (), dyno::const_>,
+  "push"_s = dyno::method<void (int)>
+)) { };
+
+// Attributes are part of the clause.
+static_assert(dyno::method<int (), dyno::pure> == dyno::method<int (), dyno::pure>, "");
+static_assert(dyno::method<int (), dyno::pure> != dyno::method<int ()>, "");
+static_assert(dyno::method<int (), dyno::pure> != dyno::method<int (), dyno::const_>, "");
+static_assert(dyno::function<int (), dyno::pure> != dyno::function<int ()>, "");
+
+struct Buffer {
+  int data[8];
+  std::size_t size = 0;
+};
+
+template <>
+auto const dyno::concept_map<Container, Buffer> = dyno::make_concept_map(
+  "size"_s = [](Buffer const& self) { return self.size; },
+  "at"_s = [](Buffer const& self, std::size_t i) { return self.data[i]; },
+  "capacity"_s = []() -> std::size_t { return 8; },
+  "push"_s = [](Buffer& self, int x) { self.data[self.size++] = x; }
+);
+
+template <typename VTablePolicy>
+void test() {
+  dyno::poly<Container, dyno::remote_storage, VTablePolicy> p{Buffer{}};
+  DYNO_CHECK(p.virtual_("capacity"_s)() == 8);
+
+  // Writing through a non-pure method must be seen by the pure ones, even
+  // though the calls before and after have the same arguments.
+  std::size_t before = p.virtual_("size"_s)();
+  p.virtual_("push"_s)(10);
+  std::size_t after = p.virtual_("size"_s)();
+  DYNO_CHECK(before == 0);
+  DYNO_CHECK(after == 1);
+
+  p.virtual_("push"_s)(20);
+  DYNO_CHECK(p.virtual_("size"_s)() == 2);
+  DYNO_CHECK(p.virtual_("at"_s)(p, 0) == 10);
+  DYNO_CHECK(p.virtual_("at"_s)(p, 1) == 20);
+  DYNO_CHECK(p.virtual_("at"_s)(p, 0) + p.virtual_("at"_s)(p, 0) == 20);
+}
+
+int main() {
+  test<dyno::vtable<dyno::remote<dyno::everything>>>();
+  test<dyno::vtable<dyno::local<dyno::everything>>>();
+  test<dyno::auto_vtable<>>();
+
+  // The instrumented vtable doesn't store plain function pointers, so the
+  // attributes are simply ignored.
+  test<dyno::instrumented<>>();
+}
@@ -0,0 +1,28 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+using namespace dyno::literals;
+
+
+struct Concept : decltype(dyno::requires_(
+  "f"_s = dyno::method<void () const, dyno::pure>
+)) { };
+
+struct Foo { };
+
+template <>
+auto const dyno::concept_map<Concept, Foo> = dyno::make_concept_map(
+  "f"_s = [](Foo const&) { }
+);
+
+int main() {
+  dyno::poly<Concept> poly{Foo{}};
+  // MESSAGE[dyno::pure: A function marked as pure or const must not return void]
+  poly.virtual_("f"_s)();
+}
@@ -0,0 +1,71 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/vtable.hpp>
+
+#include <cstddef>
+using namespace dyno::literals;
+
+
+// This test makes sure that the compiler actually merges calls to functions
+// marked as `dyno::pure` or `dyno::const_`, which is the whole point of the
+// attributes. It is compiled with optimizations (see CMakeLists.txt).
+//
+// To observe the merging, the functions below count how many times they are
+// called, which is a side effect. They are hence lying about being pure, which
+// is exactly what lets us see how many calls were made. The counters are
+// `volatile`, since the compiler would otherwise assume that they are not
+// modified by the calls.
+
+struct Container : decltype(dyno::requires_(
+  "size"_s = dyno::method<std::size_t () const, dyno::pure>,
+  "plain_size"_s = dyno::method<std::size_t () const>,
+  "capacity"_s = dyno::function<std::size_t (), dyno::const_>
+)) { };
+
+struct Buffer {
+  std::size_t size;
+};
+
+volatile int size_calls = 0;
+volatile int plain_size_calls = 0;
+volatile int capacity_calls = 0;
+
+template <>
+auto const dyno::concept_map<Container, Buffer> = dyno::make_concept_map(
+  "size"_s = [](Buffer const& self) { size_calls = size_calls + 1; return self.size; },
+  "plain_size"_s = [](Buffer const& self) { plain_size_calls = plain_size_calls + 1; return self.size; },
+  "capacity"_s = []() -> std::size_t { capacity_calls = capacity_calls + 1; return 8; }
+);
+
+template <typename VTablePolicy>
+void test() {
+  dyno::poly<Container, dyno::remote_storage, VTablePolicy> const p{Buffer{3}};
+  size_calls = 0;
+  plain_size_calls = 0;
+  capacity_calls = 0;
+
+  std::size_t size = p.virtual_("size"_s)() + p.virtual_("size"_s)();
+  std::size_t plain_size = p.virtual_("plain_size"_s)() + p.virtual_("plain_size"_s)();
+  std::size_t capacity = p.virtual_("capacity"_s)() + p.virtual_("capacity"_s)();
+
+  DYNO_CHECK(size == 6);
+  DYNO_CHECK(plain_size == 6);
+  DYNO_CHECK(capacity == 16);
+  DYNO_CHECK(size_calls == 1);
+  DYNO_CHECK(plain_size_calls == 2);
+  DYNO_CHECK(capacity_calls == 1);
+}
+
+int main() {
+#if defined(__GNUC__) && defined(__OPTIMIZE__)
+  test<dyno::vtable<dyno::remote<dyno::everything>>>();
+  test<dyno::vtable<dyno::local<dyno::everything>>>();
+#endif
+}
@@ -0,0 +1,29 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+using namespace dyno::literals;
+
+
+// This test makes sure that we can't call a non-const method through a
+// `dyno::poly_cref`.
+
+struct Concept : decltype(dyno::requires_(
+  "set"_s = dyno::method<void (int)>
+)) { };
+
+struct Foo { int value; };
+
+template <>
+auto const dyno::concept_map<Concept, Foo> = dyno::make_concept_map(
+  "set"_s = [](Foo& foo, int value) { foo.value = value; }
+);
+
+int main() {
+  Foo foo{0};
+  dyno::poly_cref<Concept> ref{foo};
+  ref.virtual_("set"_s)(1);
+}
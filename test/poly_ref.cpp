@@ -0,0 +1,151 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/storage.hpp>
+#include <dyno/vtable.hpp>
+
+#include <type_traits>
+using namespace dyno::literals;
+
+
+struct Base : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "get"_s = dyno::method<int () const>
+)) { };
+
+struct Derived : decltype(dyno::requires_(
+  Base{},
+  "set"_s = dyno::method<void (int)>
+)) { };
+
+struct Foo { int value; };
+
+template <>
+auto const dyno::concept_map<Derived, Foo> = dyno::make_concept_map(
+  "get"_s = [](Foo const& foo) { return foo.value; },
+  "set"_s = [](Foo& foo, int value) { foo.value = value; }
+);
+
+template <>
+auto const dyno::concept_map<Base, Foo> = dyno::concept_map<Derived, Foo>;
+
+using LocalVTable = dyno::vtable<dyno::local<dyno::everything>>;
+
+int main() {
+  // Referring to a concrete object
+  {
+    Foo foo{1};
+    dyno::poly_ref<Derived> ref{foo};
+    DYNO_CHECK(ref.unsafe_get<Foo>() == &foo);
+    ref.virtual_("set"_s)(2);
+    DYNO_CHECK(foo.value == 2);
+    DYNO_CHECK(ref.virtual_("get"_s)() == 2);
+  }
+
+  // Referring to a const concrete object
+  {
+    Foo const foo{1};
+    dyno::poly_cref<Derived> ref{foo};
+    DYNO_CHECK(ref.unsafe_get<Foo>() == &foo);
+    DYNO_CHECK(ref.virtual_("get"_s)() == 1);
+  }
+
+  // Borrowing the object held by an owning poly
+  {
+    dyno::poly<Derived> poly{Foo{1}};
+    dyno::poly_ref<Derived> ref{poly};
+    DYNO_CHECK(ref.unsafe_get<void>() == poly.unsafe_get<void>());
+    ref.virtual_("set"_s)(2);
+    DYNO_CHECK(poly.virtual_("get"_s)() == 2);
+
+    dyno::poly_cref<Derived> cref{poly};
+    DYNO_CHECK(cref.unsafe_get<void>() == poly.unsafe_get<void>());
+    DYNO_CHECK(cref.virtual_("get"_s)() == 2);
+
+    dyno::poly<Derived> const& const_poly = poly;
+    dyno::poly_cref<Derived> cref2{const_poly};
+    DYNO_CHECK(cref2.virtual_("get"_s)() == 2);
+  }
+
+  // With the same concept and vtable policy, the vtable is shared
+  {
+    dyno::poly<Derived> poly{Foo{1}};
+    dyno::poly_ref<Derived> ref{poly};
+    static_assert(sizeof(ref) == sizeof(poly));
+  }
+
+  // Borrowing the object held by a poly of a refined concept
+  {
+    dyno::poly<Derived, dyno::sbo_storage<16>> poly{Foo{1}};
+    dyno::poly_ref<Base, LocalVTable> ref{poly};
+    DYNO_CHECK(ref.unsafe_get<void>() == poly.unsafe_get<void>());
+    DYNO_CHECK(ref.virtual_("get"_s)() == 1);
+
+    dyno::poly_cref<Base, LocalVTable> cref{poly};
+    DYNO_CHECK(cref.virtual_("get"_s)() == 1);
+  }
+
+  // Borrowing the object held by a poly of a refined concept, with the
+  // default vtable policy
+  {
+    dyno::poly<Derived> poly{Foo{1}};
+    dyno::poly_ref<Base> ref{poly};
+    DYNO_CHECK(ref.unsafe_get<void>() == poly.unsafe_get<void>());
+    DYNO_CHECK(ref.virtual_("get"_s)() == 1);
+    static_assert(sizeof(ref) == 2 * sizeof(void*));
+
+    dyno::poly_cref<Base> cref{poly};
+    DYNO_CHECK(cref.virtual_("get"_s)() == 1);
+
+    poly.virtual_("set"_s)(2);
+    DYNO_CHECK(ref.virtual_("get"_s)() == 2);
+    DYNO_CHECK(cref.virtual_("get"_s)() == 2);
+  }
+
+  // Converting between references
+  {
+    Foo foo{1};
+    dyno::poly_ref<Derived> ref{foo};
+    dyno::poly_ref<Derived> copy{ref};
+    DYNO_CHECK(copy.unsafe_get<Foo>() == &foo);
+
+    dyno::poly_cref<Derived> cref{ref};
+    DYNO_CHECK(cref.unsafe_get<Foo>() == &foo);
+
+    dyno::poly_ref<Base, LocalVTable> base{ref};
+    DYNO_CHECK(base.unsafe_get<Foo>() == &foo);
+    DYNO_CHECK(base.virtual_("get"_s)() == 1);
+  }
+
+  // Converting between references with the default vtable policy
+  {
+    Foo foo{1};
+    dyno::poly_ref<Derived> ref{foo};
+    dyno::poly_cref<Base> base{ref};
+    DYNO_CHECK(base.unsafe_get<Foo>() == &foo);
+    DYNO_CHECK(base.virtual_("get"_s)() == 1);
+  }
+
+  // Rebinding a reference
+  {
+    Foo foo1{1}, foo2{2};
+    dyno::poly_cref<Derived> ref{foo1};
+    ref = dyno::poly_cref<Derived>{foo2};
+    DYNO_CHECK(ref.virtual_("get"_s)() == 2);
+    DYNO_CHECK(foo1.value == 1);
+  }
+
+  // References can't be obtained from temporaries, and mutable references
+  // can't refer to const objects
+  static_assert(!std::is_constructible<dyno::poly_ref<Derived>, dyno::poly<Derived>>{});
+  static_assert(!std::is_constructible<dyno::poly_cref<Derived>, dyno::poly<Derived>>{});
+  static_assert(!std::is_constructible<dyno::poly_ref<Derived>, dyno::poly<Derived> const&>{});
+  static_assert(!std::is_constructible<dyno::poly_ref<Derived>, dyno::poly_cref<Derived>&>{});
+}
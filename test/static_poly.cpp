@@ -0,0 +1,140 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/multimethod.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/static_poly.hpp>
+
+#include <string>
+#include <type_traits>
+#include <utility>
+using namespace dyno::literals;
+
+
+struct Counter : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "increment"_s = dyno::function<void (dyno::T&)>,
+  "add"_s = dyno::method<void (int)>,
+  "value"_s = dyno::method<int () const>,
+  "steal"_s = dyno::method<int () &&>,
+  "same"_s = dyno::function<bool (dyno::T const&, dyno::T const*)>,
+  "name"_s = dyno::function<std::string ()>,
+  "combine"_s = dyno::multimethod<std::string (dyno::T const&, dyno::T const&)>
+)) { };
+
+struct Simple { int n; };
+struct Fancy { int n; };
+
+// A type that can be constructed from anything, including a `static_poly`.
+struct Greedy {
+  int n;
+  explicit Greedy(int n_) : n{n_} { }
+  template <typename U>
+  explicit Greedy(U const&) : n{-1} { }
+};
+
+template <typename T>
+auto const dyno::default_concept_map<Counter, T> = dyno::make_concept_map(
+  "increment"_s = [](T& self) { ++self.n; },
+  "add"_s = [](T& self, int x) { self.n += x; },
+  "value"_s = [](T const& self) { return self.n; },
+  "steal"_s = [](T&& self) { int n = self.n; self.n = 0; return n; },
+  "same"_s = [](T const& a, T const* b) { return a.n == b->n; },
+  "name"_s = []() { return std::string{"counter"}; }
+);
+
+template <>
+auto const dyno::concept_map<Counter, Fancy> = dyno::make_concept_map(
+  "increment"_s = [](Fancy& self) { self.n += 10; },
+  "name"_s = []() { return std::string{"fancy"}; }
+);
+
+// Generic code written once against the interface of `dyno::poly`.
+template <typename Poly>
+int exercise(Poly& p) {
+  p.virtual_("increment"_s)(p);
+  p->*"increment"_s();
+  p.virtual_("add"_s)(3);
+  Poly copy = p;
+  DYNO_CHECK(p.virtual_("same"_s)(p, &copy));
+  p.virtual_("increment"_s)(copy);
+  DYNO_CHECK(!p.virtual_("same"_s)(p, &copy));
+  return 100 * p.virtual_("value"_s)() + copy.virtual_("value"_s)();
+}
+
+int main() {
+  dyno::define_multimethod<Counter>("combine"_s, [](Simple const& a, Fancy const& b) {
+    return std::to_string(a.n) + "-" + std::to_string(b.n);
+  });
+
+  // Same results in both modes.
+  {
+    dyno::poly<Counter> dynamic{Simple{1}};
+    dyno::static_poly<Counter, Simple> static_{Simple{1}};
+    DYNO_CHECK(exercise(dynamic) == exercise(static_));
+  }
+  {
+    dyno::poly<Counter> dynamic{Fancy{1}};
+    dyno::static_poly<Counter, Fancy> static_{Fancy{1}};
+    DYNO_CHECK(exercise(dynamic) == exercise(static_));
+    DYNO_CHECK(static_.virtual_("name"_s)() == "fancy");
+  }
+
+  // Rvalue methods
+  {
+    dyno::static_poly<Counter, Simple> s{Simple{5}};
+    DYNO_CHECK(std::move(s).virtual_("steal"_s)() == 5);
+    DYNO_CHECK(s.virtual_("value"_s)() == 0);
+  }
+
+  // The size is the size of the object.
+  static_assert(sizeof(dyno::static_poly<Counter, Simple>) == sizeof(Simple), "");
+
+  // The object is constructed explicitly, from arguments it can be
+  // constructed from.
+  static_assert(std::is_constructible<dyno::static_poly<Counter, Simple>, Simple>{}, "");
+  static_assert(!std::is_convertible<Simple, dyno::static_poly<Counter, Simple>>{}, "");
+  static_assert(!std::is_constructible<dyno::static_poly<Counter, Simple>, std::string>{}, "");
+
+  // Copying a non-const static_poly copies it, instead of constructing the
+  // object from the static_poly.
+  {
+    dyno::static_poly<Counter, Greedy> g{5};
+    dyno::static_poly<Counter, Greedy> copy{g};
+    DYNO_CHECK(copy.virtual_("value"_s)() == 5);
+  }
+
+  // Access to the object.
+  {
+    dyno::static_poly<Counter, Simple> s{Simple{7}};
+    DYNO_CHECK(s.unsafe_get<Simple>()->n == 7);
+    DYNO_CHECK(s.try_get<Simple>() == s.unsafe_get<Simple>());
+    DYNO_CHECK(s.try_get<Fancy>() == nullptr);
+    dyno::static_poly<Counter, Simple> const& cs = s;
+    static_assert(std::is_same<decltype(cs.try_get<Simple>()), Simple const*>{}, "");
+    DYNO_CHECK(cs.unsafe_get<void>() == static_cast<void const*>(s.unsafe_get<Simple>()));
+  }
+
+  // Multimethods work across static_polys holding different types.
+  {
+    dyno::static_poly<Counter, Simple> simple{Simple{1}};
+    dyno::static_poly<Counter, Fancy> fancy{Fancy{2}};
+    DYNO_CHECK(simple.virtual_("combine"_s)(simple, fancy) == "1-2");
+    dyno::poly<Counter> dsimple{Simple{1}}, dfancy{Fancy{2}};
+    DYNO_CHECK(dsimple.virtual_("combine"_s)(dsimple, dfancy) == "1-2");
+  }
+
+  // Swapping
+  {
+    dyno::static_poly<Counter, Simple> a{Simple{1}}, b{Simple{2}};
+    swap(a, b);
+    DYNO_CHECK(a.virtual_("value"_s)() == 2);
+    DYNO_CHECK(b.virtual_("value"_s)() == 1);
+  }
+}
@@ -0,0 +1,30 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/static_poly.hpp>
+using namespace dyno::literals;
+
+
+struct Concept : decltype(dyno::requires_(
+  "f"_s = dyno::function<int (dyno::T const&)>
+)) { };
+
+struct Foo { };
+struct Bar { };
+
+template <typename T>
+auto const dyno::default_concept_map<Concept, T> = dyno::make_concept_map(
+  "f"_s = [](T const&) { return 111; }
+);
+
+int main() {
+  dyno::static_poly<Concept, Foo> foo{Foo{}};
+  dyno::static_poly<Concept, Bar> bar{Bar{}};
+  // MESSAGE[dyno::static_poly::virtual_: Passing an object that is not a static_poly]
+  foo.virtual_("f"_s)(bar);
+}
@@ -0,0 +1,173 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "event_loop.hpp"
+#include "testing.hpp"
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/task.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+using namespace dyno::literals;
+
+
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t n) {
+  ++allocations;
+  if (void* p = std::malloc(n))
+    return p;
+  throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+struct Handler : decltype(dyno::requires_(
+  dyno::MoveConstructible{},
+  "handle"_s = dyno::async_method<int (int)>,
+  "name"_s = dyno::async_method<std::string () const>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<Handler, T> = dyno::make_concept_map(
+  "handle"_s = [](T& self, int x) { return self.handle(x); },
+  "name"_s = [](T const& self) -> dyno::task<std::string> { co_return self.name; }
+);
+
+struct Doubler {
+  std::string name = "doubler";
+  int calls = 0;
+  dyno::task<int> handle(int x) { ++calls; co_return 2 * x; }
+};
+
+struct Deferred {
+  event_loop* loop;
+  std::vector<int>* log;
+  std::string name = "deferred";
+  dyno::task<int> handle(int x) {
+    log->push_back(x);
+    co_await loop->yield();
+    log->push_back(-x);
+    co_return x + 1;
+  }
+};
+
+struct Throwing {
+  std::string name = "throwing";
+  dyno::task<int> handle(int x) {
+    if (x < 0)
+      throw std::invalid_argument{"negative"};
+    co_return x;
+  }
+};
+
+static dyno::task<int> sum(dyno::poly<Handler>& handler, int n) {
+  int total = 0;
+  for (int i = 0; i != n; ++i)
+    total += co_await handler.virtual_("handle"_s)(i);
+  co_return total;
+}
+
+static dyno::task<std::unique_ptr<int>> make_unique_int(int x) {
+  co_return std::make_unique<int>(x);
+}
+
+static dyno::task<> nothing(int& counter) {
+  ++counter;
+  co_return;
+}
+
+int main() {
+  event_loop loop;
+
+  // `virtual_` returns a `dyno::task` that runs the coroutine of the object.
+  {
+    dyno::poly<Handler> handler{Doubler{}};
+    static_assert(std::is_same<
+      decltype(handler.virtual_("handle"_s)(1)), dyno::task<int>
+    >::value);
+    DYNO_CHECK(loop.run(handler.virtual_("handle"_s)(21)) == 42);
+    DYNO_CHECK(loop.run(handler.virtual_("name"_s)()) == "doubler");
+    DYNO_CHECK(loop.run(sum(handler, 10)) == 90);
+    DYNO_CHECK(handler.unsafe_get<Doubler>()->calls == 11);
+  }
+
+  // Tasks are lazy: nothing runs until the task is started or awaited.
+  {
+    dyno::poly<Handler> handler{Doubler{}};
+    {
+      auto t = handler.virtual_("handle"_s)(1);
+      DYNO_CHECK(handler.unsafe_get<Doubler>()->calls == 0);
+    }
+    DYNO_CHECK(handler.unsafe_get<Doubler>()->calls == 0);
+  }
+
+  // Tasks suspended on the event loop interleave.
+  {
+    std::vector<int> log;
+    dyno::poly<Handler> handler{Deferred{&loop, &log}};
+    std::vector<dyno::task<int>> tasks;
+    tasks.push_back(handler.virtual_("handle"_s)(1));
+    tasks.push_back(handler.virtual_("handle"_s)(2));
+    loop.run_all(tasks);
+    DYNO_CHECK(tasks[0].done() && tasks[0].get() == 2);
+    DYNO_CHECK(tasks[1].done() && tasks[1].get() == 3);
+    DYNO_CHECK((log == std::vector<int>{1, 2, -1, -2}));
+    DYNO_CHECK(loop.run(sum(handler, 3)) == 6);
+  }
+
+  // Exceptions propagate to the awaiting coroutine.
+  {
+    dyno::poly<Handler> handler{Throwing{}};
+    DYNO_CHECK(loop.run(handler.virtual_("handle"_s)(3)) == 3);
+    bool thrown = false;
+    try {
+      loop.run(handler.virtual_("handle"_s)(-1));
+    } catch (std::invalid_argument const&) {
+      thrown = true;
+    }
+    DYNO_CHECK(thrown);
+
+    thrown = false;
+    try {
+      loop.run(sum(handler, 1)); // handle(0) is fine
+      loop.run([](dyno::poly<Handler>& h) -> dyno::task<int> {
+        co_return co_await h.virtual_("handle"_s)(-5);
+      }(handler));
+    } catch (std::invalid_argument const&) {
+      thrown = true;
+    }
+    DYNO_CHECK(thrown);
+  }
+
+  // Move-only results and `dyno::task<void>`.
+  {
+    DYNO_CHECK(*loop.run(make_unique_int(3)) == 3);
+    int counter = 0;
+    loop.run(nothing(counter));
+    DYNO_CHECK(counter == 1);
+  }
+
+  // Coroutine frames are recycled, so calling the same coroutines repeatedly
+  // does not allocate.
+  {
+    dyno::poly<Handler> handler{Doubler{}};
+    loop.run(sum(handler, 10));
+    std::size_t const before = allocations;
+    for (int i = 0; i != 100; ++i)
+      loop.run(sum(handler, 10));
+    DYNO_CHECK(allocations == before);
+  }
+}
@@ -0,0 +1,148 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/task_queue.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+using namespace dyno::literals;
+
+
+struct Task : decltype(dyno::requires_(
+  "run"_s = dyno::method<int ()>
+)) { };
+
+template <typename T>
+auto const dyno::default_concept_map<Task, T> = dyno::make_concept_map(
+  "run"_s = [](T& self) { return self(); }
+);
+
+static int live = 0;
+
+struct Counted {
+  int value;
+  explicit Counted(int v) : value{v} { ++live; }
+  Counted(Counted const& other) : value{other.value} { ++live; }
+  ~Counted() { --live; }
+  int operator()() const { return value; }
+};
+
+struct Throwing {
+  Throwing() = default;
+  Throwing(Throwing const&) { throw std::runtime_error{"copy"}; }
+  int operator()() const { return -1; }
+};
+
+int main() {
+  // Objects come out in order, and are destroyed after being used.
+  {
+    dyno::task_queue<Task, 16> queue{4};
+    DYNO_CHECK(queue.capacity() == 4);
+    DYNO_CHECK(queue.try_push(Counted{1}));
+    DYNO_CHECK(queue.try_push(Counted{2}));
+    DYNO_CHECK(queue.try_push([] { return 3; }));
+    DYNO_CHECK(queue.try_push(Counted{4}));
+    DYNO_CHECK(!queue.try_push(Counted{5})); // full
+    DYNO_CHECK(live == 3);
+
+    std::vector<int> results;
+    auto run = [&](auto& task) { results.push_back(task.virtual_("run"_s)()); };
+    DYNO_CHECK(queue.try_pop(run));
+    DYNO_CHECK(live == 2);
+    DYNO_CHECK(queue.try_push(Counted{5})); // room again
+    DYNO_CHECK(queue.consume_all(run) == 4);
+    DYNO_CHECK(!queue.try_pop(run));
+    DYNO_CHECK((results == std::vector<int>{1, 2, 3, 4, 5}));
+    DYNO_CHECK(live == 0);
+  }
+
+  // The capacity is rounded up to a power of two.
+  {
+    dyno::task_queue<Task, 16> queue{5};
+    DYNO_CHECK(queue.capacity() == 8);
+  }
+
+  // Objects remaining in the queue are destroyed with it.
+  {
+    {
+      dyno::task_queue<Task, 16> queue{8};
+      queue.push(Counted{1});
+      queue.push(Counted{2});
+      DYNO_CHECK(live == 2);
+    }
+    DYNO_CHECK(live == 0);
+  }
+
+  // Nothing is pushed when the constructor of the object throws, and the
+  // object is destroyed when the function using it throws.
+  {
+    dyno::task_queue<Task, 16> queue{8};
+    Throwing throwing;
+    bool thrown = false;
+    try {
+      queue.push(throwing);
+    } catch (std::runtime_error const&) {
+      thrown = true;
+    }
+    DYNO_CHECK(thrown);
+    queue.push(Counted{1});
+    queue.push(Counted{2});
+
+    thrown = false;
+    try {
+      queue.try_pop([](auto&) { throw std::runtime_error{"run"}; });
+    } catch (std::runtime_error const&) {
+      thrown = true;
+    }
+    DYNO_CHECK(thrown);
+    DYNO_CHECK(live == 1);
+
+    int value = 0;
+    DYNO_CHECK(queue.try_pop([&](auto& task) { value = task.virtual_("run"_s)(); }));
+    DYNO_CHECK(value == 2);
+    DYNO_CHECK(!queue.try_pop([](auto&) { }));
+  }
+
+  // Many producers and a single consumer.
+  {
+    constexpr int producers = 4;
+    constexpr int per_producer = 20000;
+    dyno::task_queue<Task, 16> queue{64};
+    std::vector<std::thread> threads;
+    for (int p = 0; p != producers; ++p) {
+      threads.emplace_back([&queue, p] {
+        for (int i = 0; i != per_producer; ++i)
+          queue.push([v = p * per_producer + i] { return v; });
+      });
+    }
+
+    std::vector<int> seen(producers * per_producer, 0);
+    std::vector<int> last(producers, -1);
+    bool ordered = true;
+    for (int popped = 0; popped != producers * per_producer; ) {
+      queue.try_pop([&](auto& task) {
+        int v = task.virtual_("run"_s)();
+        ++seen[v];
+        ordered = ordered && last[v / per_producer] < v;
+        last[v / per_producer] = v;
+        ++popped;
+      });
+    }
+    for (auto& t : threads)
+      t.join();
+
+    bool all_once = true;
+    for (int count : seen)
+      all_once = all_once && count == 1;
+    DYNO_CHECK(all_once);
+    DYNO_CHECK(ordered); // objects from the same producer stay in order
+  }
+}
@@ -0,0 +1,95 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/thread_pool.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+
+// This test makes sure that submitting small tasks to a `dyno::thread_pool`
+// doesn't allocate once the pool has warmed up, including when the tasks are
+// submitted from a thread that is not a worker of the pool.
+
+static std::atomic<std::size_t> allocations{0};
+
+void* operator new(std::size_t n) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(n))
+    return p;
+  throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+template <typename Pool>
+static void submit_all(Pool& pool, std::atomic<int>& sum, int tasks) {
+  for (int i = 0; i != tasks; ++i)
+    pool.submit([&sum, i] { sum += i; });
+  pool.wait();
+}
+
+// Makes sure the cache of the calling thread holds at least `tasks` nodes,
+// by keeping every worker busy until all the tasks have been submitted.
+template <typename Pool>
+static void warm_up(Pool& pool, int tasks) {
+  std::atomic<bool> go{false};
+  for (std::size_t i = 0; i != pool.size(); ++i)
+    pool.submit([&go] { while (!go) std::this_thread::yield(); });
+  for (int i = 0; i != tasks; ++i)
+    pool.submit([] { });
+  go = true;
+  pool.wait();
+}
+
+int main() {
+  // Tasks submitted from outside of the pool.
+  {
+    dyno::thread_pool<> pool{4};
+    std::atomic<int> sum{0};
+    warm_up(pool, 1000);
+
+    std::size_t const before = allocations.load();
+    for (int round = 0; round != 10; ++round)
+      submit_all(pool, sum, 1000);
+    DYNO_CHECK(allocations.load() == before);
+    DYNO_CHECK(sum == 10 * (999 * 1000 / 2));
+  }
+
+  // parallel_for_each submits its blocks from the calling thread.
+  {
+    dyno::thread_pool<> pool{4};
+    std::vector<int> values(10000, 1);
+    auto const run = [&] {
+      dyno::parallel_for_each(pool, values.begin(), values.end(), [](int& x) { x += 1; }, 10);
+    };
+    warm_up(pool, 1000);
+
+    std::size_t const before = allocations.load();
+    for (int round = 0; round != 10; ++round)
+      run();
+    DYNO_CHECK(allocations.load() == before);
+    DYNO_CHECK(values.front() == 11 && values.back() == 11);
+  }
+
+  // Nodes are returned to their cache even after the thread that submitted
+  // them has exited.
+  {
+    dyno::thread_pool<> pool{2};
+    std::atomic<int> sum{0};
+    std::thread submitter{[&] {
+      for (int i = 0; i != 1000; ++i)
+        pool.submit([&sum] { ++sum; });
+    }};
+    submitter.join();
+    pool.wait();
+    DYNO_CHECK(sum == 1000);
+  }
+}
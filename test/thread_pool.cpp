@@ -0,0 +1,169 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/thread_pool.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+using namespace dyno::literals;
+
+
+struct Shape : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "scale"_s = dyno::method<void (int)>,
+  "area"_s = dyno::method<int () const>
+)) { };
+
+struct Square { int side; };
+struct Rectangle { int width, height; };
+
+template <>
+auto const dyno::concept_map<Shape, Square> = dyno::make_concept_map(
+  "scale"_s = [](Square& s, int k) { s.side *= k; },
+  "area"_s = [](Square const& s) { return s.side * s.side; }
+);
+
+template <>
+auto const dyno::concept_map<Shape, Rectangle> = dyno::make_concept_map(
+  "scale"_s = [](Rectangle& r, int k) { r.width *= k; r.height *= k; },
+  "area"_s = [](Rectangle const& r) { return r.width * r.height; }
+);
+
+static void fork(dyno::thread_pool<>& pool, std::atomic<int>& leaves, int depth) {
+  if (depth == 0) {
+    ++leaves;
+    return;
+  }
+  pool.submit([&pool, &leaves, depth] { fork(pool, leaves, depth - 1); });
+  pool.submit([&pool, &leaves, depth] { fork(pool, leaves, depth - 1); });
+}
+
+int main() {
+  // The deque on its own, including growth.
+  {
+    dyno::detail::work_stealing_deque<int> deque{2};
+    int values[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    for (int& v : values)
+      deque.push(&v);
+    DYNO_CHECK(deque.size() == 10);
+    DYNO_CHECK(deque.steal() == &values[0]);
+    DYNO_CHECK(deque.pop() == &values[9]);
+    DYNO_CHECK(deque.steal() == &values[1]);
+    for (int i = 8; i != 1; --i)
+      DYNO_CHECK(deque.pop() == &values[i]);
+    DYNO_CHECK(deque.pop() == nullptr);
+    DYNO_CHECK(deque.steal() == nullptr);
+  }
+
+  // Tasks submitted from outside of the pool, small and large.
+  {
+    dyno::thread_pool<> pool{4};
+    DYNO_CHECK(pool.size() == 4);
+    std::atomic<int> sum{0};
+    for (int i = 0; i != 1000; ++i)
+      pool.submit([&sum, i] { sum += i; });
+    std::vector<int> big(100, 1);
+    for (int i = 0; i != 10; ++i)
+      pool.submit([&sum, big, padding = std::vector<char>(1000)] {
+        sum += std::accumulate(big.begin(), big.end(), 0);
+      });
+    pool.wait();
+    DYNO_CHECK(sum == 999 * 1000 / 2 + 1000);
+  }
+
+  // Tasks submitted from tasks, which get stolen by other workers.
+  {
+    dyno::thread_pool<> pool{4};
+    std::atomic<int> leaves{0};
+    pool.submit([&] { fork(pool, leaves, 12); });
+    pool.wait();
+    DYNO_CHECK(leaves == 1 << 12);
+  }
+
+  // The first exception thrown by a task is rethrown by `wait()`.
+  {
+    dyno::thread_pool<> pool{2};
+    std::atomic<int> ran{0};
+    for (int i = 0; i != 100; ++i) {
+      pool.submit([&ran, i] {
+        ++ran;
+        if (i % 10 == 0)
+          throw std::runtime_error{"task"};
+      });
+    }
+    bool thrown = false;
+    try {
+      pool.wait();
+    } catch (std::runtime_error const&) {
+      thrown = true;
+    }
+    DYNO_CHECK(thrown);
+    DYNO_CHECK(ran == 100);
+    pool.wait(); // the exception was consumed
+  }
+
+  // Parallel dispatch over heterogeneous objects.
+  {
+    dyno::thread_pool<> pool{4};
+    std::vector<dyno::poly<Shape>> shapes;
+    for (int i = 0; i != 1000; ++i) {
+      if (i % 2) shapes.emplace_back(Square{i});
+      else       shapes.emplace_back(Rectangle{i, 2});
+    }
+    dyno::parallel_for_each(pool, shapes.begin(), shapes.end(), [](auto& shape) {
+      shape.virtual_("scale"_s)(2);
+    });
+
+    bool all_scaled = true;
+    for (int i = 0; i != 1000; ++i) {
+      int expected = i % 2 ? 4 * i * i : 4 * i * 2;
+      all_scaled = all_scaled && shapes[i].virtual_("area"_s)() == expected;
+    }
+    DYNO_CHECK(all_scaled);
+
+    // Nested parallel_for_each, with an explicit grain.
+    std::vector<int> counts(100, 0);
+    dyno::parallel_for_each(pool, counts.begin(), counts.end(), [&](int& count) {
+      std::vector<int> inner(10, 1);
+      dyno::parallel_for_each(pool, inner.begin(), inner.end(), [](int& x) { x *= 3; }, 3);
+      count = std::accumulate(inner.begin(), inner.end(), 0);
+    });
+    DYNO_CHECK(std::accumulate(counts.begin(), counts.end(), 0) == 100 * 30);
+
+    // Exceptions propagate to the caller.
+    bool thrown = false;
+    try {
+      dyno::parallel_for_each(pool, counts.begin(), counts.end(), [](int& count) {
+        if (count == 30)
+          throw std::runtime_error{"element"};
+      });
+    } catch (std::runtime_error const&) {
+      thrown = true;
+    }
+    DYNO_CHECK(thrown);
+
+    // Empty ranges are fine.
+    std::vector<int> empty;
+    dyno::parallel_for_each(pool, empty.begin(), empty.end(), [](int&) { });
+  }
+
+  // Destroying the pool waits for the tasks.
+  {
+    std::atomic<int> ran{0};
+    {
+      dyno::thread_pool<> pool{3};
+      for (int i = 0; i != 100; ++i)
+        pool.submit([&ran] { ++ran; });
+    }
+    DYNO_CHECK(ran == 100);
+  }
+}
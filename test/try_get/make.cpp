@@ -0,0 +1,17 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "shape.hpp"
+
+#include <dyno/poly.hpp>
+#include <dyno/storage.hpp>
+
+
+dyno::poly<Shape> make_square(int side) {
+  return dyno::poly<Shape>{square{side}};
+}
+
+dyno::poly<Shape, dyno::remote_storage, JoinedVTable> make_joined_square(int side) {
+  return dyno::poly<Shape, dyno::remote_storage, JoinedVTable>{square{side}};
+}
@@ -0,0 +1,39 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#ifndef DYNO_TEST_TRY_GET_SHAPE_HPP
+#define DYNO_TEST_TRY_GET_SHAPE_HPP
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/vtable.hpp>
+using namespace dyno::literals;
+
+
+struct Shape : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "area"_s = dyno::method<int () const>
+)) { };
+
+struct square {
+  int side;
+};
+
+template <>
+inline auto const dyno::concept_map<Shape, square> = dyno::make_concept_map(
+  "area"_s = [](square const& self) { return self.side * self.side; }
+);
+
+using JoinedVTable = dyno::vtable<
+  dyno::local<dyno::only<decltype("area"_s)>>,
+  dyno::remote<dyno::everything_else>
+>;
+
+// Defined in `make.cpp`, so the polys are created in another translation unit.
+dyno::poly<Shape> make_square(int side);
+dyno::poly<Shape, dyno::remote_storage, JoinedVTable> make_joined_square(int side);
+
+#endif // DYNO_TEST_TRY_GET_SHAPE_HPP
@@ -0,0 +1,82 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/vtable.hpp>
+
+#include <type_traits>
+using namespace dyno::literals;
+
+
+// This test makes sure that `dyno::auto_vtable` stores hot functions locally,
+// within its budget, and all the other functions remotely.
+
+struct Concept : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "f"_s = dyno::hot(dyno::function<int (dyno::T const&)>),
+  "g"_s = dyno::function<int (dyno::T const&)>,
+  "h"_s = dyno::hot(dyno::method<int () const>)
+)) { };
+
+struct Cold : decltype(dyno::requires_(
+  "g"_s = dyno::function<int (dyno::T const&)>
+)) { };
+
+constexpr std::size_t fptr = sizeof(void (*)());
+
+static_assert(std::is_same<
+  dyno::auto_vtable<>::apply<Concept>,
+  dyno::vtable<
+    dyno::local<dyno::only<decltype("f"_s), decltype("h"_s)>>,
+    dyno::remote<dyno::everything_else>
+  >::apply<Concept>
+>{}, "");
+
+static_assert(std::is_same<
+  dyno::auto_vtable<2 * fptr>::apply<Concept>,
+  dyno::auto_vtable<>::apply<Concept>
+>{}, "");
+
+static_assert(std::is_same<
+  dyno::auto_vtable<fptr>::apply<Concept>,
+  dyno::vtable<
+    dyno::local<dyno::only<decltype("f"_s)>>,
+    dyno::remote<dyno::everything_else>
+  >::apply<Concept>
+>{}, "");
+
+static_assert(std::is_same<
+  dyno::auto_vtable<0>::apply<Concept>,
+  dyno::vtable<dyno::remote<dyno::everything>>::apply<Concept>
+>{}, "");
+
+static_assert(std::is_same<
+  dyno::auto_vtable<>::apply<Cold>,
+  dyno::vtable<dyno::remote<dyno::everything>>::apply<Cold>
+>{}, "");
+
+struct Foo { int value; };
+
+template <>
+auto const dyno::concept_map<Concept, Foo> = dyno::make_concept_map(
+  "f"_s = [](Foo const& foo) { return foo.value; },
+  "g"_s = [](Foo const& foo) { return foo.value + 1; },
+  "h"_s = [](Foo const& foo) { return foo.value + 2; }
+);
+
+int main() {
+  dyno::poly<Concept, dyno::remote_storage, dyno::auto_vtable<>> poly{Foo{10}};
+  DYNO_CHECK(poly.virtual_("f"_s)(poly) == 10);
+  DYNO_CHECK(poly.virtual_("g"_s)(poly) == 11);
+  DYNO_CHECK(poly.virtual_("h"_s)() == 12);
+
+  auto copy = poly;
+  DYNO_CHECK(copy.virtual_("f"_s)(copy) == 10);
+  DYNO_CHECK(copy.try_get<Foo>() != nullptr);
+}
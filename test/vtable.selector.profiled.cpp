@@ -0,0 +1,98 @@
+// Copyright Louis Dionne 2017
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.md or copy at http://boost.org/LICENSE_1_0.txt)
+
+#include "testing.hpp"
+
+#include <dyno/builtin.hpp>
+#include <dyno/concept.hpp>
+#include <dyno/concept_map.hpp>
+#include <dyno/poly.hpp>
+#include <dyno/vtable.hpp>
+
+#include <boost/hana/equal.hpp>
+#include <boost/hana/first.hpp>
+#include <boost/hana/second.hpp>
+#include <boost/hana/set.hpp>
+#include <boost/hana/tuple.hpp>
+
+#include <type_traits>
+using namespace dyno::literals;
+namespace hana = boost::hana;
+
+
+// This test makes sure that the `dyno::profiled` selector picks the hottest
+// functions in a profile, and that it lays them out by decreasing frequency.
+
+struct Concept : decltype(dyno::requires_(
+  dyno::CopyConstructible{},
+  "a"_s = dyno::function<int (dyno::T const&)>,
+  "b"_s = dyno::function<int (dyno::T const&)>,
+  "c"_s = dyno::function<int (dyno::T const&)>,
+  "d"_s = dyno::function<int (dyno::T const&)>
+)) { };
+
+// As generated by `dyno::write_profile`; "x" is not in the concept.
+struct Profile : dyno::profile<
+  dyno::profile_entry<dyno::detail::string<99>, 1000>, // c
+  dyno::profile_entry<dyno::detail::string<120>, 500>, // x
+  dyno::profile_entry<dyno::detail::string<97>, 100>,  // a
+  dyno::profile_entry<dyno::detail::string<98>, 10>    // b
+> { };
+
+template <std::size_t N>
+constexpr auto select() {
+  auto all = hana::make_set("a"_s, "b"_s, "c"_s, "d"_s);
+  auto split = dyno::profiled<Profile, N>{}(all);
+  return hana::make_pair(hana::to_tuple(hana::first(split)),
+                         hana::to_tuple(hana::second(split)));
+}
+
+static_assert(hana::second(select<2>()) == hana::make_tuple("c"_s, "a"_s), "");
+static_assert(hana::first(select<2>()) == hana::make_tuple("b"_s, "d"_s), "");
+
+static_assert(hana::second(select<0>()) == hana::make_tuple(), "");
+static_assert(hana::first(select<0>()) == hana::make_tuple("c"_s, "a"_s, "b"_s, "d"_s), "");
+
+static_assert(hana::second(select<10>()) == hana::make_tuple("c"_s, "a"_s, "b"_s), "");
+static_assert(hana::first(select<10>()) == hana::make_tuple("d"_s), "");
+
+// The hottest functions are stored locally, in order of frequency.
+template <typename VTable>
+struct local_part;
+
+template <typename Local, typename Remote>
+struct local_part<dyno::joined_vtable<Local, Remote>> { using type = Local; };
+
+static_assert(std::is_same<
+  local_part<dyno::vtable<
+    dyno::local<dyno::profiled<Profile, 2>>,
+    dyno::remote<dyno::everything_else>
+  >::apply<Concept>>::type,
+  dyno::local_vtable<
+    decltype("c"_s = dyno::function<int (dyno::T const&)>),
+    decltype("a"_s = dyno::function<int (dyno::T const&)>)
+  >
+>{}, "");
+
+struct Foo { int value; };
+
+template <>
+auto const dyno::concept_map<Concept, Foo> = dyno::make_concept_map(
+  "a"_s = [](Foo const& foo) { return foo.value + 1; },
+  "b"_s = [](Foo const& foo) { return foo.value + 2; },
+  "c"_s = [](Foo const& foo) { return foo.value + 3; },
+  "d"_s = [](Foo const& foo) { return foo.value + 4; }
+);
+
+int main() {
+  using VTable = dyno::vtable<
+    dyno::local<dyno::profiled<Profile, 2>>,
+    dyno::remote<dyno::everything_else>
+  >;
+  dyno::poly<Concept, dyno::remote_storage, VTable> poly{Foo{0}};
+  DYNO_CHECK(poly.virtual_("a"_s)(poly) == 1);
+  DYNO_CHECK(poly.virtual_("b"_s)(poly) == 2);
+  DYNO_CHECK(poly.virtual_("c"_s)(poly) == 3);
+  DYNO_CHECK(poly.virtual_("d"_s)(poly) == 4);
+}